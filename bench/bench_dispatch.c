@@ -0,0 +1,302 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/interp.h"
+#include "core/opcode.h"
+#include "core/keypad.h"
+#include "core/state.h"
+#include "core/video.h"
+
+/*
+ * Compare instructions per second of the legacy nested switch decoder against
+ * the table driven, predecoded interpreter and the JIT on a set of ROMs. Build
+ * with THREADED set in config.mk to measure threaded interpreter dispatch.
+ */
+
+#define BENCH_DEFAULT_COUNT 20000000UL /* Default instructions per run. */
+#define BENCH_TIMER_DIV     1000       /* Instructions per 60Hz timer tick. */
+#define BENCH_STARTUP_RUNS  1000       /* Startups to average over. */
+
+typedef chip8_error (*bench_exec)(chip8_cpu *cpu, unsigned long count);
+
+/*
+ * Reference decoder, a copy of the nested switch chip8_cpu_execute() used
+ * before the decode table was introduced. Operands are extracted on every
+ * fetch just like the handlers used to do.
+ */
+static chip8_error bench_switch_step(chip8_cpu *cpu)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_instr ins;
+	uint16_t opcode = 0;
+	bool lock = false;
+
+	flag = chip8_keypad_islock(cpu->keypad, &lock);
+	if (lock == true)
+		return flag;
+
+	opcode = cpu->memory[cpu->pc] << 8 | cpu->memory[cpu->pc + 1];
+	cpu->opcode = opcode;
+	cpu->pc += 2;
+
+	ins.opcode = opcode;
+	ins.nnn = opcode & 0x0FFF;
+	ins.x = (opcode & 0x0F00) >> 8;
+	ins.y = (opcode & 0x00F0) >> 4;
+	ins.n = opcode & 0x000F;
+	ins.nn = opcode & 0x00FF;
+
+	switch (opcode & 0xF000) {
+	case 0x0000:
+		switch (opcode & 0x00FF) {
+		case 0x00E0: return chip8_opcode_00E0(cpu, &ins);
+		case 0x00EE: return chip8_opcode_00EE(cpu, &ins);
+		default:     return CHIP8_EBADOP;
+		}
+	case 0x1000: return chip8_opcode_1NNN(cpu, &ins);
+	case 0x2000: return chip8_opcode_2NNN(cpu, &ins);
+	case 0x3000: return chip8_opcode_3XNN(cpu, &ins);
+	case 0x4000: return chip8_opcode_4XNN(cpu, &ins);
+	case 0x5000: return chip8_opcode_5XY0(cpu, &ins);
+	case 0x6000: return chip8_opcode_6XNN(cpu, &ins);
+	case 0x7000: return chip8_opcode_7XNN(cpu, &ins);
+	case 0x8000:
+		switch (opcode & 0x000F) {
+		case 0x0000: return chip8_opcode_8XY0(cpu, &ins);
+		case 0x0001: return chip8_opcode_8XY1(cpu, &ins);
+		case 0x0002: return chip8_opcode_8XY2(cpu, &ins);
+		case 0x0003: return chip8_opcode_8XY3(cpu, &ins);
+		case 0x0004: return chip8_opcode_8XY4(cpu, &ins);
+		case 0x0005: return chip8_opcode_8XY5(cpu, &ins);
+		case 0x0006: return chip8_opcode_8XY6(cpu, &ins);
+		case 0x0007: return chip8_opcode_8XY7(cpu, &ins);
+		case 0x000E: return chip8_opcode_8XYE(cpu, &ins);
+		default:     return CHIP8_EBADOP;
+		}
+	case 0x9000: return chip8_opcode_9XY0(cpu, &ins);
+	case 0xA000: return chip8_opcode_ANNN(cpu, &ins);
+	case 0xB000: return chip8_opcode_BNNN(cpu, &ins);
+	case 0xC000: return chip8_opcode_CXNN(cpu, &ins);
+	case 0xD000: return chip8_opcode_DXYN(cpu, &ins);
+	case 0xE000:
+		switch (opcode & 0x00FF) {
+		case 0x009E: return chip8_opcode_EX9E(cpu, &ins);
+		case 0x00A1: return chip8_opcode_EXA1(cpu, &ins);
+		default:     return CHIP8_EBADOP;
+		}
+	case 0xF000:
+		switch (opcode & 0x00FF) {
+		case 0x0007: return chip8_opcode_FX07(cpu, &ins);
+		case 0x000A: return chip8_opcode_FX0A(cpu, &ins);
+		case 0x0015: return chip8_opcode_FX15(cpu, &ins);
+		case 0x0018: return chip8_opcode_FX18(cpu, &ins);
+		case 0x001E: return chip8_opcode_FX1E(cpu, &ins);
+		case 0x0029: return chip8_opcode_FX29(cpu, &ins);
+		case 0x0033: return chip8_opcode_FX33(cpu, &ins);
+		case 0x0055: return chip8_opcode_FX55(cpu, &ins);
+		case 0x0065: return chip8_opcode_FX65(cpu, &ins);
+		default:     return CHIP8_EBADOP;
+		}
+	default:
+		return CHIP8_EBADOP;
+	}
+}
+
+/*
+ * Execute count instructions with the legacy switch decoder.
+ */
+static chip8_error bench_switch_exec(chip8_cpu *cpu, unsigned long count)
+{
+	chip8_error flag = CHIP8_EOK;
+
+	for (unsigned long n = 0; n < count && flag == CHIP8_EOK; n++)
+		flag = bench_switch_step(cpu);
+	return flag;
+}
+
+/*
+ * Execute count instructions with whatever engine cpu has selected.
+ */
+static chip8_error bench_cpu_exec(chip8_cpu *cpu, unsigned long count)
+{
+	return chip8_cpu_exec(cpu, count, NULL);
+}
+
+/*
+ * Run ROM for count instructions with given engine. Instructions run in
+ * slices of one 60Hz timer tick, and any key wait is answered between slices
+ * so that ROMs never stall. Returns instructions per second, 0 if engine is
+ * not supported, or a negative value if the ROM hit an error.
+ */
+static double bench_run(chip8_video *video, chip8_keypad *keys,
+		        const char *rom, chip8_engine engine, bench_exec exec,
+			unsigned long count)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_cpu *cpu = NULL;
+	bool lock = false;
+	uint64_t start = 0;
+	uint64_t end = 0;
+
+	chip8_video_clear(video);
+	chip8_keypad_clear(keys);
+	keys->states = NULL;
+	if (chip8_cpu_init(&cpu, video, keys, 0) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+
+	if (chip8_cpu_setengine(cpu, engine) != CHIP8_EOK) {
+		chip8_cpu_free(cpu);
+		return 0.0;
+	}
+
+	if (chip8_cpu_romload(cpu, rom) != CHIP8_EOK) {
+		chip8_cpu_free(cpu);
+		return -1.0;
+	}
+
+	start = chip8_now();
+	for (unsigned long n = 0; n < count; n += BENCH_TIMER_DIV) {
+		if (cpu->dt != 0)
+			cpu->dt--;
+		if (cpu->st != 0)
+			cpu->st--;
+
+		chip8_keypad_islock(cpu->keypad, &lock);
+		if (lock)
+			chip8_keypad_setkey(cpu->keypad, n & 0xF, CHIP8_KEY_DOWN);
+
+		flag = exec(cpu, BENCH_TIMER_DIV);
+		if (flag != CHIP8_EOK)
+			break;
+	}
+	end = chip8_now();
+	chip8_cpu_free(cpu);
+	return (flag == CHIP8_EOK) ? count * 1e9 / (end - start) : -1.0;
+}
+
+/*
+ * Measure average time in microseconds to bring up and tear down a headless
+ * CPU with its video and keypad.
+ */
+static double bench_startup(void)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	chip8_cpu *cpu = NULL;
+	uint64_t start = chip8_now();
+
+	for (int n = 0; n < BENCH_STARTUP_RUNS; n++) {
+		if (chip8_video_init(&video) != CHIP8_EOK ||
+		    chip8_keypad_init(&keys) != CHIP8_EOK ||
+		    chip8_cpu_init(&cpu, video, keys, 0) != CHIP8_EOK)
+			chip8_die(CHIP8_ENOMEM);
+		chip8_cpu_free(cpu);
+		chip8_keypad_free(keys);
+		chip8_video_free(video);
+	}
+	return (chip8_now() - start) / 1e3 / BENCH_STARTUP_RUNS;
+}
+
+/*
+ * Measure average time in nanoseconds to take a snapshot of a running CPU and
+ * to restore it again. Returns snapshot time, and restore time in restore.
+ */
+static double bench_snapshot(const char *rom, double *restore)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	chip8_cpu *cpu = NULL;
+	chip8_state *state = malloc(sizeof *state);
+	uint64_t start = 0;
+	double snap = 0.0;
+
+	if (state == NULL || chip8_video_init(&video) != CHIP8_EOK ||
+	    chip8_keypad_init(&keys) != CHIP8_EOK ||
+	    chip8_cpu_init(&cpu, video, keys, 0) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+	if (chip8_cpu_romload(cpu, rom) != CHIP8_EOK ||
+	    chip8_cpu_exec(cpu, BENCH_TIMER_DIV, NULL) != CHIP8_EOK) {
+		snap = -1.0;
+		goto out;
+	}
+
+	start = chip8_now();
+	for (int n = 0; n < BENCH_STARTUP_RUNS; n++)
+		chip8_state_snap(cpu, state);
+	snap = (double)(chip8_now() - start) / BENCH_STARTUP_RUNS;
+
+	start = chip8_now();
+	for (int n = 0; n < BENCH_STARTUP_RUNS; n++)
+		chip8_state_restore(cpu, state);
+	*restore = (double)(chip8_now() - start) / BENCH_STARTUP_RUNS;
+out:
+	chip8_cpu_free(cpu);
+	chip8_keypad_free(keys);
+	chip8_video_free(video);
+	free(state);
+	return snap;
+}
+
+int main(int argc, char **argv)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	unsigned long count = BENCH_DEFAULT_COUNT;
+	char *env = getenv("BENCH_COUNT");
+	double restore = 0.0;
+	double snap = 0.0;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: bench_dispatch <rom>...\n");
+		return EXIT_FAILURE;
+	}
+
+	if (env != NULL)
+		count = strtoul(env, NULL, 10);
+
+	video = calloc(1, sizeof *video);
+	keys = calloc(1, sizeof *keys);
+	if (video == NULL || keys == NULL)
+		chip8_die(CHIP8_ENOMEM);
+
+	printf("headless startup: %.1f us\n", bench_startup());
+	snap = bench_snapshot(argv[1], &restore);
+	if (snap >= 0.0)
+		printf("state snapshot: %.0f ns, restore: %.0f ns\n", snap,
+		       restore);
+	printf("interpreter dispatch: %s\n\n",
+	       CHIP8_INTERP_THREADED ? "threaded" : "switch");
+	printf("%-28s %14s %14s %14s\n", "rom", "switch ins/s", "table ins/s",
+	       "jit ins/s");
+	for (int arg = 1; arg < argc; arg++) {
+		double before = bench_run(video, keys, argv[arg],
+				          CHIP8_ENGINE_INTERP,
+					  bench_switch_exec, count);
+		double after = bench_run(video, keys, argv[arg],
+				         CHIP8_ENGINE_INTERP, bench_cpu_exec,
+					 count);
+		double jit = bench_run(video, keys, argv[arg], CHIP8_ENGINE_JIT,
+				       bench_cpu_exec, count);
+
+		if (before < 0.0 || after < 0.0 || jit < 0.0) {
+			printf("%-28s %14s %14s %14s\n", argv[arg], "error",
+			       "error", "error");
+			continue;
+		}
+		printf("%-28s %14.0f %14.0f %14.0f\n", argv[arg], before,
+		       after, jit);
+	}
+
+	free(video);
+	free(keys);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "utils/error.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/lockstep.h"
+#include "core/pool.h"
+
+/*
+ * Run batches of machines in lockstep, every batch loaded with one of a set
+ * of ROMs and every machine seeded differently, and report aggregate
+ * instructions per second of every lane against running the same machines as
+ * scalar instances on a thread pool.
+ */
+
+#define BENCH_DEFAULT_VMS    256      /* Default machines in total. */
+#define BENCH_DEFAULT_CYCLES 200000UL /* Default cycles per machine. */
+#define BENCH_ROUNDS         20       /* Runs per measurement. */
+
+/* Lanes per batch to measure... */
+static const unsigned int BENCH_LANES[] = { 8, 16, 32 };
+
+/*
+ * Get unsigned value of environment variable, or fallback if it is unset.
+ */
+static unsigned long bench_env(const char *name, unsigned long fallback)
+{
+	char *env = getenv(name);
+
+	return (env != NULL) ? strtoul(env, NULL, 10) : fallback;
+}
+
+/*
+ * Answer key wait of machine, so ROMs never stall.
+ */
+static void bench_unlock(chip8_vm *vm, int round)
+{
+	bool lock = false;
+
+	chip8_keypad_islock(vm->keypad, &lock);
+	if (lock)
+		chip8_keypad_setkey(vm->keypad, round & 0xF, CHIP8_KEY_DOWN);
+}
+
+/*
+ * Run vms machines in batches of lanes, every batch holding a single ROM.
+ * Returns aggregate instructions per second and share of instructions run
+ * in lockstep, or a negative value if a ROM hit an error.
+ */
+static double bench_lockstep(char **roms, int nroms, size_t vms,
+		             unsigned int lanes, unsigned long cycles,
+		             double *converged)
+{
+	size_t batches = (vms + lanes - 1) / lanes;
+	chip8_lockstep **ls = calloc(batches, sizeof *ls);
+	chip8_lockstep_stats stats;
+	uint64_t total = 0;
+	uint64_t vector = 0;
+	double seconds = 0.0;
+	double ips = -1.0;
+
+	if (ls == NULL)
+		chip8_die(CHIP8_ENOMEM);
+
+	for (size_t batch = 0; batch < batches; batch++) {
+		if (chip8_lockstep_init(&ls[batch], lanes, 0) != CHIP8_EOK)
+			chip8_die(CHIP8_ENOMEM);
+
+		for (unsigned int lane = 0; lane < lanes; lane++) {
+			chip8_vm *vm = chip8_lockstep_vm(ls[batch], lane);
+
+			chip8_cpu_seed(vm->cpu, batch * lanes + lane);
+			if (chip8_cpu_romload(vm->cpu, roms[batch % nroms]) !=
+			    CHIP8_EOK)
+				goto out;
+		}
+	}
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		for (size_t batch = 0; batch < batches; batch++) {
+			if (chip8_lockstep_run(ls[batch], cycles / BENCH_ROUNDS,
+					       &stats) != CHIP8_EOK)
+				goto out;
+			total += stats.instructions;
+			vector += stats.converged;
+			seconds += stats.seconds;
+
+			for (unsigned int lane = 0; lane < lanes; lane++)
+				bench_unlock(chip8_lockstep_vm(ls[batch], lane),
+					     round);
+		}
+	}
+
+	*converged = (double)vector / total;
+	ips = total / seconds;
+out:
+	for (size_t batch = 0; batch < batches; batch++)
+		chip8_lockstep_free(ls[batch]);
+	free(ls);
+	return ips;
+}
+
+/*
+ * Run the same machines as bench_lockstep() one at a time on a thread pool
+ * with one worker per core. Returns aggregate instructions per second, or a
+ * negative value if a ROM hit an error.
+ */
+static double bench_scalar(char **roms, int nroms, size_t vms,
+		           unsigned int lanes, unsigned long cycles)
+{
+	size_t batches = (vms + lanes - 1) / lanes;
+	chip8_pool *pool = NULL;
+	chip8_pool_stats stats;
+	uint64_t total = 0;
+	double seconds = 0.0;
+	double ips = -1.0;
+
+	if (chip8_pool_init(&pool, batches * lanes, 0) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+
+	for (size_t vm = 0; vm < batches * lanes; vm++) {
+		chip8_cpu *cpu = chip8_pool_vm(pool, vm)->cpu;
+
+		chip8_cpu_seed(cpu, vm);
+		if (chip8_cpu_romload(cpu, roms[(vm / lanes) % nroms]) !=
+		    CHIP8_EOK)
+			goto out;
+	}
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		if (chip8_pool_run(pool, cycles / BENCH_ROUNDS, &stats) !=
+		    CHIP8_EOK)
+			goto out;
+		total += stats.instructions;
+		seconds += stats.seconds;
+
+		for (size_t vm = 0; vm < batches * lanes; vm++)
+			bench_unlock(chip8_pool_vm(pool, vm), round);
+	}
+	ips = total / seconds;
+out:
+	chip8_pool_free(pool);
+	return ips;
+}
+
+int main(int argc, char **argv)
+{
+	size_t vms = bench_env("BENCH_VMS", BENCH_DEFAULT_VMS);
+	unsigned long cycles = bench_env("BENCH_COUNT", BENCH_DEFAULT_CYCLES);
+	long online = sysconf(_SC_NPROCESSORS_ONLN);
+	double converged = 0.0;
+	double lockstep = 0.0;
+	double scalar = 0.0;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: bench_lockstep <rom>...\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%zu machines, %lu cycles each, %ld cores, %s lanes\n\n", vms,
+	       cycles, (online > 0) ? online : 1, chip8_lockstep_isa());
+	printf("%8s %16s %10s %16s %8s\n", "lanes", "lockstep MIPS",
+	       "converged", "threaded MIPS", "speedup");
+	for (size_t n = 0; n < sizeof BENCH_LANES / sizeof *BENCH_LANES;
+	     n++) {
+		unsigned int lanes = BENCH_LANES[n];
+
+		lockstep = bench_lockstep(argv + 1, argc - 1, vms, lanes,
+					  cycles, &converged);
+		scalar = bench_scalar(argv + 1, argc - 1, vms, lanes, cycles);
+		if (lockstep < 0.0 || scalar < 0.0) {
+			printf("%8u %16s %10s %16s %8s\n", lanes, "error",
+			       "error", "error", "error");
+			return EXIT_FAILURE;
+		}
+
+		printf("%8u %16.2f %9.1f%% %16.2f %8.2f\n", lanes,
+		       lockstep / 1e6, converged * 100.0, scalar / 1e6,
+		       lockstep / scalar);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "utils/error.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/pool.h"
+
+/*
+ * Run a pool of machines, each loaded with one of a set of ROMs, on a growing
+ * amount of worker threads and report aggregate instructions per second and
+ * speedup over a single worker.
+ */
+
+#define BENCH_DEFAULT_VMS    1024    /* Default machines in pool. */
+#define BENCH_DEFAULT_CYCLES 200000UL /* Default cycles per machine. */
+#define BENCH_ROUNDS         20       /* Pool runs per measurement. */
+
+/*
+ * Get unsigned value of environment variable, or fallback if it is unset.
+ */
+static unsigned long bench_env(const char *name, unsigned long fallback)
+{
+	char *env = getenv(name);
+
+	return (env != NULL) ? strtoul(env, NULL, 10) : fallback;
+}
+
+/*
+ * Run pool of vms machines on threads workers. Every machine runs cycles
+ * split over a few pool runs, and any key wait is answered between runs so
+ * that ROMs never stall. Returns aggregate instructions per second, or a
+ * negative value if a ROM hit an error.
+ */
+static double bench_run(char **roms, int nroms, size_t vms,
+		        unsigned int threads, unsigned long cycles)
+{
+	chip8_pool *pool = NULL;
+	chip8_pool_stats stats;
+	uint64_t total = 0;
+	double seconds = 0.0;
+	bool lock = false;
+
+	if (chip8_pool_init(&pool, vms, threads) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+
+	for (size_t vm = 0; vm < vms; vm++) {
+		chip8_vm *machine = chip8_pool_vm(pool, vm);
+
+		if (chip8_cpu_romload(machine->cpu, roms[vm % nroms]) !=
+		    CHIP8_EOK) {
+			chip8_pool_free(pool);
+			return -1.0;
+		}
+	}
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		if (chip8_pool_run(pool, cycles / BENCH_ROUNDS, &stats) !=
+		    CHIP8_EOK) {
+			chip8_pool_free(pool);
+			return -1.0;
+		}
+		total += stats.instructions;
+		seconds += stats.seconds;
+
+		for (size_t vm = 0; vm < vms; vm++) {
+			chip8_vm *machine = chip8_pool_vm(pool, vm);
+
+			chip8_keypad_islock(machine->keypad, &lock);
+			if (lock)
+				chip8_keypad_setkey(machine->keypad,
+						    round & 0xF,
+						    CHIP8_KEY_DOWN);
+		}
+	}
+
+	chip8_pool_free(pool);
+	return total / seconds;
+}
+
+int main(int argc, char **argv)
+{
+	size_t vms = bench_env("BENCH_VMS", BENCH_DEFAULT_VMS);
+	unsigned long cycles = bench_env("BENCH_COUNT", BENCH_DEFAULT_CYCLES);
+	long online = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int cores = (online > 0) ? online : 1;
+	unsigned int next = 0;
+	double base = 0.0;
+	double ips = 0.0;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: bench_pool <rom>...\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%zu machines, %lu cycles each, %u cores\n\n", vms, cycles,
+	       cores);
+	printf("%8s %16s %8s\n", "threads", "ins/s", "speedup");
+	for (unsigned int threads = 1; threads != 0; threads = next) {
+		ips = bench_run(argv + 1, argc - 1, vms, threads, cycles);
+		if (ips < 0.0) {
+			printf("%8u %16s %8s\n", threads, "error", "error");
+			return EXIT_FAILURE;
+		}
+
+		if (threads == 1)
+			base = ips;
+		printf("%8u %16.0f %8.2f\n", threads, ips, ips / base);
+
+		/* Double threads, but always measure every core too... */
+		next = threads * 2;
+		if (threads == cores)
+			next = 0;
+		else if (next > cores)
+			next = cores;
+	}
+	return EXIT_SUCCESS;
+}
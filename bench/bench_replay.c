@@ -0,0 +1,113 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/movie.h"
+#include "core/video.h"
+
+/*
+ * Replay input movies of real gameplay headless as fast as possible, and
+ * report frames per second against real time. Every movie is replayed a few
+ * times, and every replay has to end on the exact same screen.
+ */
+
+#define BENCH_ROUNDS 5 /* Replays per movie. */
+
+/*
+ * Replay movie on ROM once. Returns seconds taken and final screen in
+ * rows, or a negative value if replay failed.
+ */
+static double bench_replay(const char *rom, const char *path,
+		           uint64_t *frames, uint64_t *rows)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	chip8_cpu *cpu = NULL;
+	chip8_movie *movie = NULL;
+	chip8_movie_stats stats;
+	chip8_error flag = CHIP8_EOK;
+	bool done = false;
+	uint64_t start = 0;
+	double seconds = -1.0;
+
+	if (chip8_movie_load(&movie, path) != CHIP8_EOK)
+		return -1.0;
+	chip8_movie_stat(movie, &stats);
+
+	if (chip8_video_init(&video) != CHIP8_EOK ||
+	    chip8_keypad_init(&keys) != CHIP8_EOK ||
+	    chip8_cpu_init(&cpu, video, keys, stats.opnum) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+	chip8_cpu_seed(cpu, stats.seed);
+	if (chip8_cpu_romload(cpu, rom) != CHIP8_EOK)
+		goto out;
+
+	start = chip8_now();
+	while (!done && flag == CHIP8_EOK)
+		flag = chip8_movie_play(movie, cpu, &done);
+	if (flag == CHIP8_EOK)
+		seconds = (chip8_now() - start) / 1e9;
+
+	*frames = stats.frames;
+	memcpy(rows, video->rows, sizeof video->rows);
+out:
+	chip8_cpu_free(cpu);
+	chip8_keypad_free(keys);
+	chip8_video_free(video);
+	chip8_movie_free(movie);
+	return seconds;
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t first[CHIP8_VIDEO_WORDS];
+	uint64_t rows[CHIP8_VIDEO_WORDS];
+	uint64_t frames = 0;
+	double seconds = 0.0;
+	double total = 0.0;
+	bool same = true;
+
+	if (argc < 3 || argc % 2 == 0) {
+		fprintf(stderr, "usage: bench_replay <rom> <movie>...\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%-28s %10s %14s %12s %10s\n", "movie", "frames", "frames/s",
+	       "real time", "identical");
+	for (int arg = 1; arg < argc; arg += 2) {
+		total = 0.0;
+		same = true;
+		for (int round = 0; round < BENCH_ROUNDS; round++) {
+			seconds = bench_replay(argv[arg], argv[arg + 1], &frames,
+					       (round == 0) ? first : rows);
+			if (seconds < 0.0)
+				break;
+			total += seconds;
+			if (round != 0)
+				same &= memcmp(first, rows, sizeof rows) == 0;
+		}
+
+		if (seconds < 0.0) {
+			printf("%-28s %10s %14s %12s %10s\n", argv[arg + 1],
+			       "error", "error", "error", "error");
+			return EXIT_FAILURE;
+		}
+		printf("%-28s %10lu %14.0f %11.0fx %10s\n", argv[arg + 1],
+		       (unsigned long)frames, frames * BENCH_ROUNDS / total,
+		       frames * BENCH_ROUNDS / total / CHIP8_TIMER_HZ,
+		       same ? "yes" : "NO");
+		if (!same)
+			return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,310 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/video.h"
+
+/*
+ * Run every ROM headless for a fixed amount of instructions on every engine,
+ * and report instructions per second, nanoseconds per instruction, cost of
+ * turning a frame into an image, and memory footprint. Results can be written
+ * as JSON, and checked against a baseline written the same way, failing if
+ * any result got slower than the threshold allows.
+ */
+
+#define BENCH_DEFAULT_COUNT     20000000UL /* Default instructions per run. */
+#define BENCH_DEFAULT_THRESHOLD 30.0       /* Default regression in percent. */
+#define BENCH_TIMER_DIV         1000       /* Instructions per 60Hz frame. */
+#define BENCH_ROUNDS            5          /* Runs to take the median of. */
+#define BENCH_RENDERS           10000      /* Frames to render per run. */
+#define BENCH_NAME_MAX          256        /* Longest ROM path in baseline. */
+
+/* Engines to measure every ROM with... */
+static const struct {
+	chip8_engine engine;
+	const char *name;
+} bench_engines[] = {
+	{ CHIP8_ENGINE_INTERP, "interp" },
+	{ CHIP8_ENGINE_JIT,    "jit"    },
+};
+
+#define BENCH_ENGINES (sizeof bench_engines / sizeof bench_engines[0])
+
+/*
+ * Result of running a single ROM on a single engine.
+ */
+typedef struct {
+	const char *rom;
+	const char *engine;
+	double ips;           /* Instructions per second. */
+	double ns_per_ins;    /* Nanoseconds per instruction. */
+	double render_ns;     /* Nanoseconds to expand a frame to RGBA. */
+	size_t machine_bytes; /* Bytes of CPU, video, and keypad. */
+	long max_rss_kb;      /* Peak resident set size of process so far. */
+} bench_result;
+
+/*
+ * Run ROM for count instructions frame by frame on engine, pressing a key
+ * whenever a frame ends waiting on one. Returns seconds taken, 0.0 if engine
+ * is not supported on this host, or a negative value if ROM failed.
+ */
+static double bench_run(const char *rom, chip8_engine engine,
+		        unsigned long count, bench_result *result)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	chip8_cpu *cpu = NULL;
+	chip8_error flag = CHIP8_EOK;
+	uint32_t buffer[CHIP8_VIDEO_HIRES_WIDTH * CHIP8_VIDEO_HIRES_HEIGHT];
+	unsigned long ran = 0;
+	bool lock = false;
+	uint64_t start = 0;
+	double seconds = -1.0;
+
+	if (chip8_video_init(&video) != CHIP8_EOK ||
+	    chip8_keypad_init(&keys) != CHIP8_EOK ||
+	    chip8_cpu_init(&cpu, video, keys,
+			   BENCH_TIMER_DIV * CHIP8_TIMER_HZ) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+
+	if (chip8_cpu_setengine(cpu, engine) != CHIP8_EOK) {
+		seconds = 0.0;
+		goto out;
+	}
+	if (chip8_cpu_romload(cpu, rom) != CHIP8_EOK)
+		goto out;
+
+	start = chip8_now();
+	for (unsigned long n = 0; n < count && flag == CHIP8_EOK; n += ran) {
+		chip8_keypad_islock(cpu->keypad, &lock);
+		if (lock)
+			chip8_keypad_setkey(cpu->keypad, n & 0xF, CHIP8_KEY_DOWN);
+		flag = chip8_cpu_run(cpu, count - n, &ran);
+	}
+	if (flag != CHIP8_EOK)
+		goto out;
+	seconds = (chip8_now() - start) / 1e9;
+
+	/* Render whatever the ROM left on screen... */
+	start = chip8_now();
+	for (int n = 0; n < BENCH_RENDERS; n++)
+		chip8_video_rgba(video, buffer);
+	result->render_ns = (double)(chip8_now() - start) / BENCH_RENDERS;
+	result->machine_bytes = sizeof *cpu + sizeof *video + sizeof *keys;
+out:
+	chip8_cpu_free(cpu);
+	chip8_keypad_free(keys);
+	chip8_video_free(video);
+	return seconds;
+}
+
+/*
+ * Compare two doubles for qsort().
+ */
+static int bench_cmp(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Get median of len values, sorting them in place.
+ */
+static double bench_median(double *values, size_t len)
+{
+	qsort(values, len, sizeof *values, bench_cmp);
+	return (len % 2 != 0) ? values[len / 2] :
+	       (values[len / 2 - 1] + values[len / 2]) / 2.0;
+}
+
+/*
+ * Measure ROM on engine, keeping the median of a few rounds. Returns false if
+ * engine is not supported, and dies if ROM failed.
+ */
+static bool bench_measure(const char *rom, size_t engine, unsigned long count,
+			  bench_result *result)
+{
+	struct rusage usage;
+	bench_result round;
+	double seconds[BENCH_ROUNDS];
+	double render[BENCH_ROUNDS];
+	double median = 0.0;
+
+	result->rom = rom;
+	result->engine = bench_engines[engine].name;
+	for (int n = 0; n < BENCH_ROUNDS; n++) {
+		seconds[n] = bench_run(rom, bench_engines[engine].engine, count,
+				       &round);
+		if (seconds[n] < 0.0) {
+			fprintf(stderr, "bench_suite: %s failed on %s\n", rom,
+				result->engine);
+			exit(EXIT_FAILURE);
+		} else if (seconds[n] == 0.0) {
+			return false;
+		}
+		render[n] = round.render_ns;
+		result->machine_bytes = round.machine_bytes;
+	}
+
+	/* Best of rounds swings with whatever else the host is doing, median
+	 * holds still unless most rounds got slower... */
+	median = bench_median(seconds, BENCH_ROUNDS);
+	result->ips = count / median;
+	result->ns_per_ins = median * 1e9 / count;
+	result->render_ns = bench_median(render, BENCH_ROUNDS);
+	getrusage(RUSAGE_SELF, &usage);
+	result->max_rss_kb = usage.ru_maxrss;
+	return true;
+}
+
+/*
+ * Write results as JSON, one result per line so baselines stay easy to diff
+ * and to read back.
+ */
+static void bench_json(FILE *file, const bench_result *results, size_t len,
+		       unsigned long count)
+{
+	fprintf(file, "{\n  \"version\": \"%s\",\n  \"count\": %lu,\n"
+		"  \"results\": [\n", VERSION, count);
+	for (size_t n = 0; n < len; n++) {
+		fprintf(file, "    {\"rom\": \"%s\", \"engine\": \"%s\", "
+			"\"ips\": %.0f, \"ns_per_ins\": %.3f, "
+			"\"render_ns\": %.1f, \"machine_bytes\": %zu, "
+			"\"max_rss_kb\": %ld}%s\n", results[n].rom,
+			results[n].engine, results[n].ips,
+			results[n].ns_per_ins, results[n].render_ns,
+			results[n].machine_bytes, results[n].max_rss_kb,
+			(n + 1 < len) ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+}
+
+/*
+ * Compare results against baseline written by bench_json(). Results missing
+ * from baseline are skipped. Returns amount of regressions.
+ */
+static int bench_compare(const char *path, const bench_result *results,
+			 size_t len, double threshold)
+{
+	char line[1024];
+	char rom[BENCH_NAME_MAX];
+	char engine[16];
+	double ips = 0.0;
+	double change = 0.0;
+	int regressions = 0;
+	FILE *file = fopen(path, "r");
+
+	if (file == NULL) {
+		fprintf(stderr, "bench_suite: cannot open baseline %s\n", path);
+		return 1;
+	}
+
+	printf("\n%-28s %-8s %14s %14s %9s\n", "rom", "engine", "baseline/s",
+	       "ins/s", "change");
+	while (fgets(line, sizeof line, file) != NULL) {
+		if (sscanf(line, " {\"rom\": \"%255[^\"]\", \"engine\": "
+			   "\"%15[^\"]\", \"ips\": %lf", rom, engine,
+			   &ips) != 3 || ips <= 0.0)
+			continue;
+
+		for (size_t n = 0; n < len; n++) {
+			if (strcmp(results[n].rom, rom) != 0 ||
+			    strcmp(results[n].engine, engine) != 0)
+				continue;
+
+			change = (results[n].ips - ips) * 100.0 / ips;
+			printf("%-28s %-8s %14.0f %14.0f %8.1f%%%s\n", rom,
+			       engine, ips, results[n].ips, change,
+			       (change < -threshold) ? " REGRESSION" : "");
+			regressions += change < -threshold;
+		}
+	}
+	fclose(file);
+	return regressions;
+}
+
+int main(int argc, char **argv)
+{
+	bench_result *results = NULL;
+	size_t len = 0;
+	unsigned long count = BENCH_DEFAULT_COUNT;
+	double threshold = BENCH_DEFAULT_THRESHOLD;
+	const char *json = NULL;
+	const char *baseline = NULL;
+	char *env = getenv("BENCH_COUNT");
+	FILE *file = NULL;
+	int regressions = 0;
+	int arg = 1;
+
+	for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+		if (strcmp(argv[arg], "-j") == 0)
+			json = argv[arg + 1];
+		else if (strcmp(argv[arg], "-b") == 0)
+			baseline = argv[arg + 1];
+		else if (strcmp(argv[arg], "-t") == 0)
+			threshold = strtod(argv[arg + 1], NULL);
+		else
+			break;
+	}
+
+	if (arg >= argc || threshold <= 0.0) {
+		fprintf(stderr, "usage: bench_suite [-j out.json] "
+			"[-b baseline.json] [-t percent] <rom>...\n");
+		return EXIT_FAILURE;
+	}
+
+	if (env != NULL)
+		count = strtoul(env, NULL, 10);
+
+	results = calloc((argc - arg) * BENCH_ENGINES, sizeof *results);
+	if (results == NULL)
+		chip8_die(CHIP8_ENOMEM);
+
+	printf("%-28s %-8s %14s %10s %10s %10s %10s\n", "rom", "engine",
+	       "ins/s", "ns/ins", "render ns", "machine B", "rss KiB");
+	for (; arg < argc; arg++) {
+		for (size_t engine = 0; engine < BENCH_ENGINES; engine++) {
+			if (!bench_measure(argv[arg], engine, count,
+					   &results[len]))
+				continue;
+			printf("%-28s %-8s %14.0f %10.3f %10.1f %10zu %10ld\n",
+			       results[len].rom, results[len].engine,
+			       results[len].ips, results[len].ns_per_ins,
+			       results[len].render_ns,
+			       results[len].machine_bytes,
+			       results[len].max_rss_kb);
+			len++;
+		}
+	}
+
+	if (json != NULL) {
+		file = fopen(json, "w");
+		if (file == NULL)
+			chip8_die(CHIP8_ENOFILE);
+		bench_json(file, results, len, count);
+		fclose(file);
+	}
+
+	if (baseline != NULL) {
+		regressions = bench_compare(baseline, results, len, threshold);
+		if (regressions != 0)
+			printf("%d result(s) regressed more than %.1f%%\n",
+			       regressions, threshold);
+	}
+
+	free(results);
+	return (regressions == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,246 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/opcode.h"
+#include "core/video.h"
+
+/*
+ * Compare sprites drawn per second by the packed word per row DXYN against
+ * the byte per pixel loop it replaced. Both draw the same sprites at the same
+ * spots, and must end up with the same screen. Next compare frames expanded
+ * into RGBA per second by chip8_video_rgba() against a plain per pixel loop.
+ * Then run a set of ROMs for a
+ * while at their regular speed, and count how many frames a window would
+ * skip, and how much it would upload, with dirty row tracking.
+ */
+
+#define BENCH_DEFAULT_COUNT 10000000UL /* Default sprites per run. */
+#define BENCH_SPOTS         256        /* Distinct sprite draws cycled. */
+#define BENCH_FRAMES        3600       /* 60Hz frames to run ROMs for. */
+#define BENCH_EXPANDS       100000     /* Frames to expand into RGBA. */
+#define BENCH_ROW_BYTES     (CHIP8_VIDEO_WIDTH * 4) /* Bytes of RGBA row. */
+
+/*
+ * Reference screen, one byte per pixel like chip8_video used to be.
+ */
+static uint8_t bench_pixels[CHIP8_VIDEO_HEIGHT][CHIP8_VIDEO_WIDTH];
+
+/*
+ * Reference DXYN, the nested per pixel loop used before rows were packed,
+ * with the same wrap and clip rules as the current handler.
+ */
+static chip8_error bench_bytes_DXYN(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	uint8_t xpos = cpu->v[ins->x] % CHIP8_VIDEO_WIDTH;
+	uint8_t ypos = cpu->v[ins->y] % CHIP8_VIDEO_HEIGHT;
+	uint8_t pixel = 0;
+
+	cpu->v[0xF] = 0;
+	for (int col = 0; col < ins->n && ypos + col < CHIP8_VIDEO_HEIGHT;
+	     col++) {
+		pixel = cpu->memory[cpu->i + col];
+		for (int row = 0; row < 8 && xpos + row < CHIP8_VIDEO_WIDTH;
+		     row++) {
+			if ((pixel & (0x80 >> row)) != 0) {
+				if (bench_pixels[ypos + col][xpos + row] == 1)
+					cpu->v[0xF] = 1;
+				bench_pixels[ypos + col][xpos + row] ^= 1;
+			}
+		}
+	}
+	return CHIP8_EOK;
+}
+
+/*
+ * Draw count sprites with handler, cycling through BENCH_SPOTS positions,
+ * heights, and font glyphs. Returns sprites per second.
+ */
+static double bench_draw(chip8_cpu *cpu, chip8_opcode_handler handler,
+		         unsigned long count)
+{
+	chip8_instr ins = { .x = 0, .y = 1 };
+	uint16_t glyph[BENCH_SPOTS];
+	uint8_t xpos[BENCH_SPOTS];
+	uint8_t ypos[BENCH_SPOTS];
+	uint8_t height[BENCH_SPOTS];
+	uint64_t start = 0;
+	size_t spot = 0;
+
+	for (size_t n = 0; n < BENCH_SPOTS; n++) {
+		glyph[n] = (n % 16) * 5;
+		xpos[n] = n * 7;
+		ypos[n] = n * 3;
+		height[n] = 1 + n % 15;
+	}
+
+	chip8_video_clear(cpu->video);
+	start = chip8_now();
+	for (unsigned long n = 0; n < count; n++) {
+		cpu->v[0] = xpos[spot];
+		cpu->v[1] = ypos[spot];
+		cpu->i = glyph[spot];
+		ins.n = height[spot];
+		handler(cpu, &ins);
+		spot = (spot + 1) % BENCH_SPOTS;
+	}
+	return count * 1e9 / (chip8_now() - start);
+}
+
+/*
+ * Reference RGBA expansion, picking a palette color pixel by pixel.
+ */
+static chip8_error bench_scalar_rgba(const chip8_video *video,
+		                     uint32_t *buffer)
+{
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			*buffer++ = video->palette[chip8_video_get(video, x, y)];
+	return CHIP8_EOK;
+}
+
+/*
+ * Expand screen of video into buffer BENCH_EXPANDS times. Returns frames
+ * expanded per second.
+ */
+static double bench_expand(const chip8_video *video, uint32_t *buffer,
+		           chip8_error (*expand)(const chip8_video *,
+					         uint32_t *))
+{
+	uint64_t start = chip8_now();
+
+	for (int n = 0; n < BENCH_EXPANDS; n++)
+		expand(video, buffer);
+	return BENCH_EXPANDS * 1e9 / (chip8_now() - start);
+}
+
+/*
+ * Run ROM for BENCH_FRAMES frames, collecting dirty rows after every frame.
+ * Returns frames without a single dirty row, and rows uploaded in rows, or a
+ * negative value if ROM failed.
+ */
+static long bench_dirty(const char *rom, unsigned long *rows)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	chip8_cpu *cpu = NULL;
+	chip8_error flag = CHIP8_EOK;
+	unsigned long ran = 0;
+	uint64_t ticks = 0;
+	bool lock = false;
+	long skipped = -1;
+
+	if (chip8_video_init(&video) != CHIP8_EOK ||
+	    chip8_keypad_init(&keys) != CHIP8_EOK ||
+	    chip8_cpu_init(&cpu, video, keys, 0) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+	if (chip8_cpu_romload(cpu, rom) != CHIP8_EOK)
+		goto out;
+
+	skipped = 0;
+	*rows = 0;
+	video->dirty = 0;
+	for (int frame = 0; frame < BENCH_FRAMES && flag == CHIP8_EOK;) {
+		chip8_keypad_islock(cpu->keypad, &lock);
+		if (lock)
+			chip8_keypad_setkey(cpu->keypad, frame & 0xF,
+					    CHIP8_KEY_DOWN);
+		flag = chip8_cpu_run(cpu, cpu->opnum, &ran);
+		if (cpu->timer_count == ticks)
+			continue;
+
+		/* Virtual clock just ticked, so present a frame... */
+		ticks = cpu->timer_count;
+		skipped += video->dirty == 0;
+		for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+			*rows += (video->dirty >> y) & 1;
+		video->dirty = 0;
+		frame++;
+	}
+	if (flag != CHIP8_EOK)
+		skipped = -1;
+out:
+	chip8_cpu_free(cpu);
+	chip8_keypad_free(keys);
+	chip8_video_free(video);
+	return skipped;
+}
+
+int main(int argc, char **argv)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	chip8_cpu *cpu = NULL;
+	unsigned long count = BENCH_DEFAULT_COUNT;
+	const char *env = getenv("BENCH_COUNT");
+	double bytes = 0.0;
+	double words = 0.0;
+	uint32_t scalar[CHIP8_VIDEO_WIDTH * CHIP8_VIDEO_HEIGHT];
+	uint32_t vector[CHIP8_VIDEO_WIDTH * CHIP8_VIDEO_HEIGHT];
+	unsigned long rows = 0;
+	long skipped = 0;
+	int same = 1;
+
+	if (env != NULL)
+		count = strtoul(env, NULL, 10);
+
+	if (chip8_video_init(&video) != CHIP8_EOK ||
+	    chip8_keypad_init(&keys) != CHIP8_EOK ||
+	    chip8_cpu_init(&cpu, video, keys, 0) != CHIP8_EOK)
+		chip8_die(CHIP8_ENOMEM);
+
+	bytes = bench_draw(cpu, bench_bytes_DXYN, count);
+	words = bench_draw(cpu, chip8_opcode_DXYN, count);
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			same = same && chip8_video_get(video, x, y) ==
+			       bench_pixels[y][x];
+
+	printf("%-12s %16s %10s\n", "DXYN", "sprites/s", "ns/sprite");
+	printf("%-12s %16.0f %10.2f\n", "bytes", bytes, 1e9 / bytes);
+	printf("%-12s %16.0f %10.2f\n", "words", words, 1e9 / words);
+	printf("speedup: %.2fx, screens %s\n\n", words / bytes,
+	       same ? "identical" : "DIFFER");
+
+	bytes = bench_expand(video, scalar, bench_scalar_rgba);
+	words = bench_expand(video, vector, chip8_video_rgba);
+	same = same && memcmp(scalar, vector, sizeof scalar) == 0;
+	printf("%-12s %16s %10s\n", "RGBA", "frames/s", "ns/frame");
+	printf("%-12s %16.0f %10.2f\n", "scalar", bytes, 1e9 / bytes);
+	printf("%-12s %16.0f %10.2f\n", chip8_video_isa(), words,
+	       1e9 / words);
+	printf("speedup: %.2fx, images %s\n\n", words / bytes,
+	       (memcmp(scalar, vector, sizeof scalar) == 0) ?
+	       "identical" : "DIFFER");
+
+	printf("%-28s %10s %10s %14s %14s\n", "rom", "frames", "skipped",
+	       "full bytes", "dirty bytes");
+	for (int arg = 1; arg < argc; arg++) {
+		skipped = bench_dirty(argv[arg], &rows);
+		if (skipped < 0) {
+			printf("%-28s %10s %10s %14s %14s\n", argv[arg],
+			       "error", "error", "error", "error");
+			same = 0;
+			continue;
+		}
+		printf("%-28s %10d %10ld %14lu %14lu\n", argv[arg],
+		       BENCH_FRAMES, skipped,
+		       (unsigned long)BENCH_FRAMES * CHIP8_VIDEO_HEIGHT *
+		       BENCH_ROW_BYTES, rows * BENCH_ROW_BYTES);
+	}
+
+	chip8_cpu_free(cpu);
+	chip8_keypad_free(keys);
+	chip8_video_free(video);
+	return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
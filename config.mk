@@ -8,24 +8,39 @@ VERSION = 0.2.0
 PREFIX = /usr/local
 MANPREFIX = $(PREFIX)/share/man
 
-# Libraries and includes...
-LIBS = -lm `pkg-config --libs sdl2`
-INCS = -Isrc/ `pkg-config --cflags sdl2`
+# Libraries and includes of headless core...
+LIBS = -lm -lpthread
+INCS = -Isrc/
+
+# Libraries and includes of SDL2 frontend...
+SDL_LIBS = `pkg-config --libs sdl2`
+SDL_INCS = `pkg-config --cflags sdl2`
+
+# Uncomment for threaded dispatch, needs GCC or Clang...
+#THREADED = -DCHIP8_THREADED
+
+# Uncomment for AVX2 lockstep lanes and pixel expansion instead of SSE2, needs
+# an AVX2 CPU...
+#SIMD = -mavx2
 
 # Flags...
 CPPFLAGS = -D_DEFAULT_SOURCE \
 	   -D_BSD_SOURCE \
 	   -D_POSIX_C_SOURCE=200809L \
 	   -D_REENTRANT \
-	   -DVERSION=\"$(VERSION)\"
+	   -DVERSION=\"$(VERSION)\" \
+	   $(THREADED)
 CFLAGS   = -std=c99 \
 	   -pedantic \
 	   -Wall \
 	   -g \
 	   -Os \
+	   -fPIC \
+	   $(SIMD) \
 	   $(INCS) \
 	   $(CPPFLAGS)
 LDFLAGS  = $(LIBS)
 
-# Compiler and linker...
+# Compiler, linker, and archiver...
 CC = cc
+AR = ar
@@ -0,0 +1,360 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/capture.h"
+#include "core/video.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_CAPTURE_IDLE 2000000 /**< Nanoseconds writer thread naps. */
+
+/**
+ * @brief Frame waiting in queue.
+ */
+typedef struct {
+	uint64_t rows[CHIP8_VIDEO_WORDS]; /**< Pixel data of frame. */
+	uint32_t palette[2];              /**< Palette of frame. */
+	bool hires;                       /**< Frame is in high resolution. */
+	uint64_t gap; /**< Copies of frame before to write ahead of this one. */
+} chip8_capture_frame;
+
+struct chip8_capture {
+	chip8_capture_frame *ring;   /**< Queue of frames. */
+	size_t mask;                 /**< Capacity of queue minus one. */
+	uint64_t head;               /**< Frames queued, written by producer. */
+	uint64_t tail;               /**< Frames taken, written by thread. */
+	chip8_capture_format format; /**< Format of capture. */
+	unsigned int scale;          /**< Scale factor of frames. */
+	uint8_t *image;              /**< Frame last converted by thread. */
+	size_t size;                 /**< Bytes of a converted frame. */
+	bool converted;              /**< Image holds a frame yet. */
+	uint64_t gap;                /**< Frames left out since last queued. */
+	uint64_t hash;               /**< Hash of frame last queued. */
+	uint32_t palette[2];         /**< Palette of frame last queued. */
+	chip8_capture_stats stats;   /**< Statistics of capture. */
+	bool quit;                   /**< Tells writer thread to finish. */
+	chip8_error status;          /**< Result of writing frames. */
+	FILE *file;                  /**< File capture is written to. */
+	pthread_t thread;            /**< Writer thread. */
+};
+
+/**
+ * @brief Expand frame into scaled plane of pixels, bytes bytes each.
+ *
+ * @note INTERNAL USE ONLY! Planes are always the size of a scaled low
+ *       resolution frame, so high resolution pixels are half as big.
+ */
+static void chip8_capture_plane(const chip8_capture *capture,
+		                const chip8_capture_frame *frame, uint8_t *at,
+				const uint8_t *off, const uint8_t *on,
+				size_t bytes)
+{
+	const unsigned int width = CHIP8_VIDEO_WIDTH * capture->scale;
+	const unsigned int height = CHIP8_VIDEO_HEIGHT * capture->scale;
+	const unsigned int pitch = frame->hires ? 2 : 1;
+	const unsigned int shift = frame->hires ? 1 : 0;
+	const size_t line = width * bytes;
+	const uint64_t *row = NULL;
+	unsigned int x = 0;
+
+	for (unsigned int y = 0; y < height; y++) {
+		/* Rows showing the same row of the frame are copies... */
+		if (y != 0 && (y << shift) / capture->scale ==
+		    ((y - 1) << shift) / capture->scale) {
+			memcpy(at, at - line, line);
+			at += line;
+			continue;
+		}
+
+		row = &frame->rows[pitch * ((y << shift) / capture->scale)];
+		for (unsigned int n = 0; n < width; n++) {
+			x = (n << shift) / capture->scale;
+			memcpy(at, ((row[x / 64] >> (63 - x % 64)) & 1) ?
+			       on : off, bytes);
+			at += bytes;
+		}
+	}
+}
+
+/**
+ * @brief Convert frame into image in format of capture.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_capture_convert(chip8_capture *capture,
+		                  const chip8_capture_frame *frame)
+{
+	const size_t plane = capture->size / 3;
+	uint8_t color[2][4];
+	int r = 0;
+	int g = 0;
+	int b = 0;
+
+	for (int n = 0; n < 2; n++) {
+		r = (frame->palette[n] >> 24) & 0xFF;
+		g = (frame->palette[n] >> 16) & 0xFF;
+		b = (frame->palette[n] >> 8) & 0xFF;
+		if (capture->format == CHIP8_CAPTURE_RGBA) {
+			color[n][0] = r;
+			color[n][1] = g;
+			color[n][2] = b;
+			color[n][3] = frame->palette[n] & 0xFF;
+		} else {
+			/* BT.601 limited range, kept positive by an offset... */
+			color[n][0] = ((66 * r + 129 * g + 25 * b + 128) >> 8) +
+				      16;
+			color[n][1] = (-38 * r - 74 * g + 112 * b + 32896) >> 8;
+			color[n][2] = (112 * r - 94 * g - 18 * b + 32896) >> 8;
+		}
+	}
+
+	if (capture->format == CHIP8_CAPTURE_RGBA) {
+		chip8_capture_plane(capture, frame, capture->image, color[0],
+				    color[1], 4);
+	} else {
+		for (int p = 0; p < 3; p++)
+			chip8_capture_plane(capture, frame,
+					    capture->image + p * plane,
+					    &color[0][p], &color[1][p], 1);
+	}
+	capture->converted = true;
+}
+
+/**
+ * @brief Write image of last converted frame some amount of times.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_capture_write(chip8_capture *capture, uint64_t copies)
+{
+	for (uint64_t n = 0; capture->converted && n < copies; n++) {
+		if ((capture->format == CHIP8_CAPTURE_Y4M &&
+		     fputs("FRAME\n", capture->file) == EOF) ||
+		    fwrite(capture->image, 1, capture->size, capture->file) !=
+		    capture->size)
+			capture->status = CHIP8_EIO;
+		__atomic_fetch_add(&capture->stats.written, 1,
+				   __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * @brief Convert and write frames from tail up to head.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @return Amount of frames taken from queue.
+ */
+static uint64_t chip8_capture_drain(chip8_capture *capture, uint64_t head)
+{
+	chip8_capture_frame *frame = NULL;
+	uint64_t tail = capture->tail;
+	uint64_t start = tail;
+
+	while (tail != head) {
+		frame = &capture->ring[tail & capture->mask];
+		chip8_capture_write(capture, frame->gap);
+		chip8_capture_convert(capture, frame);
+		tail++;
+		__atomic_store_n(&capture->tail, tail, __ATOMIC_RELEASE);
+		chip8_capture_write(capture, 1);
+	}
+	return tail - start;
+}
+
+/**
+ * @brief Writer thread, writes frames until told to quit.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void *chip8_capture_thread(void *arg)
+{
+	chip8_capture *capture = arg;
+	struct timespec idle = { 0, CHIP8_CAPTURE_IDLE };
+	uint64_t head = 0;
+	bool quit = false;
+
+	do {
+		quit = __atomic_load_n(&capture->quit, __ATOMIC_ACQUIRE);
+		head = __atomic_load_n(&capture->head, __ATOMIC_ACQUIRE);
+		if (chip8_capture_drain(capture, head) == 0 && !quit)
+			nanosleep(&idle, NULL);
+	} while (!quit);
+	return NULL;
+}
+
+chip8_error chip8_capture_init(chip8_capture **capture, const char *path,
+		               chip8_capture_format format, unsigned int scale,
+			       size_t capacity)
+{
+	chip8_capture *newcap = NULL;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	size_t cap = 1;
+
+	if (capture == NULL || path == NULL)
+		return CHIP8_EINVAL;
+
+	if (scale == 0)
+		scale = CHIP8_CAPTURE_SCALE;
+	if (capacity == 0)
+		capacity = CHIP8_CAPTURE_CAPACITY;
+	while (cap < capacity)
+		cap <<= 1;
+
+	newcap = calloc(1, sizeof *newcap);
+	if (newcap == NULL)
+		return CHIP8_ENOMEM;
+
+	width = CHIP8_VIDEO_WIDTH * scale;
+	height = CHIP8_VIDEO_HEIGHT * scale;
+	newcap->format = format;
+	newcap->scale = scale;
+	newcap->mask = cap - 1;
+	newcap->size = (size_t)width * height *
+		       ((format == CHIP8_CAPTURE_RGBA) ? 4 : 3);
+	newcap->ring = malloc(cap * sizeof *newcap->ring);
+	newcap->image = malloc(newcap->size);
+	if (newcap->ring == NULL || newcap->image == NULL)
+		goto out_capture;
+
+	newcap->file = (strcmp(path, "-") == 0) ? stdout : fopen(path, "wb");
+	if (newcap->file == NULL) {
+		free(newcap->image);
+		free(newcap->ring);
+		free(newcap);
+		return CHIP8_ENOFILE;
+	}
+
+	if (format == CHIP8_CAPTURE_Y4M &&
+	    fprintf(newcap->file, "YUV4MPEG2 W%u H%u F60:1 Ip A1:1 C444\n",
+		    width, height) < 0)
+		newcap->status = CHIP8_EIO;
+
+	if (pthread_create(&newcap->thread, NULL, chip8_capture_thread,
+			   newcap) != 0)
+		goto out_file;
+
+	chip8_debugx("setup new capture %p writing to %s\n", (void *)newcap,
+		     path);
+	*capture = newcap;
+	return CHIP8_EOK;
+
+out_file:
+	if (newcap->file != stdout)
+		fclose(newcap->file);
+out_capture:
+	free(newcap->image);
+	free(newcap->ring);
+	free(newcap);
+	return CHIP8_ENOMEM;
+}
+
+chip8_error chip8_capture_push(chip8_capture *capture,
+		               const chip8_video *video)
+{
+	chip8_capture_frame *frame = NULL;
+	uint64_t head = 0;
+	uint64_t hash = 0;
+
+	if (capture == NULL || video == NULL)
+		return CHIP8_EINVAL;
+
+	capture->stats.frames++;
+	chip8_video_hash(video, &hash);
+	if (capture->stats.queued != 0 && hash == capture->hash &&
+	    video->palette[0] == capture->palette[0] &&
+	    video->palette[1] == capture->palette[1]) {
+		capture->stats.repeats++;
+		capture->gap++;
+		return CHIP8_EOK;
+	}
+
+	/* Never wait on the writer, show the frame before for longer... */
+	head = capture->head;
+	if (head - __atomic_load_n(&capture->tail, __ATOMIC_ACQUIRE) >
+	    capture->mask) {
+		capture->stats.dropped++;
+		capture->gap++;
+		return CHIP8_EOK;
+	}
+
+	frame = &capture->ring[head & capture->mask];
+	memcpy(frame->rows, video->rows, sizeof frame->rows);
+	frame->hires = video->hires;
+	frame->palette[0] = video->palette[0];
+	frame->palette[1] = video->palette[1];
+	frame->gap = capture->gap;
+	__atomic_store_n(&capture->head, head + 1, __ATOMIC_RELEASE);
+
+	capture->stats.queued++;
+	capture->gap = 0;
+	capture->hash = hash;
+	capture->palette[0] = video->palette[0];
+	capture->palette[1] = video->palette[1];
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_capture_sync(chip8_capture *capture)
+{
+	if (capture == NULL)
+		return CHIP8_EINVAL;
+
+	while (capture->head - __atomic_load_n(&capture->tail,
+					       __ATOMIC_ACQUIRE) >
+	       capture->mask)
+		sched_yield();
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_capture_stat(const chip8_capture *capture,
+		               chip8_capture_stats *stats)
+{
+	if (capture == NULL || stats == NULL)
+		return CHIP8_EINVAL;
+
+	stats->frames = capture->stats.frames;
+	stats->queued = capture->stats.queued;
+	stats->repeats = capture->stats.repeats;
+	stats->dropped = capture->stats.dropped;
+	stats->written = __atomic_load_n(&capture->stats.written,
+					 __ATOMIC_RELAXED);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_capture_free(chip8_capture *capture)
+{
+	chip8_error flag = CHIP8_EOK;
+
+	if (capture == NULL)
+		return CHIP8_EOK;
+
+	__atomic_store_n(&capture->quit, true, __ATOMIC_RELEASE);
+	pthread_join(capture->thread, NULL);
+
+	/* Frames left out after the last queued one still take their time... */
+	chip8_capture_write(capture, capture->gap);
+	flag = capture->status;
+	if (capture->file == stdout) {
+		if (fflush(capture->file) != 0)
+			flag = CHIP8_EIO;
+	} else if (fclose(capture->file) != 0) {
+		flag = CHIP8_EIO;
+	}
+	free(capture->image);
+	free(capture->ring);
+	free(capture);
+	chip8_debug("free CHIP-8 capture");
+	return flag;
+}
@@ -0,0 +1,118 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_CAPTURE_H
+#define CHIP8_CORE_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/video.h"
+#include "utils/error.h"
+
+#define CHIP8_CAPTURE_CAPACITY 64 /**< Default frames in queue. */
+#define CHIP8_CAPTURE_SCALE    4  /**< Default scale factor of frames. */
+
+/**
+ * @brief Formats a capture can be written in.
+ */
+typedef enum {
+	CHIP8_CAPTURE_Y4M,  /**< YUV4MPEG2 stream, 4:4:4 at 60 frames/sec. */
+	CHIP8_CAPTURE_RGBA  /**< Headerless RGBA bytes, frame after frame. */
+} chip8_capture_format;
+
+/**
+ * @brief Statistics of a capture.
+ */
+typedef struct {
+	uint64_t frames;  /**< Frames pushed so far. */
+	uint64_t queued;  /**< Frames that went into the queue. */
+	uint64_t repeats; /**< Frames left out for being the same as before. */
+	uint64_t dropped; /**< Frames left out for finding the queue full. */
+	uint64_t written; /**< Frames written to file so far. */
+} chip8_capture_stats;
+
+/**
+ * @brief Video capture of presented frames.
+ *
+ * @note Frames go into a single producer, single consumer lock-free queue
+ *       that a background thread scales, converts, and writes out, so the
+ *       emulation thread only ever copies a packed frame. A frame the same as
+ *       the one before is not queued at all, and neither is a frame that
+ *       finds the queue full. Both are written as another copy of the frame
+ *       before, so the stream keeps one frame per 60Hz frame of emulation,
+ *       and pushing never waits on the writer. Frames are always the size
+ *       of a scaled low resolution screen, with high resolution pixels half
+ *       as big, so use an even scale to keep every one of them.
+ */
+typedef struct chip8_capture chip8_capture;
+
+/**
+ * @brief Create capture writing to file, and start its writer thread.
+ *
+ * @note Set path to "-" to write to stdout, such as for piping into an
+ *       encoder. Set scale to 0 to use #CHIP8_CAPTURE_SCALE, and capacity to
+ *       0 to use #CHIP8_CAPTURE_CAPACITY. Capacity is rounded up to a power
+ *       of two.
+ *
+ * @pre capture and path cannot be NULL.
+ *
+ * @param[in,out] capture Capture to initialize.
+ * @param[in] path File to write capture to.
+ * @param[in] format Format of capture.
+ * @param[in] scale Scale factor of frames.
+ * @param[in] capacity Frames the queue holds.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_capture_init(chip8_capture **capture, const char *path,
+		               chip8_capture_format format, unsigned int scale,
+			       size_t capacity);
+
+/**
+ * @brief Capture frame.
+ *
+ * @pre capture and video cannot be NULL.
+ *
+ * @param[in,out] capture Capture to push frame into.
+ * @param[in] video Frame to capture.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_capture_push(chip8_capture *capture,
+		               const chip8_video *video);
+
+/**
+ * @brief Wait for queue of capture to have room for another frame.
+ *
+ * @note For callers that do not run in real time, and would rather wait on
+ *       the writer than have frames left out of the queue.
+ *
+ * @pre capture cannot be NULL.
+ *
+ * @param[in,out] capture Capture to wait on.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_capture_sync(chip8_capture *capture);
+
+/**
+ * @brief Get statistics of capture.
+ *
+ * @pre capture and stats cannot be NULL.
+ *
+ * @param[in] capture Capture to get statistics of.
+ * @param[out] stats Statistics of capture.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_capture_stat(const chip8_capture *capture,
+		               chip8_capture_stats *stats);
+
+/**
+ * @brief Write out queued frames, stop writer thread, and free capture.
+ *
+ * @param[in,out] capture Capture to free, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success, or #CHIP8_EIO if any frame failed to
+ *         be written.
+ */
+chip8_error chip8_capture_free(chip8_capture *capture);
+
+#endif /* CHIP8_CORE_CAPTURE_H */
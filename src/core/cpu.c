@@ -13,11 +13,18 @@
 #include "core/keypad.h"
 #include "core/cpu.h"
 #include "core/opcode.h"
-#include "core/audio.h"
+#include "core/decode.h"
+#include "core/jit.h"
+#include "core/interp.h"
+#include "core/prof.h"
+#include "core/trace.h"
 #include "utils/auxfun.h"
 
-#define CHIP8_TIMER_FREQ (1.0f / 60.0f) /**< 60Hz timer frequency. */
-#define CHIP8_DEFAULT_OPNUM 700         /**< Default opcodes per second. */
+#define CHIP8_DEFAULT_OPNUM 700  /**< Default opcodes per second. */
+#define CHIP8_DEFAULT_SEED 0     /**< Default random number seed. */
+
+#define CHIP8_PCG_MULT UINT64_C(6364136223846793005) /**< PCG32 multiplier. */
+#define CHIP8_PCG_INC  UINT64_C(1442695040888963407) /**< PCG32 increment. */
 
 /**
  * @brief Initialize RAM.
@@ -52,8 +59,31 @@ static chip8_error chip8_cpu_raminit(chip8_cpu *cpu)
 		0xF0, 0x80, 0xF0, 0x80, 0x80, /* F */
 	};
 
+	/* SUPER-CHIP 8x10 digits that FX30 points I at... */
+	const uint8_t large_map[] = {
+		0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF,
+		0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF,
+		0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+		0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+		0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03,
+		0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+		0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18,
+		0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+		0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3,
+		0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC,
+		0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C,
+		0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC,
+		0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0,
+	};
+
 	memset(cpu->memory, 0, sizeof *(cpu->memory) * CHIP8_RAM_SIZE);
 	memcpy(cpu->memory, font_map, chip8_arrsize(font_map));
+	memcpy(cpu->memory + CHIP8_FONT_LARGE, large_map,
+	       chip8_arrsize(large_map));
+	chip8_cpu_invalidate(cpu, 0, CHIP8_RAM_SIZE);
 	return CHIP8_EOK;
 }
 
@@ -74,14 +104,14 @@ static chip8_error chip8_cpu_getdelta(chip8_cpu *cpu, float *delta)
 	if (cpu == NULL || delta == NULL)
 		return CHIP8_EINVAL;
 
-	Uint64 end = SDL_GetPerformanceCounter();
-	*delta = (float)(end - cpu->ticks) / SDL_GetPerformanceFrequency();
+	uint64_t end = chip8_now();
+	*delta = (float)(end - cpu->ticks) / 1e9f;
 	cpu->ticks = end;
 	return CHIP8_EOK;
 }
 
 chip8_error chip8_cpu_init(chip8_cpu **cpu, chip8_video *video,
-		           chip8_keypad *keypad, chip8_audio *audio, unsigned int opnum)
+		           chip8_keypad *keypad, unsigned int opnum)
 {
 	chip8_error flag = CHIP8_EOK;
 	chip8_cpu *newcpu = NULL;
@@ -92,26 +122,31 @@ chip8_error chip8_cpu_init(chip8_cpu **cpu, chip8_video *video,
 	if (opnum == 0)
 		opnum = CHIP8_DEFAULT_OPNUM;
 
-	if (SDL_InitSubSystem(SDL_INIT_TIMER) < 0)
-		return CHIP8_ESDL;
-
 	newcpu = malloc(sizeof *newcpu);
 	if (newcpu == NULL)
 		return CHIP8_ENOMEM;
 
+	chip8_decode_init();
+	newcpu->jit = NULL;
+	newcpu->prof = NULL;
+	newcpu->trace = NULL;
+	newcpu->writes = 0;
+	memset(newcpu->rpl, 0, sizeof newcpu->rpl);
+	chip8_cpu_seed(newcpu, CHIP8_DEFAULT_SEED);
+
 	flag = chip8_cpu_raminit(newcpu);
 	if (flag != CHIP8_EOK)
 		goto out_cpu;
 
+	newcpu->video = video;
+	newcpu->keypad = keypad;
 	flag = chip8_cpu_reset(newcpu);
 	if (flag != CHIP8_EOK) {
 		goto out_cpu;
 	}
 
-	newcpu->video = video;
-	newcpu->keypad = keypad;
-	newcpu->audio = audio;
 	newcpu->cycle_freq = (float)(1.0f / opnum);
+	newcpu->opnum = opnum;
 	*cpu = newcpu;
 	goto done;
 
@@ -141,6 +176,7 @@ chip8_error chip8_cpu_romload(chip8_cpu *cpu, const char *rom)
 	}
 
 	memcpy(cpu->memory + CHIP8_ROM_INIT, buffer, romlen);
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, romlen);
 
 out_buffer:
 	free(buffer);
@@ -148,6 +184,54 @@ out_buffer:
 	return flag;
 }
 
+chip8_error chip8_cpu_seed(chip8_cpu *cpu, uint64_t seed)
+{
+	if (cpu == NULL)
+		return CHIP8_EINVAL;
+
+	/* Seeding as done by reference PCG32, so seed 0 works too... */
+	cpu->rng = 0;
+	chip8_cpu_rand(cpu);
+	cpu->rng += seed;
+	chip8_cpu_rand(cpu);
+	return CHIP8_EOK;
+}
+
+uint8_t chip8_cpu_rand(chip8_cpu *cpu)
+{
+	uint64_t old = cpu->rng;
+	uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+	uint32_t rot = old >> 59;
+
+	cpu->rng = old * CHIP8_PCG_MULT + CHIP8_PCG_INC;
+
+	/* Top byte of PCG32 output, which is its best mixed one... */
+	return ((xorshifted >> rot) | (xorshifted << ((32 - rot) & 31))) >> 24;
+}
+
+void chip8_cpu_invalidate(chip8_cpu *cpu, uint16_t addr, uint16_t len)
+{
+	unsigned int first = addr;
+	unsigned int last = (unsigned int)addr + len;
+
+	cpu->writes++;
+	if (cpu->jit != NULL)
+		chip8_jit_invalidate(cpu->jit, addr, len);
+
+	if (len == 0 || first >= CHIP8_RAM_SIZE)
+		return;
+
+	/* Instructions straddle two bytes, so the slot before is stale too... */
+	if (first != 0)
+		first -= 1;
+
+	if (last > CHIP8_RAM_SIZE)
+		last = CHIP8_RAM_SIZE;
+
+	for (unsigned int slot = first; slot < last; slot++)
+		cpu->icache[slot].handler = NULL;
+}
+
 chip8_error chip8_cpu_reset(chip8_cpu *cpu)
 {
 	if (cpu == NULL)
@@ -161,10 +245,36 @@ chip8_error chip8_cpu_reset(chip8_cpu *cpu)
 	cpu->i  = 0;
 	cpu->pc = CHIP8_ROM_INIT;
 	cpu->opcode = 0;
-	cpu->ticks = SDL_GetPerformanceCounter();
-	cpu->timer_ticks = 0.0f;
+	cpu->ticks = chip8_now();
 	cpu->cycle_ticks = 0.0f;
-	return CHIP8_EOK;
+	cpu->cycles = 0;
+	cpu->timer_count = 0;
+	return chip8_video_resolution(cpu->video, false);
+}
+
+/**
+ * @brief Fetch, decode, and execute instruction at program counter.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @pre cpu must not be NULL.
+ * @pre Keypad of cpu must not be locked.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to execute opcode with.
+ * @return 0 (CHIP8_EOK) for success, chip8_error for failure.
+ */
+static inline chip8_error chip8_cpu_dispatch(chip8_cpu *cpu)
+{
+	const chip8_instr *ins = NULL;
+	chip8_instr slow;
+
+	/* Fetch predecoded opcode... */
+	ins = chip8_decode_fetch(cpu, &slow);
+	cpu->opcode = ins->opcode;
+	cpu->pc += 2;
+
+	/* Execute... */
+	return ins->handler(cpu, ins);
 }
 
 /**
@@ -180,171 +290,196 @@ chip8_error chip8_cpu_reset(chip8_cpu *cpu)
 static chip8_error chip8_cpu_execute(chip8_cpu *cpu)
 {
 	chip8_error flag = CHIP8_EOK;
-	uint16_t opcode = 0; 
 
 	if (cpu == NULL)
 		return CHIP8_EINVAL;
 
 	/* User is holding down a key... */	
 	bool lock = false;
+	unsigned long ran = 0;
 	flag = chip8_keypad_islock(cpu->keypad, &lock);
-	if (lock == true)
+	if (lock == true) {
+		if (cpu->prof != NULL)
+			cpu->prof->blocked++;
 		return flag;
+	}
 
-	/* Fetch opcode... */
-	opcode = cpu->memory[cpu->pc] << 8 | cpu->memory[cpu->pc + 1];
-	cpu->opcode = opcode;
-	cpu->pc += 2;
+	if (cpu->prof != NULL)
+		return chip8_prof_exec(cpu->prof, cpu, 1, &ran);
+	if (cpu->trace != NULL)
+		return chip8_trace_exec(cpu->trace, cpu, 1, &ran);
+	return chip8_cpu_dispatch(cpu);
+}
 
-	/* Decode and execute... */
-	switch (opcode & 0xF000) {
-	case 0x0000:
-		switch(opcode & 0x00FF) {
-		case 0x00E0:
-			chip8_opcode_00E0(cpu);
-			break;
-		case 0x00EE:
-			chip8_opcode_00EE(cpu);
-			break;
-		/* Bad opcode... */
-		default:
-			flag = CHIP8_EBADOP;
-			break;
-		}
-		break;
-	case 0x1000:
-		chip8_opcode_1NNN(cpu);
-		break;
-	case 0x2000:
-		chip8_opcode_2NNN(cpu);
-		break;
-	case 0x3000:
-		chip8_opcode_3XNN(cpu);
-		break;
-	case 0x4000:
-		chip8_opcode_4XNN(cpu);
-		break;
-	case 0x5000:
-		chip8_opcode_5XY0(cpu);
-		break;
-	case 0x6000:
-		chip8_opcode_6XNN(cpu);
-		break;
-	case 0x7000:
-		chip8_opcode_7XNN(cpu);
-		break;
-	case 0x8000:
-		switch (opcode & 0x000F)
-		{
-		case 0x0000:
-			chip8_opcode_8XY0(cpu);
-			break;
-		case 0x0001:
-			chip8_opcode_8XY1(cpu);
-			break;
-		case 0x0002:
-			chip8_opcode_8XY2(cpu);
-			break;
-		case 0x0003:
-			chip8_opcode_8XY3(cpu);
-			break;
-		case 0x0004:
-			chip8_opcode_8XY4(cpu);
-			break;
-		case 0x0005:
-			chip8_opcode_8XY5(cpu);
-			break;
-		case 0x0006:
-			chip8_opcode_8XY6(cpu);
-			break;
-		case 0x0007:
-			chip8_opcode_8XY7(cpu);
-			break;
-		case 0x000E:
-			chip8_opcode_8XYE(cpu);
-			break;
-		/* Bad opcode... */
-		default:
-			flag = CHIP8_EBADOP;
-			break;
-		}
-		break;
-	case 0x9000:
-		chip8_opcode_9XY0(cpu);
-		break;
-	case 0xA000:
-		chip8_opcode_ANNN(cpu);
-		break;
-	case 0xB000:
-		chip8_opcode_BNNN(cpu);
-		break;
-	case 0xC000:
-		chip8_opcode_CXNN(cpu);
-		break;
-	case 0xD000:
-		chip8_opcode_DXYN(cpu);
-		break;
-	case 0xE000:
-		switch (opcode & 0x00FF) {
-		case 0x009E:
-			chip8_opcode_EX9E(cpu);
-			break;
-		case 0x00A1:
-			chip8_opcode_EXA1(cpu);
-			break;
-		/* Bad opcode... */
-		default:
-			flag = CHIP8_EBADOP;
+chip8_error chip8_cpu_step(chip8_cpu *cpu)
+{
+	return chip8_cpu_execute(cpu);
+}
+
+chip8_error chip8_cpu_exec(chip8_cpu *cpu, unsigned long count,
+		           unsigned long *ran)
+{
+	chip8_error flag = CHIP8_EOK;
+	unsigned long done = 0;
+	unsigned long n = 0;
+	bool lock = false;
+
+	if (cpu == NULL)
+		return CHIP8_EINVAL;
+
+	while (done < count && flag == CHIP8_EOK) {
+		/* Nothing can unlock keypad until new input is processed... */
+		flag = chip8_keypad_islock(cpu->keypad, &lock);
+		if (lock) {
+			if (cpu->prof != NULL)
+				cpu->prof->blocked += count - done;
+			done = count;
 			break;
 		}
+
+		n = 0;
+		if (cpu->prof != NULL)
+			flag = chip8_prof_exec(cpu->prof, cpu, count - done, &n);
+		else if (cpu->trace != NULL)
+			flag = chip8_trace_exec(cpu->trace, cpu, count - done,
+						&n);
+		else if (cpu->jit != NULL)
+			flag = chip8_jit_exec(cpu->jit, cpu, count - done, &n);
+
+		/* Interpret batch, or single instruction JIT could not run... */
+		if (flag == CHIP8_EOK && n == 0)
+			flag = chip8_interp_exec(cpu, (cpu->jit != NULL) ?
+						 1 : count - done, &n);
+		done += n;
+	}
+
+	if (ran != NULL)
+		*ran = done;
+	return flag;
+}
+
+chip8_error chip8_cpu_setengine(chip8_cpu *cpu, chip8_engine engine)
+{
+	chip8_error flag = CHIP8_EOK;
+
+	if (cpu == NULL)
+		return CHIP8_EINVAL;
+
+	switch (engine) {
+	case CHIP8_ENGINE_INTERP:
+		chip8_jit_free(cpu->jit);
+		cpu->jit = NULL;
 		break;
-	case 0xF000:
-		switch (opcode & 0x00FF) {
-		case 0x0007:
-			chip8_opcode_FX07(cpu);
-			break;
-		case 0x000A:
-			chip8_opcode_FX0A(cpu);
-			break;
-		case 0x0015:
-			chip8_opcode_FX15(cpu);
-			break;
-		case 0x0018:
-			chip8_opcode_FX18(cpu);
-			break;
-		case 0x001E:
-			chip8_opcode_FX1E(cpu);
-			break;
-		case 0x0029:
-			chip8_opcode_FX29(cpu);
-			break;
-		case 0x0033:
-			chip8_opcode_FX33(cpu);
-			break;
-		case 0x0055:
-			chip8_opcode_FX55(cpu);
-			break;
-		case 0x0065:
-			chip8_opcode_FX65(cpu);
-			break;
-		/* Bad opcode... */
-		default:
-			flag = CHIP8_EBADOP;
-			break;
-		}
+	case CHIP8_ENGINE_JIT:
+		if (cpu->jit == NULL)
+			flag = chip8_jit_init(&cpu->jit);
 		break;
-	/* Bad opcode... */
 	default:
-		flag = CHIP8_EBADOP;
+		flag = CHIP8_EINVAL;
 		break;
 	}
 	return flag;
 }
 
+chip8_error chip8_cpu_setprof(chip8_cpu *cpu, struct chip8_prof *prof)
+{
+	if (cpu == NULL)
+		return CHIP8_EINVAL;
+
+	cpu->prof = prof;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_cpu_settrace(chip8_cpu *cpu, struct chip8_trace *trace)
+{
+	if (cpu == NULL)
+		return CHIP8_EINVAL;
+
+	cpu->trace = trace;
+	return CHIP8_EOK;
+}
+
+
+/**
+ * @brief Get virtual clock cycle of next timer tick.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @pre cpu must not be NULL.
+ *
+ * @param[in] cpu CHIP-8 CPU context to get next tick of.
+ * @return First cycle at which the next 60Hz timer tick is due.
+ */
+static uint64_t chip8_cpu_nexttick(const chip8_cpu *cpu)
+{
+	/* Round up, so ticks never happen early for any opnum... */
+	return ((cpu->timer_count + 1) * cpu->opnum + CHIP8_TIMER_HZ - 1) /
+	       CHIP8_TIMER_HZ;
+}
+
+/**
+ * @brief Tick timers for every timer boundary the virtual clock passed.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @pre cpu must not be NULL.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to tick timers of.
+ */
+static void chip8_cpu_tick(chip8_cpu *cpu)
+{
+	while (cpu->cycles >= chip8_cpu_nexttick(cpu)) {
+		cpu->timer_count++;
+		if (cpu->dt != 0)
+			cpu->dt -= 1;
+		if (cpu->st != 0)
+			cpu->st -= 1;
+	}
+}
+
+chip8_error chip8_cpu_run(chip8_cpu *cpu, unsigned long max_cycles,
+		          unsigned long *ran)
+{
+	chip8_error flag = CHIP8_EOK;
+	unsigned long done = 0;
+	uint64_t budget = 0;
+
+	if (cpu == NULL)
+		return CHIP8_EINVAL;
+
+	chip8_cpu_tick(cpu);
+	budget = chip8_cpu_nexttick(cpu) - cpu->cycles;
+	if (budget > max_cycles)
+		budget = max_cycles;
+
+	flag = chip8_cpu_exec(cpu, budget, &done);
+	cpu->cycles += done;
+	chip8_cpu_tick(cpu);
+
+	if (ran != NULL)
+		*ran = done;
+	return flag;
+}
+
+chip8_error chip8_cpu_frame(chip8_cpu *cpu)
+{
+	chip8_error flag = CHIP8_EOK;
+	uint64_t tick = 0;
+
+	if (cpu == NULL)
+		return CHIP8_EINVAL;
+
+	tick = cpu->timer_count;
+	while (cpu->timer_count == tick && flag == CHIP8_EOK)
+		flag = chip8_cpu_run(cpu, cpu->opnum, NULL);
+	return flag;
+}
 
 chip8_error chip8_cpu_cycle(chip8_cpu *cpu)
 {
 	chip8_error flag = CHIP8_EOK;
+	unsigned long due = 0;
+	unsigned long ran = 0;
 	float delta = 0.0f;
 
 	if (cpu == NULL)
@@ -354,34 +489,20 @@ chip8_error chip8_cpu_cycle(chip8_cpu *cpu)
 	if (flag != CHIP8_EOK)
 		return flag;
 
-	cpu->timer_ticks += delta;
-	while (cpu->timer_ticks > CHIP8_TIMER_FREQ) {
-		cpu->timer_ticks -= CHIP8_TIMER_FREQ;
-		if (cpu->dt != 0) {
-			cpu->dt -= 1;
-		}
-		if (cpu->st != 0) {
-			cpu->st -= 1;
-		}
-	}
-
-	if (cpu->st != 0) {
-		chip8_audio_play();
-	} else {
-		chip8_audio_pause();
-	}
-
-
+	/* Run every cycle wall-clock time says is due... */
 	cpu->cycle_ticks += delta;
-	while (cpu->cycle_ticks > cpu->cycle_freq) { 
-		cpu->cycle_ticks -= cpu->cycle_freq;
-		flag = chip8_cpu_execute(cpu);
+	due = cpu->cycle_ticks / cpu->cycle_freq;
+	cpu->cycle_ticks -= due * cpu->cycle_freq;
+	while (due != 0 && flag == CHIP8_EOK) {
+		flag = chip8_cpu_run(cpu, due, &ran);
+		due -= ran;
 	}
 	return flag;
 }
 
 void chip8_cpu_free(chip8_cpu *cpu)
 {
-	SDL_QuitSubSystem(SDL_INIT_TIMER);
+	if (cpu != NULL)
+		chip8_jit_free(cpu->jit);
 	free(cpu);
 }
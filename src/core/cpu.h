@@ -9,7 +9,6 @@
 
 #include "core/video.h"
 #include "core/keypad.h"
-#include "core/audio.h"
 #include "utils/error.h"
 
 #define CHIP8_RAM_SIZE   0x1000 /**< Size of CHIP-8 RAM. */
@@ -17,11 +16,52 @@
 #define CHIP8_ROM_INIT   0x200  /**< Start of code segement in CHIP-8. */
 #define CHIP8_ROM_LIMIT  0xFFF  /**< End of code segement in CHIP-8. */
 #define CHIP8_VREGS      16     /**< Amount of registers in CHIP-8. */
+#define CHIP8_TIMER_HZ   60     /**< Timer frequency. */
+#define CHIP8_RPL_SIZE   16     /**< Amount of SUPER-CHIP RPL flags. */
+#define CHIP8_FONT_LARGE 0x50   /**< Start of SUPER-CHIP 8x10 font. */
+
+#define CHIP8_ICACHE_SIZE CHIP8_RAM_SIZE /**< Predecode cache slots. */
+
+/** Wall-clock nanoseconds of a 60Hz timer tick. */
+#define CHIP8_FRAME_NS (1000000000u / CHIP8_TIMER_HZ)
+
+typedef struct chip8_cpu chip8_cpu;
+typedef struct chip8_instr chip8_instr;
+
+/**
+ * @brief Execution engines a CHIP-8 CPU can run with.
+ */
+typedef enum {
+	CHIP8_ENGINE_INTERP = 0, /**< Predecoded interpreter. */
+	CHIP8_ENGINE_JIT         /**< x86-64 basic block JIT. */
+} chip8_engine;
+
+/**
+ * @brief Signature shared by every opcode handler.
+ */
+typedef chip8_error (*chip8_opcode_handler)(chip8_cpu *cpu,
+		                            const chip8_instr *ins);
+
+/**
+ * @brief Predecoded CHIP-8 instruction.
+ *
+ * @note A NULL #handler marks a cache slot that must be decoded again.
+ */
+struct chip8_instr {
+	chip8_opcode_handler handler; /**< Handler of instruction. */
+	uint16_t opcode;              /**< Raw 16-bit opcode. */
+	uint16_t nnn;                 /**< 12-bit immediate address. */
+	uint8_t id;                   /**< Instruction identifier. */
+	uint8_t x;                    /**< X register operand. */
+	uint8_t y;                    /**< Y register operand. */
+	uint8_t n;                    /**< 4-bit immediate nibble. */
+	uint8_t nn;                   /**< 8-bit immediate byte. */
+};
 
 /**
  * @brief Representation of CHIP-8 cpu.
  */
-typedef struct {
+struct chip8_cpu {
 	uint8_t memory[CHIP8_RAM_SIZE];   /**< 4KiB memory space. */
 	uint8_t v[CHIP8_VREGS];           /**< 16 8-bit data registers. */
 	uint8_t dt;                       /**< 8-bit delay timer. */
@@ -33,12 +73,25 @@ typedef struct {
 	uint16_t opcode;                  /**< 16-bit current opcode. */
 	chip8_video *video;               /**< Video context. */
 	chip8_keypad *keypad;             /**< Keypad context. */
-	chip8_audio *audio;               /**< Audio context. */
-	uint64_t ticks;                   /**< Current total tick rate. */
-	float timer_ticks;                /**< Current timer tick rate. */
+	uint64_t ticks;                   /**< Last wall-clock time in ns. */
 	float cycle_ticks;                /**< Current opcode cycle ticks. */
 	float cycle_freq;                 /**< Max opcode cycle frequency. */
-} chip8_cpu;
+	unsigned int opnum;               /**< Instructions per second. */
+	uint64_t cycles;                  /**< Virtual clock in instructions. */
+	uint64_t timer_count;             /**< 60Hz timer ticks elapsed. */
+	struct chip8_jit *jit;            /**< JIT context, NULL if unused. */
+	struct chip8_prof *prof;          /**< Profiler, NULL if unused. */
+	struct chip8_trace *trace;        /**< Trace, NULL if unused. */
+	uint32_t writes;                  /**< RAM writes invalidated so far. */
+	uint64_t rng;                     /**< PRNG state used by CXNN. */
+	uint8_t rpl[CHIP8_RPL_SIZE];      /**< RPL flags of FX75 and FX85. */
+
+	/**
+	 * Predecoded instruction starting at every address in RAM. Odd
+	 * addresses are included as some ROMs run code from them.
+	 */
+	chip8_instr icache[CHIP8_ICACHE_SIZE];
+};
 
 /**
  * @brief Create a new CHIP-8 CPU context.
@@ -57,7 +110,7 @@ typedef struct {
  * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
 chip8_error chip8_cpu_init(chip8_cpu **cpu, chip8_video *video,
-		           chip8_keypad *keypad, chip8_audio *audio, unsigned int opnum);
+		           chip8_keypad *keypad, unsigned int opnum);
 
 /**
  * @brief Load rom data into CHIP-8 CPU context.
@@ -74,7 +127,8 @@ chip8_error chip8_cpu_romload(chip8_cpu *cpu, const char *rom);
 /**
  * @brief Reset CHIP-8 CPU.
  *
- * @note Does not reset RAM.
+ * @note Does not reset RAM, RPL flags, or the random number generator. Video
+ *       is switched back to low resolution, which clears it.
  *
  * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
  * @post #cpu state will be reset.
@@ -84,10 +138,171 @@ chip8_error chip8_cpu_romload(chip8_cpu *cpu, const char *rom);
  */
 chip8_error chip8_cpu_reset(chip8_cpu *cpu);
 
+/**
+ * @brief Seed random number generator of CHIP-8 CPU.
+ *
+ * @note Every CPU owns a PCG32 generator used by CXNN, so CPUs never share
+ *       state through the C library rand(). Two CPUs seeded alike and fed the
+ *       same input run bit-for-bit the same. New CPUs are seeded with 0.
+ *
+ * @pre cpu must not be NULL.
+ * @post CXNN will draw from a sequence given by seed.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to seed.
+ * @param[in] seed Seed of random number sequence.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_seed(chip8_cpu *cpu, uint64_t seed);
+
+/**
+ * @brief Draw next random byte of CHIP-8 CPU.
+ *
+ * @pre cpu must not be NULL.
+ * @post Random number generator of cpu will be advanced.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to draw from.
+ * @return Random byte.
+ */
+uint8_t chip8_cpu_rand(chip8_cpu *cpu);
+
+/**
+ * @brief Invalidate predecoded instructions covering a range of RAM.
+ *
+ * @note Must be called whenever RAM is written outside of ROM loading, so
+ *       self-modifying ROMs keep executing the right instructions.
+ *
+ * @pre cpu must not be NULL.
+ * @post Cache slots overlapping addr to addr + len will be decoded again.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to invalidate cache of.
+ * @param[in] addr First RAM address written.
+ * @param[in] len Number of bytes written.
+ */
+void chip8_cpu_invalidate(chip8_cpu *cpu, uint16_t addr, uint16_t len);
+
+/**
+ * @brief Execute exactly one CHIP-8 instruction.
+ *
+ * @note Ignores instruction timing, see #chip8_cpu_cycle() for timed
+ *       execution.
+ *
+ * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
+ * @post #cpu state will be updated by whatever instruction was executed.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to execute instruction from.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_step(chip8_cpu *cpu);
+
+/**
+ * @brief Execute a fixed amount of CHIP-8 instructions.
+ *
+ * @note Ignores instruction timing like #chip8_cpu_step(). If the keypad is
+ *       locked by FX0A the remaining instructions are spent waiting, since
+ *       nothing can unlock it before new input is processed.
+ *
+ * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
+ * @post #cpu state will be updated by every instruction executed.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to execute instructions from.
+ * @param[in] count Amount of instructions to execute.
+ * @param[out] ran Amount of instructions executed, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_exec(chip8_cpu *cpu, unsigned long count,
+		           unsigned long *ran);
+
+/**
+ * @brief Select execution engine of CHIP-8 CPU.
+ *
+ * @note #CHIP8_ENGINE_JIT is only available on x86-64 hosts, anything it
+ *       cannot translate still runs on the interpreter.
+ *
+ * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
+ * @post #cpu will execute instructions with #engine.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to select engine of.
+ * @param[in] engine Execution engine to use.
+ * @return 0 (#CHIP8_EOK) for success, #CHIP8_ENOSYS if #engine is not
+ *         supported on this host, or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_setengine(chip8_cpu *cpu, chip8_engine engine);
+
+/**
+ * @brief Attach profiler to CHIP-8 CPU.
+ *
+ * @note While a profiler is attached, every instruction is counted by
+ *       #chip8_prof_exec() instead of running on the selected engine, and
+ *       cycles spent waiting on FX0A are counted as blocked. Pass NULL to
+ *       detach it and run at full speed again.
+ *
+ * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
+ * @post #cpu will count into #prof until another profiler is attached.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to profile.
+ * @param[in] prof Profiler to count into, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_setprof(chip8_cpu *cpu, struct chip8_prof *prof);
+
+/**
+ * @brief Attach binary instruction trace to CHIP-8 CPU.
+ *
+ * @note While a trace is attached, every instruction is recorded by
+ *       #chip8_trace_exec() instead of running on the selected engine. An
+ *       attached profiler keeps running, and records into the trace too. Pass
+ *       NULL to detach it and run at full speed again.
+ *
+ * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
+ * @post #cpu will record into #trace until another trace is attached.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to trace.
+ * @param[in] trace Trace to record into, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_settrace(chip8_cpu *cpu, struct chip8_trace *trace);
+
+/**
+ * @brief Run CHIP-8 CPU against its virtual clock.
+ *
+ * @note Every instruction advances the virtual clock by one cycle, and the
+ *       delay and sound timers tick once every opnum / 60 cycles. Execution
+ *       stops after max_cycles, or right after the next timer tick, so
+ *       callers can react to timer changes. Wall-clock time is never looked
+ *       at, so runs are deterministic and as fast as the host allows.
+ *
+ * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
+ * @post #cpu state and virtual clock will be advanced by every cycle run.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to run.
+ * @param[in] max_cycles Maximum amount of cycles to run.
+ * @param[out] ran Amount of cycles run, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_run(chip8_cpu *cpu, unsigned long max_cycles,
+		          unsigned long *ran);
+
+/**
+ * @brief Run CHIP-8 CPU up to the next 60Hz tick of its virtual clock.
+ *
+ * @note Runs #chip8_cpu_run() until the timers tick, so batch runs can
+ *       present one frame per call without ever looking at wall-clock time.
+ *
+ * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
+ * @post #cpu state and virtual clock will be advanced by one frame.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to run.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_cpu_frame(chip8_cpu *cpu);
 
 /**
  * @brief Execute a CHIP-8 CPU cycle.
  *
+ * @note Paces #chip8_cpu_run() to wall-clock time, running as many cycles as
+ *       the time passed since the last call allows. Sound is left to the
+ *       frontend, which should play while #chip8_cpu->st is non-zero.
+ *
  * @pre #cpu must be initialized with #chip8_cpu_init() beforehand.
  * @post #cpu state will be updated by whatever instruction was executed.
  *
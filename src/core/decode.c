@@ -0,0 +1,171 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "core/decode.h"
+#include "core/opcode.h"
+
+uint8_t chip8_decode_table[CHIP8_DECODE_SIZE];
+
+const chip8_opcode_handler chip8_decode_handlers[CHIP8_OP_COUNT] = {
+	[CHIP8_OP_BAD]  = chip8_opcode_bad,
+	[CHIP8_OP_00CN] = chip8_opcode_00CN,
+	[CHIP8_OP_00E0] = chip8_opcode_00E0,
+	[CHIP8_OP_00EE] = chip8_opcode_00EE,
+	[CHIP8_OP_00FB] = chip8_opcode_00FB,
+	[CHIP8_OP_00FC] = chip8_opcode_00FC,
+	[CHIP8_OP_00FE] = chip8_opcode_00FE,
+	[CHIP8_OP_00FF] = chip8_opcode_00FF,
+	[CHIP8_OP_1NNN] = chip8_opcode_1NNN,
+	[CHIP8_OP_2NNN] = chip8_opcode_2NNN,
+	[CHIP8_OP_3XNN] = chip8_opcode_3XNN,
+	[CHIP8_OP_4XNN] = chip8_opcode_4XNN,
+	[CHIP8_OP_5XY0] = chip8_opcode_5XY0,
+	[CHIP8_OP_6XNN] = chip8_opcode_6XNN,
+	[CHIP8_OP_7XNN] = chip8_opcode_7XNN,
+	[CHIP8_OP_8XY0] = chip8_opcode_8XY0,
+	[CHIP8_OP_8XY1] = chip8_opcode_8XY1,
+	[CHIP8_OP_8XY2] = chip8_opcode_8XY2,
+	[CHIP8_OP_8XY3] = chip8_opcode_8XY3,
+	[CHIP8_OP_8XY4] = chip8_opcode_8XY4,
+	[CHIP8_OP_8XY5] = chip8_opcode_8XY5,
+	[CHIP8_OP_8XY6] = chip8_opcode_8XY6,
+	[CHIP8_OP_8XY7] = chip8_opcode_8XY7,
+	[CHIP8_OP_8XYE] = chip8_opcode_8XYE,
+	[CHIP8_OP_9XY0] = chip8_opcode_9XY0,
+	[CHIP8_OP_ANNN] = chip8_opcode_ANNN,
+	[CHIP8_OP_BNNN] = chip8_opcode_BNNN,
+	[CHIP8_OP_CXNN] = chip8_opcode_CXNN,
+	[CHIP8_OP_DXYN] = chip8_opcode_DXYN,
+	[CHIP8_OP_EX9E] = chip8_opcode_EX9E,
+	[CHIP8_OP_EXA1] = chip8_opcode_EXA1,
+	[CHIP8_OP_FX07] = chip8_opcode_FX07,
+	[CHIP8_OP_FX0A] = chip8_opcode_FX0A,
+	[CHIP8_OP_FX15] = chip8_opcode_FX15,
+	[CHIP8_OP_FX18] = chip8_opcode_FX18,
+	[CHIP8_OP_FX1E] = chip8_opcode_FX1E,
+	[CHIP8_OP_FX29] = chip8_opcode_FX29,
+	[CHIP8_OP_FX30] = chip8_opcode_FX30,
+	[CHIP8_OP_FX33] = chip8_opcode_FX33,
+	[CHIP8_OP_FX55] = chip8_opcode_FX55,
+	[CHIP8_OP_FX65] = chip8_opcode_FX65,
+	[CHIP8_OP_FX75] = chip8_opcode_FX75,
+	[CHIP8_OP_FX85] = chip8_opcode_FX85
+};
+
+/**
+ * @brief Set decode table entries for a low byte of an opcode category.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in] category Opcode category nibble (0x0 to 0xF).
+ * @param[in] low Low byte of opcode.
+ * @param[in] id Instruction identifier to store.
+ */
+static void chip8_decode_set(uint8_t category, uint8_t low, chip8_opcode_id id)
+{
+	chip8_decode_table[(category << 8) | low] = id;
+}
+
+/**
+ * @brief Set every decode table entry of an opcode category.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in] category Opcode category nibble (0x0 to 0xF).
+ * @param[in] id Instruction identifier to store.
+ */
+static void chip8_decode_setall(uint8_t category, chip8_opcode_id id)
+{
+	for (unsigned int low = 0; low <= 0xFF; low++)
+		chip8_decode_set(category, low, id);
+}
+
+/**
+ * @brief Fill in decode table.
+ *
+ * @note INTERNAL USE ONLY! Runs exactly once, see #chip8_decode_init().
+ */
+static void chip8_decode_build(void)
+{
+	/* Anything not listed below is left as CHIP8_OP_BAD... */
+	for (unsigned int n = 0; n <= 0xF; n++)
+		chip8_decode_set(0x0, 0xC0 | n, CHIP8_OP_00CN);
+	chip8_decode_set(0x0, 0xE0, CHIP8_OP_00E0);
+	chip8_decode_set(0x0, 0xEE, CHIP8_OP_00EE);
+	chip8_decode_set(0x0, 0xFB, CHIP8_OP_00FB);
+	chip8_decode_set(0x0, 0xFC, CHIP8_OP_00FC);
+	chip8_decode_set(0x0, 0xFE, CHIP8_OP_00FE);
+	chip8_decode_set(0x0, 0xFF, CHIP8_OP_00FF);
+	chip8_decode_setall(0x1, CHIP8_OP_1NNN);
+	chip8_decode_setall(0x2, CHIP8_OP_2NNN);
+	chip8_decode_setall(0x3, CHIP8_OP_3XNN);
+	chip8_decode_setall(0x4, CHIP8_OP_4XNN);
+
+	/* 5XY0 and 9XY0 need a low nibble of 0, Y is don't care... */
+	for (unsigned int y = 0; y <= 0xF; y++)
+		chip8_decode_set(0x5, y << 4, CHIP8_OP_5XY0);
+
+	chip8_decode_setall(0x6, CHIP8_OP_6XNN);
+	chip8_decode_setall(0x7, CHIP8_OP_7XNN);
+
+	/* 8XYN only cares about the low nibble, Y is don't care... */
+	for (unsigned int y = 0; y <= 0xF; y++) {
+		chip8_decode_set(0x8, (y << 4) | 0x0, CHIP8_OP_8XY0);
+		chip8_decode_set(0x8, (y << 4) | 0x1, CHIP8_OP_8XY1);
+		chip8_decode_set(0x8, (y << 4) | 0x2, CHIP8_OP_8XY2);
+		chip8_decode_set(0x8, (y << 4) | 0x3, CHIP8_OP_8XY3);
+		chip8_decode_set(0x8, (y << 4) | 0x4, CHIP8_OP_8XY4);
+		chip8_decode_set(0x8, (y << 4) | 0x5, CHIP8_OP_8XY5);
+		chip8_decode_set(0x8, (y << 4) | 0x6, CHIP8_OP_8XY6);
+		chip8_decode_set(0x8, (y << 4) | 0x7, CHIP8_OP_8XY7);
+		chip8_decode_set(0x8, (y << 4) | 0xE, CHIP8_OP_8XYE);
+	}
+
+	for (unsigned int y = 0; y <= 0xF; y++)
+		chip8_decode_set(0x9, y << 4, CHIP8_OP_9XY0);
+	chip8_decode_setall(0xA, CHIP8_OP_ANNN);
+	chip8_decode_setall(0xB, CHIP8_OP_BNNN);
+	chip8_decode_setall(0xC, CHIP8_OP_CXNN);
+	chip8_decode_setall(0xD, CHIP8_OP_DXYN);
+	chip8_decode_set(0xE, 0x9E, CHIP8_OP_EX9E);
+	chip8_decode_set(0xE, 0xA1, CHIP8_OP_EXA1);
+	chip8_decode_set(0xF, 0x07, CHIP8_OP_FX07);
+	chip8_decode_set(0xF, 0x0A, CHIP8_OP_FX0A);
+	chip8_decode_set(0xF, 0x15, CHIP8_OP_FX15);
+	chip8_decode_set(0xF, 0x18, CHIP8_OP_FX18);
+	chip8_decode_set(0xF, 0x1E, CHIP8_OP_FX1E);
+	chip8_decode_set(0xF, 0x29, CHIP8_OP_FX29);
+	chip8_decode_set(0xF, 0x30, CHIP8_OP_FX30);
+	chip8_decode_set(0xF, 0x33, CHIP8_OP_FX33);
+	chip8_decode_set(0xF, 0x55, CHIP8_OP_FX55);
+	chip8_decode_set(0xF, 0x65, CHIP8_OP_FX65);
+	chip8_decode_set(0xF, 0x75, CHIP8_OP_FX75);
+	chip8_decode_set(0xF, 0x85, CHIP8_OP_FX85);
+}
+
+void chip8_decode_init(void)
+{
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+	/* Every caller returns only once the table is fully built, so threads
+	 * creating CPUs at the same time never see a half-built table... */
+	pthread_once(&once, chip8_decode_build);
+}
+
+void chip8_decode_instr(uint16_t opcode, chip8_instr *ins)
+{
+	chip8_opcode_id id = chip8_decode(opcode);
+
+	ins->handler = chip8_decode_handler(id);
+	ins->opcode = opcode;
+	ins->nnn = opcode & 0x0FFF;
+	ins->id = id;
+	ins->x = (opcode & 0x0F00) >> 8;
+	ins->y = (opcode & 0x00F0) >> 4;
+	ins->n = opcode & 0x000F;
+	ins->nn = opcode & 0x00FF;
+}
@@ -0,0 +1,116 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_DECODE_H
+#define CHIP8_CORE_DECODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/opcode.h"
+
+/**
+ * @brief Amount of entries in the opcode decode table.
+ *
+ * @note The table is indexed by the category nibble of an opcode followed by
+ *       its low byte, which is every bit the instruction set uses to tell
+ *       instructions apart.
+ */
+#define CHIP8_DECODE_SIZE 0x1000
+
+/**
+ * @brief Decode table mapping opcodes to instruction identifiers.
+ *
+ * @note INTERNAL USE ONLY! Use #chip8_decode() instead.
+ */
+extern uint8_t chip8_decode_table[CHIP8_DECODE_SIZE];
+
+/**
+ * @brief Handler table mapping instruction identifiers to opcode handlers.
+ *
+ * @note INTERNAL USE ONLY! Use #chip8_decode_handler() instead.
+ */
+extern const chip8_opcode_handler chip8_decode_handlers[CHIP8_OP_COUNT];
+
+/**
+ * @brief Build the opcode decode table.
+ *
+ * @note Safe to call more than once, and from several threads at once. The
+ *       table is only built the first time, and every call returns once it
+ *       is built.
+ * @post #chip8_decode() can be used to decode opcodes.
+ */
+void chip8_decode_init(void);
+
+/**
+ * @brief Decode an opcode into its instruction identifier.
+ *
+ * @pre #chip8_decode_init() must be called beforehand.
+ *
+ * @param[in] opcode Opcode to decode.
+ * @return Instruction identifier, #CHIP8_OP_BAD for invalid opcodes.
+ */
+static inline chip8_opcode_id chip8_decode(uint16_t opcode)
+{
+	return chip8_decode_table[((opcode & 0xF000) >> 4) | (opcode & 0x00FF)];
+}
+
+/**
+ * @brief Get opcode handler of an instruction identifier.
+ *
+ * @pre id must be less than #CHIP8_OP_COUNT.
+ *
+ * @param[in] id Instruction identifier to get handler of.
+ * @return Opcode handler of instruction.
+ */
+static inline chip8_opcode_handler chip8_decode_handler(chip8_opcode_id id)
+{
+	return chip8_decode_handlers[id];
+}
+
+/**
+ * @brief Predecode an opcode into its handler and operands.
+ *
+ * @pre #chip8_decode_init() must be called beforehand.
+ * @pre ins must not be NULL.
+ * @post ins will hold the handler and every operand field of opcode.
+ *
+ * @param[in] opcode Opcode to predecode.
+ * @param[out] ins Predecoded instruction to fill.
+ */
+void chip8_decode_instr(uint16_t opcode, chip8_instr *ins);
+
+/**
+ * @brief Fetch predecoded instruction at program counter.
+ *
+ * @note Decodes into the predecode cache on a miss. Addresses wrapping around
+ *       RAM are never cached, and are decoded into slow instead.
+ *
+ * @pre #chip8_decode_init() must be called beforehand.
+ * @pre cpu and slow must not be NULL.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to fetch from.
+ * @param[out] slow Scratch instruction for addresses wrapping around RAM.
+ * @return Predecoded instruction at program counter.
+ */
+static inline const chip8_instr *chip8_decode_fetch(chip8_cpu *cpu,
+		                                    chip8_instr *slow)
+{
+	chip8_instr *ins = NULL;
+	uint16_t pc = cpu->pc;
+
+	if (pc >= CHIP8_RAM_SIZE - 1) {
+		chip8_decode_instr(cpu->memory[pc & 0xFFF] << 8 |
+				   cpu->memory[(pc + 1) & 0xFFF], slow);
+		return slow;
+	}
+
+	ins = &cpu->icache[pc];
+	if (ins->handler == NULL)
+		chip8_decode_instr(cpu->memory[pc] << 8 | cpu->memory[pc + 1],
+				   ins);
+	return ins;
+}
+
+#endif /* CHIP8_CORE_DECODE_H */
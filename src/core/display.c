@@ -0,0 +1,231 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/display.h"
+#include "core/video.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_DISPLAY_PIXELS \
+	(CHIP8_VIDEO_HIRES_WIDTH * CHIP8_VIDEO_HIRES_HEIGHT)
+
+/**
+ * @brief Drop frame.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_display_drop(chip8_display *display,
+		                      chip8_video *video)
+{
+	(void)display;
+	video->dirty = 0;
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Set up nothing.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_display_none(chip8_display *display)
+{
+	(void)display;
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Tear down nothing.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_display_nofree(chip8_display *display)
+{
+	(void)display;
+}
+
+/**
+ * @brief Open file frames are dumped to.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_display_open(chip8_display *display)
+{
+	const char *path = display->config.path;
+
+	if (path == NULL || strcmp(path, "-") == 0) {
+		display->data = stdout;
+		return CHIP8_EOK;
+	}
+
+	display->data = fopen(path, "wb");
+	if (display->data == NULL)
+		return CHIP8_ENOFILE;
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Close file frames are dumped to.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_display_close(chip8_display *display)
+{
+	FILE *file = display->data;
+
+	if (file == stdout)
+		fflush(file);
+	else if (file != NULL)
+		fclose(file);
+}
+
+/**
+ * @brief Write frame as netpbm image of given type, 4 (PBM), 5 (PGM), or 6
+ *        (PPM).
+ *
+ * @note INTERNAL USE ONLY! Images are as big as the current resolution.
+ */
+static chip8_error chip8_display_dump(chip8_display *display,
+		                      chip8_video *video, int type)
+{
+	const unsigned int width = chip8_video_width(video);
+	const unsigned int height = chip8_video_height(video);
+	uint8_t image[CHIP8_DISPLAY_PIXELS * 3];
+	uint32_t rgba[CHIP8_DISPLAY_PIXELS];
+	FILE *file = display->data;
+	size_t size = 0;
+
+	video->dirty = 0;
+	if (type == 4) {
+		/* Rows are packed the same way as PBM, set bits are black... */
+		for (unsigned int n = 0; n < height * chip8_video_pitch(video);
+		     n++) {
+			for (int b = 0; b < 8; b++)
+				image[size++] = ~video->rows[n] >> (56 - 8 * b);
+		}
+	} else if (type == 5) {
+		for (unsigned int y = 0; y < height; y++) {
+			for (unsigned int x = 0; x < width; x++)
+				image[size++] = chip8_video_get(video, x, y) ?
+						0xFF : 0x00;
+		}
+	} else {
+		chip8_video_rgba(video, rgba);
+		for (unsigned int n = 0; n < width * height; n++) {
+			image[size++] = rgba[n] >> 24;
+			image[size++] = rgba[n] >> 16;
+			image[size++] = rgba[n] >> 8;
+		}
+	}
+
+	if (fprintf(file, (type == 4) ? "P%d\n%u %u\n" : "P%d\n%u %u\n255\n",
+		    type, width, height) < 0 ||
+	    fwrite(image, 1, size, file) != size)
+		return CHIP8_EIO;
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Write frame as PPM image.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_display_writeppm(chip8_display *display,
+		                          chip8_video *video)
+{
+	return chip8_display_dump(display, video, 6);
+}
+
+/**
+ * @brief Write frame as PGM image.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_display_writepgm(chip8_display *display,
+		                          chip8_video *video)
+{
+	return chip8_display_dump(display, video, 5);
+}
+
+/**
+ * @brief Write frame as PBM bitmap.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_display_writepbm(chip8_display *display,
+		                          chip8_video *video)
+{
+	return chip8_display_dump(display, video, 4);
+}
+
+const chip8_display_backend chip8_display_null = {
+	"null", chip8_display_none, chip8_display_drop, chip8_display_nofree
+};
+
+const chip8_display_backend chip8_display_ppm = {
+	"ppm", chip8_display_open, chip8_display_writeppm, chip8_display_close
+};
+
+const chip8_display_backend chip8_display_pgm = {
+	"pgm", chip8_display_open, chip8_display_writepgm, chip8_display_close
+};
+
+const chip8_display_backend chip8_display_pbm = {
+	"pbm", chip8_display_open, chip8_display_writepbm, chip8_display_close
+};
+
+chip8_error chip8_display_init(chip8_display **display,
+		               const chip8_display_backend *backend,
+			       const chip8_display_config *config)
+{
+	chip8_display *newdisp = NULL;
+	chip8_error flag = CHIP8_EOK;
+
+	if (display == NULL || backend == NULL || config == NULL)
+		return CHIP8_EINVAL;
+
+	newdisp = calloc(1, sizeof *newdisp);
+	if (newdisp == NULL)
+		return CHIP8_ENOMEM;
+
+	newdisp->backend = backend;
+	newdisp->config = *config;
+	flag = backend->init(newdisp);
+	if (flag != CHIP8_EOK) {
+		chip8_display_free(newdisp);
+		return flag;
+	}
+
+	*display = newdisp;
+	chip8_debugx("setup new %s display %p\n", backend->name,
+		     (void *)(*display));
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_display_present(chip8_display *display, chip8_video *video)
+{
+	uint64_t hash = 0;
+
+	if (display == NULL || video == NULL)
+		return CHIP8_EINVAL;
+
+	chip8_video_hash(video, &hash);
+	if (display->frames != 0 && hash == display->hash)
+		display->repeats++;
+	display->hash = hash;
+	display->frames++;
+	return display->backend->present(display, video);
+}
+
+void chip8_display_free(chip8_display *display)
+{
+	chip8_debug("free display");
+	if (display != NULL)
+		display->backend->free(display);
+	free(display);
+}
@@ -0,0 +1,111 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_DISPLAY_H
+#define CHIP8_CORE_DISPLAY_H
+
+#include <stdint.h>
+
+#include "core/video.h"
+#include "utils/error.h"
+
+typedef struct chip8_display chip8_display;
+
+/**
+ * @brief Settings handed to a display backend when it is created.
+ *
+ * @note Backends ignore whatever settings mean nothing to them.
+ */
+typedef struct {
+	const char *path;   /**< File to write frames to, "-" for stdout. */
+	unsigned int scale; /**< Scale factor of window. */
+	unsigned int flags; /**< Flags of window, see frontend/window.h. */
+} chip8_display_config;
+
+/**
+ * @brief Display backend, presenting finished frames somewhere.
+ *
+ * @note Every backend implements all three operations. Presenting clears the
+ *       dirty rows of the frame, the same way a window does once it has
+ *       uploaded them.
+ */
+typedef struct {
+	const char *name; /**< Name selecting backend on the command line. */
+
+	/** Set up backend state in display->data from display->config. */
+	chip8_error (*init)(chip8_display *display);
+
+	/** Present finished frame. */
+	chip8_error (*present)(chip8_display *display, chip8_video *video);
+
+	/** Tear down backend state, which may be partially set up. */
+	void (*free)(chip8_display *display);
+} chip8_display_backend;
+
+/**
+ * @brief Display presenting frames through a backend.
+ */
+struct chip8_display {
+	const chip8_display_backend *backend; /**< Backend of display. */
+	chip8_display_config config;          /**< Settings of backend. */
+	void *data;                           /**< Backend state. */
+	uint64_t frames;                      /**< Frames presented so far. */
+	uint64_t hash;                        /**< Hash of last frame. */
+	uint64_t repeats;                     /**< Frames same as the last. */
+};
+
+/** Backend dropping every frame, for benchmarks and batch runs. */
+extern const chip8_display_backend chip8_display_null;
+
+/** Backend writing every frame as a binary PPM image, in palette colors. */
+extern const chip8_display_backend chip8_display_ppm;
+
+/** Backend writing every frame as a binary PGM image, lit pixels white. */
+extern const chip8_display_backend chip8_display_pgm;
+
+/** Backend writing every frame as a packed PBM bitmap, lit pixels white. */
+extern const chip8_display_backend chip8_display_pbm;
+
+/**
+ * @brief Create a new display.
+ *
+ * @note Frame dumping backends append one image per frame to the same file,
+ *       a stream most image tools and encoders read as a sequence. Every
+ *       image is as big as the resolution of its frame.
+ *
+ * @pre display, backend, and config cannot be NULL.
+ *
+ * @param[in,out] display Display to initialize.
+ * @param[in] backend Backend to present frames with.
+ * @param[in] config Settings of backend.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_display_init(chip8_display **display,
+		               const chip8_display_backend *backend,
+			       const chip8_display_config *config);
+
+/**
+ * @brief Present finished frame on display.
+ *
+ * @note Every frame is hashed with #chip8_video_hash() first, so callers can
+ *       log frames or spot repeated ones without comparing pixels.
+ *
+ * @pre display and video cannot be NULL.
+ * @post Dirty rows of video will be cleared, and display->hash will hold the
+ *       hash of video.
+ *
+ * @param[in,out] display Display to present frame on.
+ * @param[in,out] video Frame to present.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_display_present(chip8_display *display, chip8_video *video);
+
+/**
+ * @brief Free display, and backend state with it.
+ *
+ * @param[in,out] display Display to free, may be NULL.
+ */
+void chip8_display_free(chip8_display *display);
+
+#endif /* CHIP8_CORE_DISPLAY_H */
@@ -0,0 +1,138 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "core/cpu.h"
+#include "core/frame.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+/**
+ * @brief Frame scheduler pacing a main loop to a fixed refresh rate.
+ */
+struct chip8_frame {
+	uint64_t period;         /**< Nanoseconds between frames. */
+	uint64_t deadline;       /**< Monotonic time of next frame. */
+	uint64_t oversleep;      /**< Average nanoseconds woken up late. */
+	chip8_frame_stats stats; /**< Pacing statistics. */
+};
+
+/**
+ * @brief Sleep until monotonic time.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_frame_sleep(uint64_t until)
+{
+	struct timespec at;
+
+	at.tv_sec = until / 1000000000u;
+	at.tv_nsec = until % 1000000000u;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL) ==
+	       EINTR)
+		;
+}
+
+/**
+ * @brief Pick spin margin from how late the thread has been waking up.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static uint64_t chip8_frame_margin(const chip8_frame *frame)
+{
+	uint64_t margin = 2 * frame->oversleep;
+
+	if (margin < CHIP8_FRAME_SPIN_MIN)
+		margin = CHIP8_FRAME_SPIN_MIN;
+	if (margin > CHIP8_FRAME_SPIN_MAX)
+		margin = CHIP8_FRAME_SPIN_MAX;
+	return margin;
+}
+
+chip8_error chip8_frame_init(chip8_frame **frame, unsigned int hz)
+{
+	chip8_frame *newframe = NULL;
+
+	if (frame == NULL)
+		return CHIP8_EINVAL;
+
+	if (hz == 0)
+		hz = CHIP8_TIMER_HZ;
+
+	newframe = calloc(1, sizeof *newframe);
+	if (newframe == NULL)
+		return CHIP8_ENOMEM;
+
+	newframe->period = 1000000000u / hz;
+	newframe->deadline = chip8_now() + newframe->period;
+	newframe->oversleep = CHIP8_FRAME_SPIN_MAX / 8;
+	newframe->stats.spin_ns = chip8_frame_margin(newframe);
+	*frame = newframe;
+	chip8_debugx("setup new %u Hz frame scheduler %p\n", hz,
+		     (void *)(*frame));
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_frame_wait(chip8_frame *frame)
+{
+	uint64_t margin = 0;
+	uint64_t late = 0;
+	uint64_t start = 0;
+	uint64_t now = 0;
+
+	if (frame == NULL)
+		return CHIP8_EINVAL;
+
+	frame->stats.frames++;
+	now = chip8_now();
+	if (now >= frame->deadline) {
+		/* Skip ahead rather than run a burst of frames back to back... */
+		frame->stats.late++;
+		if (now - frame->deadline >= frame->period)
+			frame->deadline = now;
+		frame->deadline += frame->period;
+		return CHIP8_EOK;
+	}
+
+	margin = chip8_frame_margin(frame);
+	if (frame->deadline - now > margin) {
+		start = now;
+		chip8_frame_sleep(frame->deadline - margin);
+		now = chip8_now();
+		frame->stats.slept_ns += now - start;
+
+		/* Keep a running average of how late sleeps wake up... */
+		late = (now > frame->deadline - margin) ?
+		       now - (frame->deadline - margin) : 0;
+		frame->oversleep += late / 8 - frame->oversleep / 8;
+	}
+
+	start = now;
+	while (now < frame->deadline)
+		now = chip8_now();
+	frame->stats.spun_ns += now - start;
+	frame->stats.spin_ns = chip8_frame_margin(frame);
+	frame->deadline += frame->period;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_frame_stat(const chip8_frame *frame,
+		             chip8_frame_stats *stats)
+{
+	if (frame == NULL || stats == NULL)
+		return CHIP8_EINVAL;
+
+	*stats = frame->stats;
+	return CHIP8_EOK;
+}
+
+void chip8_frame_free(chip8_frame *frame)
+{
+	chip8_debug("free frame scheduler");
+	free(frame);
+}
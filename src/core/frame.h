@@ -0,0 +1,82 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_FRAME_H
+#define CHIP8_CORE_FRAME_H
+
+#include <stdint.h>
+
+#include "utils/error.h"
+
+#define CHIP8_FRAME_SPIN_MIN 50000   /**< Least nanoseconds spun per frame. */
+#define CHIP8_FRAME_SPIN_MAX 2000000 /**< Most nanoseconds spun per frame. */
+
+/**
+ * @brief Pacing statistics of a frame scheduler.
+ */
+typedef struct {
+	uint64_t frames;   /**< Frames waited for. */
+	uint64_t late;     /**< Frames whose deadline had already passed. */
+	uint64_t slept_ns; /**< Nanoseconds spent asleep. */
+	uint64_t spun_ns;  /**< Nanoseconds spent spinning. */
+	uint64_t spin_ns;  /**< Current spin margin in nanoseconds. */
+} chip8_frame_stats;
+
+/**
+ * @brief Frame scheduler pacing a main loop to a fixed refresh rate.
+ *
+ * @note Deadlines are fixed multiples of the frame period, so waiting never
+ *       drifts. Waits sleep until shortly before a deadline and spin the rest
+ *       of the way. The spin margin follows how late the host wakes the
+ *       thread up, which keeps precision without burning a core. A loop that
+ *       falls more than a frame behind skips ahead rather than racing to
+ *       catch up.
+ */
+typedef struct chip8_frame chip8_frame;
+
+/**
+ * @brief Create a new frame scheduler, with its first deadline one period
+ *        from now.
+ *
+ * @note Set hz to 0 to use #CHIP8_TIMER_HZ.
+ *
+ * @pre frame cannot be NULL.
+ *
+ * @param[in,out] frame Frame scheduler to initialize.
+ * @param[in] hz Frames per second.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_frame_init(chip8_frame **frame, unsigned int hz);
+
+/**
+ * @brief Wait for deadline of next frame.
+ *
+ * @pre frame cannot be NULL.
+ * @post Deadline will be moved one period further.
+ *
+ * @param[in,out] frame Frame scheduler to wait on.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_frame_wait(chip8_frame *frame);
+
+/**
+ * @brief Get pacing statistics of frame scheduler.
+ *
+ * @pre frame and stats cannot be NULL.
+ *
+ * @param[in] frame Frame scheduler to get statistics of.
+ * @param[out] stats Pacing statistics of frame scheduler.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_frame_stat(const chip8_frame *frame,
+		             chip8_frame_stats *stats);
+
+/**
+ * @brief Free frame scheduler.
+ *
+ * @param[in,out] frame Frame scheduler to free, may be NULL.
+ */
+void chip8_frame_free(chip8_frame *frame);
+
+#endif /* CHIP8_CORE_FRAME_H */
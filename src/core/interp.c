@@ -0,0 +1,124 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdint.h>
+
+#include "core/cpu.h"
+#include "core/decode.h"
+#include "core/interp.h"
+#include "core/opcode.h"
+#include "utils/error.h"
+
+/**
+ * @brief Apply X to every instruction that can continue a batch.
+ *
+ * @note Bad opcodes and FX0A always end a batch, so they are handled apart.
+ */
+#define CHIP8_INTERP_OPS(X) \
+	X(00CN) X(00E0) X(00EE) X(00FB) X(00FC) X(00FE) X(00FF) X(1NNN) \
+	X(2NNN) X(3XNN) X(4XNN) X(5XY0) X(6XNN) X(7XNN) X(8XY0) X(8XY1) \
+	X(8XY2) X(8XY3) X(8XY4) X(8XY5) X(8XY6) X(8XY7) X(8XYE) X(9XY0) \
+	X(ANNN) X(BNNN) X(CXNN) X(DXYN) X(EX9E) X(EXA1) X(FX07) X(FX15) \
+	X(FX18) X(FX1E) X(FX29) X(FX30) X(FX33) X(FX55) X(FX65) X(FX75) \
+	X(FX85)
+
+#if CHIP8_INTERP_THREADED
+
+/* Labels as values are a GNU extension, which is the whole point here... */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+#define CHIP8_INTERP_LABEL(op) [CHIP8_OP_##op] = &&op_##op,
+
+/* Fetch instruction at program counter and jump straight to it... */
+#define CHIP8_INTERP_DISPATCH()                       \
+	do {                                          \
+		ins = chip8_decode_fetch(cpu, &slow); \
+		cpu->opcode = ins->opcode;            \
+		cpu->pc += 2;                         \
+		goto *labels[ins->id];                \
+	} while (0)
+
+#define CHIP8_INTERP_CASE(op)                                 \
+	op_##op:                                              \
+		flag = chip8_opcode_##op(cpu, ins);           \
+		if (++done == budget || flag != CHIP8_EOK)    \
+			goto out;                             \
+		CHIP8_INTERP_DISPATCH();
+
+chip8_error chip8_interp_exec(chip8_cpu *cpu, unsigned long budget,
+		              unsigned long *ran)
+{
+	static const void *const labels[CHIP8_OP_COUNT] = {
+		[CHIP8_OP_BAD] = &&op_bad,
+		[CHIP8_OP_FX0A] = &&op_FX0A,
+		CHIP8_INTERP_OPS(CHIP8_INTERP_LABEL)
+	};
+	chip8_error flag = CHIP8_EOK;
+	const chip8_instr *ins = NULL;
+	chip8_instr slow;
+	unsigned long done = 0;
+
+	if (cpu == NULL || ran == NULL)
+		return CHIP8_EINVAL;
+
+	if (budget == 0)
+		goto out;
+
+	CHIP8_INTERP_DISPATCH();
+	CHIP8_INTERP_OPS(CHIP8_INTERP_CASE)
+op_FX0A:
+	flag = chip8_opcode_FX0A(cpu, ins);
+	done++;
+	goto out;
+op_bad:
+	flag = chip8_opcode_bad(cpu, ins);
+	done++;
+out:
+	*ran = done;
+	return flag;
+}
+
+#pragma GCC diagnostic pop
+
+#else /* !CHIP8_INTERP_THREADED */
+
+#define CHIP8_INTERP_CASE(op)                         \
+	case CHIP8_OP_##op:                           \
+		flag = chip8_opcode_##op(cpu, ins);   \
+		break;
+
+chip8_error chip8_interp_exec(chip8_cpu *cpu, unsigned long budget,
+		              unsigned long *ran)
+{
+	chip8_error flag = CHIP8_EOK;
+	const chip8_instr *ins = NULL;
+	chip8_instr slow;
+	unsigned long done = 0;
+
+	if (cpu == NULL || ran == NULL)
+		return CHIP8_EINVAL;
+
+	while (done < budget && flag == CHIP8_EOK) {
+		ins = chip8_decode_fetch(cpu, &slow);
+		cpu->opcode = ins->opcode;
+		cpu->pc += 2;
+		done++;
+
+		switch (ins->id) {
+		CHIP8_INTERP_OPS(CHIP8_INTERP_CASE)
+		case CHIP8_OP_FX0A:
+			*ran = done;
+			return chip8_opcode_FX0A(cpu, ins);
+		default:
+			flag = chip8_opcode_bad(cpu, ins);
+			break;
+		}
+	}
+
+	*ran = done;
+	return flag;
+}
+
+#endif /* CHIP8_INTERP_THREADED */
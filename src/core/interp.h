@@ -0,0 +1,43 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_INTERP_H
+#define CHIP8_CORE_INTERP_H
+
+#include "core/cpu.h"
+#include "utils/error.h"
+
+/**
+ * @brief Non-zero if the interpreter uses threaded dispatch.
+ *
+ * @note Threaded dispatch jumps from the end of every instruction straight
+ *       into the next one through a table of label addresses, which needs the
+ *       labels as values extension of GCC and Clang. Define CHIP8_THREADED to
+ *       request it, any other build falls back to a portable switch loop.
+ */
+#if defined(CHIP8_THREADED) && defined(__GNUC__)
+#define CHIP8_INTERP_THREADED 1
+#else
+#define CHIP8_INTERP_THREADED 0
+#endif
+
+/**
+ * @brief Interpret a batch of instructions starting at the program counter.
+ *
+ * @note Stops early after FX0A locks the keypad, or on the first instruction
+ *       that fails.
+ *
+ * @pre cpu and ran cannot be NULL.
+ * @pre Keypad of cpu must not be locked.
+ * @post cpu state will be updated by every instruction executed.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to execute.
+ * @param[in] budget Maximum amount of instructions to execute.
+ * @param[out] ran Amount of instructions executed.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_interp_exec(chip8_cpu *cpu, unsigned long budget,
+		              unsigned long *ran);
+
+#endif /* CHIP8_CORE_INTERP_H */
@@ -0,0 +1,511 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/cpu.h"
+#include "core/decode.h"
+#include "core/jit.h"
+#include "core/opcode.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define CHIP8_JIT_X86_64
+#include <sys/mman.h>
+#endif
+
+#ifdef CHIP8_JIT_X86_64
+
+#define CHIP8_JIT_ARENA_SIZE (1 << 20) /**< Executable memory per context. */
+#define CHIP8_JIT_BLOCK_MAX  64        /**< Instructions per block. */
+#define CHIP8_JIT_INSN_MAX   48        /**< Worst case bytes per instruction. */
+#define CHIP8_JIT_EDGE_MAX   32        /**< Prologue plus epilogue bytes. */
+
+/** Worst case bytes of a single block. */
+#define CHIP8_JIT_CODE_MAX \
+	(CHIP8_JIT_BLOCK_MAX * CHIP8_JIT_INSN_MAX + CHIP8_JIT_EDGE_MAX)
+
+/**
+ * @brief Signature of translated blocks.
+ */
+typedef chip8_error (*chip8_jit_func)(chip8_cpu *cpu);
+
+/**
+ * @brief Translated block starting at some address.
+ */
+typedef struct {
+	uint8_t *code;   /**< Native entry point, NULL if not translated. */
+	uint16_t count;  /**< Instructions in block. */
+	bool interp;     /**< Block cannot be translated at all. */
+	bool lock;       /**< Block ends with FX0A. */
+} chip8_jit_block;
+
+struct chip8_jit {
+	uint8_t *arena;                         /**< Executable memory. */
+	size_t used;                            /**< Bytes of arena in use. */
+	chip8_jit_block blocks[CHIP8_RAM_SIZE]; /**< Block of every address. */
+	chip8_instr insns[CHIP8_RAM_SIZE];      /**< Instructions of blocks. */
+	uint8_t code[CHIP8_RAM_SIZE];           /**< RAM bytes translated. */
+};
+
+/**
+ * @brief Emit a byte of machine code.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_jit_emit8(chip8_jit *jit, uint8_t byte)
+{
+	jit->arena[jit->used++] = byte;
+}
+
+/**
+ * @brief Emit a little endian value of some byte width.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_jit_emitn(chip8_jit *jit, uint64_t value, unsigned int width)
+{
+	for (unsigned int byte = 0; byte < width; byte++)
+		chip8_jit_emit8(jit, (value >> (byte * 8)) & 0xFF);
+}
+
+/**
+ * @brief Emit an opcode followed by a [rbx + disp32] memory operand.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in,out] jit JIT context to emit into.
+ * @param[in] op Opcode byte.
+ * @param[in] reg Register or opcode extension of the ModRM byte.
+ * @param[in] disp Offset into chip8_cpu.
+ */
+static void chip8_jit_emitmem(chip8_jit *jit, uint8_t op, uint8_t reg,
+		              size_t disp)
+{
+	chip8_jit_emit8(jit, op);
+	chip8_jit_emit8(jit, 0x83 | (reg << 3));
+	chip8_jit_emitn(jit, disp, 4);
+}
+
+/**
+ * @brief Emit mov word [rbx + disp32], imm16.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_jit_store16(chip8_jit *jit, size_t disp, uint16_t value)
+{
+	chip8_jit_emit8(jit, 0x66);
+	chip8_jit_emitmem(jit, 0xC7, 0, disp);
+	chip8_jit_emitn(jit, value, 2);
+}
+
+/**
+ * @brief Emit a conditional skip on the flags of the last compare.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in,out] jit JIT context to emit into.
+ * @param[in] jcc Short conditional jump opcode that avoids the skip.
+ * @param[in] next Address of next instruction.
+ */
+static void chip8_jit_emitskip(chip8_jit *jit, uint8_t jcc, uint16_t next)
+{
+	/* Both PC stores below are 9 bytes long... */
+	chip8_jit_store16(jit, offsetof(chip8_cpu, pc), next);
+	chip8_jit_emit8(jit, jcc);
+	chip8_jit_emit8(jit, 9);
+	chip8_jit_store16(jit, offsetof(chip8_cpu, pc), next + 2);
+}
+
+/**
+ * @brief Emit a call to the regular handler of an instruction.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in,out] jit JIT context to emit into.
+ * @param[in] ins Instruction to call handler of.
+ * @param[in] next Address of next instruction.
+ */
+static void chip8_jit_emitcall(chip8_jit *jit, const chip8_instr *ins,
+		               uint16_t next)
+{
+	/* Handlers expect PC to already point at the next instruction... */
+	chip8_jit_store16(jit, offsetof(chip8_cpu, pc), next);
+	chip8_jit_store16(jit, offsetof(chip8_cpu, opcode), ins->opcode);
+
+	/* mov rdi, rbx; mov rsi, ins; mov rax, handler; call rax */
+	chip8_jit_emit8(jit, 0x48);
+	chip8_jit_emit8(jit, 0x89);
+	chip8_jit_emit8(jit, 0xDF);
+	chip8_jit_emit8(jit, 0x48);
+	chip8_jit_emit8(jit, 0xBE);
+	chip8_jit_emitn(jit, (uint64_t)(uintptr_t)ins, 8);
+	chip8_jit_emit8(jit, 0x48);
+	chip8_jit_emit8(jit, 0xB8);
+	chip8_jit_emitn(jit, (uint64_t)(uintptr_t)ins->handler, 8);
+	chip8_jit_emit8(jit, 0xFF);
+	chip8_jit_emit8(jit, 0xD0);
+}
+
+/**
+ * @brief Emit native code for an instruction if possible.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in,out] jit JIT context to emit into.
+ * @param[in] ins Instruction to translate.
+ * @param[in] next Address of next instruction.
+ * @return True if native code was emitted, false otherwise.
+ */
+static bool chip8_jit_emitnative(chip8_jit *jit, const chip8_instr *ins,
+		                 uint16_t next)
+{
+	size_t vx = offsetof(chip8_cpu, v) + ins->x;
+	size_t vy = offsetof(chip8_cpu, v) + ins->y;
+	uint8_t alu = 0;
+
+	switch (ins->id) {
+	case CHIP8_OP_1NNN:
+		chip8_jit_store16(jit, offsetof(chip8_cpu, pc), ins->nnn);
+		return true;
+	case CHIP8_OP_3XNN:
+	case CHIP8_OP_4XNN:
+		/* cmp byte [vx], nn */
+		chip8_jit_emitmem(jit, 0x80, 7, vx);
+		chip8_jit_emit8(jit, ins->nn);
+		chip8_jit_emitskip(jit, ins->id == CHIP8_OP_3XNN ? 0x75 : 0x74,
+				   next);
+		return true;
+	case CHIP8_OP_5XY0:
+	case CHIP8_OP_9XY0:
+		/* movzx eax, byte [vy]; cmp byte [vx], al */
+		chip8_jit_emit8(jit, 0x0F);
+		chip8_jit_emitmem(jit, 0xB6, 0, vy);
+		chip8_jit_emitmem(jit, 0x38, 0, vx);
+		chip8_jit_emitskip(jit, ins->id == CHIP8_OP_5XY0 ? 0x75 : 0x74,
+				   next);
+		return true;
+	case CHIP8_OP_FX07:
+		/* movzx eax, byte [dt]; mov byte [vx], al */
+		chip8_jit_emit8(jit, 0x0F);
+		chip8_jit_emitmem(jit, 0xB6, 0, offsetof(chip8_cpu, dt));
+		chip8_jit_emitmem(jit, 0x88, 0, vx);
+		return true;
+	case CHIP8_OP_FX15:
+	case CHIP8_OP_FX18:
+		/* movzx eax, byte [vx]; mov byte [dt or st], al */
+		chip8_jit_emit8(jit, 0x0F);
+		chip8_jit_emitmem(jit, 0xB6, 0, vx);
+		chip8_jit_emitmem(jit, 0x88, 0, ins->id == CHIP8_OP_FX15 ?
+				  offsetof(chip8_cpu, dt) :
+				  offsetof(chip8_cpu, st));
+		return true;
+	case CHIP8_OP_6XNN:
+		/* mov byte [vx], nn */
+		chip8_jit_emitmem(jit, 0xC6, 0, vx);
+		chip8_jit_emit8(jit, ins->nn);
+		return true;
+	case CHIP8_OP_7XNN:
+		/* add byte [vx], nn */
+		chip8_jit_emitmem(jit, 0x80, 0, vx);
+		chip8_jit_emit8(jit, ins->nn);
+		return true;
+	case CHIP8_OP_ANNN:
+		chip8_jit_store16(jit, offsetof(chip8_cpu, i), ins->nnn);
+		return true;
+	case CHIP8_OP_8XY0:
+		alu = 0x88; /* mov [vx], al */
+		break;
+	case CHIP8_OP_8XY1:
+		alu = 0x08; /* or [vx], al */
+		break;
+	case CHIP8_OP_8XY2:
+		alu = 0x20; /* and [vx], al */
+		break;
+	case CHIP8_OP_8XY3:
+		alu = 0x30; /* xor [vx], al */
+		break;
+	default:
+		return false;
+	}
+
+	/* movzx eax, byte [vy] */
+	chip8_jit_emit8(jit, 0x0F);
+	chip8_jit_emitmem(jit, 0xB6, 0, vy);
+	chip8_jit_emitmem(jit, alu, 0, vx);
+	return true;
+}
+
+/**
+ * @brief Check if instruction ends a basic block.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @note FX33 and FX55 end blocks as they may overwrite the block itself,
+ *       FX0A ends blocks as it locks the CPU until a key is pressed.
+ */
+static bool chip8_jit_isterminal(chip8_opcode_id id)
+{
+	switch (id) {
+	case CHIP8_OP_00EE:
+	case CHIP8_OP_1NNN:
+	case CHIP8_OP_2NNN:
+	case CHIP8_OP_3XNN:
+	case CHIP8_OP_4XNN:
+	case CHIP8_OP_5XY0:
+	case CHIP8_OP_9XY0:
+	case CHIP8_OP_BNNN:
+	case CHIP8_OP_EX9E:
+	case CHIP8_OP_EXA1:
+	case CHIP8_OP_FX0A:
+	case CHIP8_OP_FX33:
+	case CHIP8_OP_FX55:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Drop every translation.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_jit_flush(chip8_jit *jit)
+{
+	memset(jit->blocks, 0, sizeof jit->blocks);
+	memset(jit->code, 0, sizeof jit->code);
+	jit->used = 0;
+	chip8_debug("flush JIT translations");
+}
+
+/**
+ * @brief Translate block starting at address.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in,out] jit JIT context to translate into.
+ * @param[in] cpu CHIP-8 CPU context holding RAM to translate.
+ * @param[in] start Address of first instruction.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+static chip8_error chip8_jit_translate(chip8_jit *jit, chip8_cpu *cpu,
+		                       uint16_t start)
+{
+	chip8_jit_block *block = &jit->blocks[start];
+	chip8_instr *ins = NULL;
+	chip8_instr *last = NULL;
+	size_t begin = 0;
+	uint16_t addr = start;
+	uint16_t count = 0;
+	bool terminal = false;
+	bool native = false;
+
+	if (CHIP8_JIT_ARENA_SIZE - jit->used < CHIP8_JIT_CODE_MAX)
+		chip8_jit_flush(jit);
+
+	if (mprotect(jit->arena, CHIP8_JIT_ARENA_SIZE,
+		     PROT_READ | PROT_WRITE) != 0)
+		return CHIP8_ENOMEM;
+
+	begin = jit->used;
+	block->code = jit->arena + begin;
+
+	/* push rbx; mov rbx, rdi */
+	chip8_jit_emit8(jit, 0x53);
+	chip8_jit_emit8(jit, 0x48);
+	chip8_jit_emit8(jit, 0x89);
+	chip8_jit_emit8(jit, 0xFB);
+
+	while (!terminal && count < CHIP8_JIT_BLOCK_MAX &&
+	       addr < CHIP8_RAM_SIZE - 1) {
+		ins = &jit->insns[addr];
+		chip8_decode_instr(cpu->memory[addr] << 8 |
+				   cpu->memory[addr + 1], ins);
+
+		/* Leave bad opcodes for the interpreter to report... */
+		if (ins->id == CHIP8_OP_BAD)
+			break;
+
+		terminal = chip8_jit_isterminal(ins->id);
+		native = chip8_jit_emitnative(jit, ins, addr + 2);
+		if (!native)
+			chip8_jit_emitcall(jit, ins, addr + 2);
+
+		jit->code[addr] = 1;
+		jit->code[addr + 1] = 1;
+		last = ins;
+		addr += 2;
+		count++;
+	}
+
+	/* Terminal instructions already set PC, handlers also result... */
+	if (!terminal)
+		chip8_jit_store16(jit, offsetof(chip8_cpu, pc), addr);
+	if (last != NULL && (!terminal || native)) {
+		chip8_jit_store16(jit, offsetof(chip8_cpu, opcode),
+				  last->opcode);
+		/* xor eax, eax */
+		chip8_jit_emit8(jit, 0x31);
+		chip8_jit_emit8(jit, 0xC0);
+	}
+
+	/* pop rbx; ret */
+	chip8_jit_emit8(jit, 0x5B);
+	chip8_jit_emit8(jit, 0xC3);
+
+	if (mprotect(jit->arena, CHIP8_JIT_ARENA_SIZE,
+		     PROT_READ | PROT_EXEC) != 0)
+		return CHIP8_ENOMEM;
+
+	if (count == 0) {
+		jit->used = begin;
+		block->code = NULL;
+		block->interp = true;
+	}
+	block->count = count;
+	block->lock = last != NULL && last->id == CHIP8_OP_FX0A;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_jit_init(chip8_jit **jit)
+{
+	chip8_jit *newjit = NULL;
+
+	if (jit == NULL)
+		return CHIP8_EINVAL;
+
+	newjit = malloc(sizeof *newjit);
+	if (newjit == NULL)
+		return CHIP8_ENOMEM;
+
+	newjit->arena = mmap(NULL, CHIP8_JIT_ARENA_SIZE, PROT_READ | PROT_EXEC,
+			     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (newjit->arena == MAP_FAILED) {
+		free(newjit);
+		return CHIP8_ENOMEM;
+	}
+
+	chip8_decode_init();
+	chip8_jit_flush(newjit);
+	*jit = newjit;
+	chip8_debugx("setup new JIT %p\n", (void *)(*jit));
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_jit_exec(chip8_jit *jit, chip8_cpu *cpu,
+		           unsigned long budget, unsigned long *ran)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_jit_block *block = NULL;
+	chip8_jit_func func = NULL;
+	uint16_t pc = 0;
+
+	if (jit == NULL || cpu == NULL || ran == NULL)
+		return CHIP8_EINVAL;
+
+	/* Chain blocks until one does not fit or cannot be translated... */
+	*ran = 0;
+	while (flag == CHIP8_EOK) {
+		pc = cpu->pc;
+		if (pc >= CHIP8_RAM_SIZE - 1)
+			break;
+
+		block = &jit->blocks[pc];
+		if (block->code == NULL && !block->interp) {
+			flag = chip8_jit_translate(jit, cpu, pc);
+			if (flag != CHIP8_EOK)
+				break;
+		}
+
+		if (block->code == NULL || block->count > budget - *ran)
+			break;
+
+		/* ISO C has no object to function pointer cast... */
+		memcpy(&func, &block->code, sizeof func);
+		*ran += block->count;
+		flag = func(cpu);
+
+		/* Let caller deal with locked keypad... */
+		if (block->lock)
+			break;
+	}
+	return flag;
+}
+
+void chip8_jit_invalidate(chip8_jit *jit, uint16_t addr, uint16_t len)
+{
+	unsigned int last = (unsigned int)addr + len;
+
+	if (jit == NULL)
+		return;
+
+	if (last > CHIP8_RAM_SIZE)
+		last = CHIP8_RAM_SIZE;
+
+	/* Self-modifying code is rare enough to just start over... */
+	for (unsigned int byte = addr; byte < last; byte++) {
+		if (jit->code[byte] != 0) {
+			chip8_jit_flush(jit);
+			return;
+		}
+	}
+
+	/* Blocks that gave up on a bad opcode may be valid now... */
+	for (unsigned int byte = addr; byte < last; byte++) {
+		jit->blocks[byte].interp = false;
+		if (byte != 0)
+			jit->blocks[byte - 1].interp = false;
+	}
+}
+
+void chip8_jit_free(chip8_jit *jit)
+{
+	if (jit == NULL)
+		return;
+
+	munmap(jit->arena, CHIP8_JIT_ARENA_SIZE);
+	chip8_debug("free CHIP-8 JIT");
+	free(jit);
+}
+
+#else /* !CHIP8_JIT_X86_64 */
+
+chip8_error chip8_jit_init(chip8_jit **jit)
+{
+	if (jit == NULL)
+		return CHIP8_EINVAL;
+
+	return CHIP8_ENOSYS;
+}
+
+chip8_error chip8_jit_exec(chip8_jit *jit, chip8_cpu *cpu,
+		           unsigned long budget, unsigned long *ran)
+{
+	(void)jit;
+	(void)cpu;
+	(void)budget;
+	if (ran != NULL)
+		*ran = 0;
+	return CHIP8_ENOSYS;
+}
+
+void chip8_jit_invalidate(chip8_jit *jit, uint16_t addr, uint16_t len)
+{
+	(void)jit;
+	(void)addr;
+	(void)len;
+}
+
+void chip8_jit_free(chip8_jit *jit)
+{
+	(void)jit;
+}
+
+#endif /* CHIP8_JIT_X86_64 */
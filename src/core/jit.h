@@ -0,0 +1,73 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_JIT_H
+#define CHIP8_CORE_JIT_H
+
+#include <stdint.h>
+
+#include "core/cpu.h"
+#include "utils/error.h"
+
+/**
+ * @brief x86-64 basic block translator.
+ *
+ * @note Straight-line runs of CHIP-8 instructions are translated into native
+ *       code ending at the first jump, call, return or skip. Simple ALU
+ *       instructions are emitted inline, everything else calls the regular
+ *       opcode handlers, so the JIT can never disagree with the interpreter.
+ */
+typedef struct chip8_jit chip8_jit;
+
+/**
+ * @brief Create a new JIT context.
+ *
+ * @pre jit cannot be NULL.
+ * @post jit will hold an empty translation cache.
+ *
+ * @param[in,out] jit JIT context to initialize.
+ * @return 0 (#CHIP8_EOK) for success, #CHIP8_ENOSYS if the host is not
+ *         x86-64, or #chip8_error code for failure.
+ */
+chip8_error chip8_jit_init(chip8_jit **jit);
+
+/**
+ * @brief Execute the translated block starting at the program counter.
+ *
+ * @note Sets ran to 0 without touching the CPU if the block is longer than
+ *       budget or cannot be translated, so the caller must fall back to the
+ *       interpreter for the next instruction.
+ *
+ * @pre jit, cpu and ran cannot be NULL.
+ * @post cpu state will be updated by every instruction in the block.
+ *
+ * @param[in,out] jit JIT context to execute with.
+ * @param[in,out] cpu CHIP-8 CPU context to execute.
+ * @param[in] budget Maximum amount of instructions to execute.
+ * @param[out] ran Amount of instructions executed.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_jit_exec(chip8_jit *jit, chip8_cpu *cpu,
+		           unsigned long budget, unsigned long *ran);
+
+/**
+ * @brief Drop translations covering a range of RAM.
+ *
+ * @pre jit cannot be NULL.
+ * @post Blocks overlapping addr to addr + len will be translated again.
+ *
+ * @param[in,out] jit JIT context to invalidate.
+ * @param[in] addr First RAM address written.
+ * @param[in] len Number of bytes written.
+ */
+void chip8_jit_invalidate(chip8_jit *jit, uint16_t addr, uint16_t len);
+
+/**
+ * @brief Free JIT context and its executable memory.
+ *
+ * @param[in,out] jit JIT context to free, may be NULL.
+ */
+void chip8_jit_free(chip8_jit *jit);
+
+#endif /* CHIP8_CORE_JIT_H */
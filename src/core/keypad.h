@@ -23,9 +23,9 @@ typedef enum {
 /**
  * @brief Representation of CHIP-8 keypad.
  *
- * @note We are using SDL2 scan codes to determine what key is pressed, and
- *       whether or not the keypad is currently locked, i.e., the user is
- *       holding down a key.
+ * @note Keys are set by whatever frontend processes user input. #states
+ *       points at the register FX0A waits to store a key into, and tells
+ *       whether or not the keypad is currently locked.
  */
 typedef struct {
 	uint8_t keys[CHIP8_KEYPAD_SIZE]; /**< Keys of keypad. */
@@ -95,29 +95,6 @@ chip8_error chip8_keypad_setkey(chip8_keypad *keypad, uint8_t key, chip8_keypad_
  */
 chip8_error chip8_keypad_getkey(chip8_keypad *keypad, uint8_t key, chip8_keypad_state *out);
 
-/**
- * @brief Poll for keypad input.
- *
- * @pre #status cannot be NULL.
- * @post Return true if poll wants to exit main loop, false otherwise.
- *
- * @param[out] status Status of poll.
- * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
- */
-chip8_error chip8_keypad_poll(bool *status);
-
-/**
- * @brief Process keypad input.
- *
- * @note This should be called after #chip8_keypad_poll().
- * @pre #keypad cannot be NULL.
- * @post Process input into keypad.
- *
- * @param[in,out] keypad Keypad to process input into.
- * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
- */
-chip8_error chip8_keypad_process(chip8_keypad *keypad);
-
 /**
  * @brief Lock keypad as user is holding down a key.
  *
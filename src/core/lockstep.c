@@ -0,0 +1,825 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/cpu.h"
+#include "core/decode.h"
+#include "core/keypad.h"
+#include "core/lockstep.h"
+#include "core/opcode.h"
+#include "core/video.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_LOCKSTEP_REJOIN   32 /**< Cycles run apart before rejoining. */
+#define CHIP8_LOCKSTEP_BLOCK    64 /**< Bytes of RAM compared at once. */
+
+/*
+ * Every vector operation below works on CHIP8_LOCKSTEP_VEC lanes at a time,
+ * one byte per lane. Builds without SSE2 fall back to "vectors" of a single
+ * lane, so the same code still runs everywhere.
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CHIP8_LOCKSTEP_ISA "avx2"
+#define CHIP8_LOCKSTEP_VEC 32
+typedef __m256i chip8_vec;
+#define chip8_vload(p)     _mm256_loadu_si256((const __m256i *)(p))
+#define chip8_vstore(p, a) _mm256_storeu_si256((__m256i *)(p), (a))
+#define chip8_vset8(b)     _mm256_set1_epi8((char)(b))
+#define chip8_vset16(w)    _mm256_set1_epi16((short)(w))
+#define chip8_vadd8        _mm256_add_epi8
+#define chip8_vsub8        _mm256_sub_epi8
+#define chip8_vor          _mm256_or_si256
+#define chip8_vand         _mm256_and_si256
+#define chip8_vxor         _mm256_xor_si256
+#define chip8_veq8         _mm256_cmpeq_epi8
+#define chip8_vgt8         _mm256_cmpgt_epi8
+#define chip8_vsubs8       _mm256_subs_epu8
+#define chip8_vsrl16       _mm256_srli_epi16
+#define chip8_vmask(a)     ((uint32_t)_mm256_movemask_epi8(a))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CHIP8_LOCKSTEP_ISA "sse2"
+#define CHIP8_LOCKSTEP_VEC 16
+typedef __m128i chip8_vec;
+#define chip8_vload(p)     _mm_loadu_si128((const __m128i *)(p))
+#define chip8_vstore(p, a) _mm_storeu_si128((__m128i *)(p), (a))
+#define chip8_vset8(b)     _mm_set1_epi8((char)(b))
+#define chip8_vset16(w)    _mm_set1_epi16((short)(w))
+#define chip8_vadd8        _mm_add_epi8
+#define chip8_vsub8        _mm_sub_epi8
+#define chip8_vor          _mm_or_si128
+#define chip8_vand         _mm_and_si128
+#define chip8_vxor         _mm_xor_si128
+#define chip8_veq8         _mm_cmpeq_epi8
+#define chip8_vgt8         _mm_cmpgt_epi8
+#define chip8_vsubs8       _mm_subs_epu8
+#define chip8_vsrl16       _mm_srli_epi16
+#define chip8_vmask(a)     ((uint32_t)_mm_movemask_epi8(a))
+#else
+#define CHIP8_LOCKSTEP_ISA "scalar"
+#define CHIP8_LOCKSTEP_VEC 1
+typedef uint8_t chip8_vec;
+#define chip8_vload(p)     (*(const uint8_t *)(p))
+#define chip8_vstore(p, a) (*(uint8_t *)(p) = (a))
+#define chip8_vset8(b)     ((uint8_t)(b))
+#define chip8_vadd8(a, b)  ((uint8_t)((a) + (b)))
+#define chip8_vsub8(a, b)  ((uint8_t)((a) - (b)))
+#define chip8_vor(a, b)    ((uint8_t)((a) | (b)))
+#define chip8_vand(a, b)   ((uint8_t)((a) & (b)))
+#define chip8_vxor(a, b)   ((uint8_t)((a) ^ (b)))
+#define chip8_veq8(a, b)   ((uint8_t)(((a) == (b)) ? 0xFF : 0x00))
+#define chip8_vgt8(a, b)   \
+	((uint8_t)(((int8_t)(a) > (int8_t)(b)) ? 0xFF : 0x00))
+#define chip8_vsubs8(a, b) ((uint8_t)(((a) > (b)) ? (a) - (b) : 0))
+#define chip8_vsrl16(a, n) ((uint8_t)((a) >> (n)))
+#define chip8_vmask(a)     ((uint32_t)(a) >> 7)
+#endif
+
+/**
+ * @brief Loop over every vector of lanes in batch.
+ *
+ * @note INTERNAL USE ONLY! Lanes past the last one are padding, and are
+ *       computed along with the rest but never read back.
+ */
+#define chip8_lanes_foreach(o, ls) \
+	for (unsigned int o = 0; o < (ls)->span; o += CHIP8_LOCKSTEP_VEC)
+
+struct chip8_lockstep {
+	/* Registers of every lane as struct-of-arrays... */
+	uint8_t v[CHIP8_VREGS][CHIP8_LOCKSTEP_LANES]; /**< V0 to VF. */
+	uint8_t dt[CHIP8_LOCKSTEP_LANES];             /**< Delay timers. */
+	uint8_t st[CHIP8_LOCKSTEP_LANES];             /**< Sound timers. */
+	uint16_t i[CHIP8_LOCKSTEP_LANES];             /**< Index registers. */
+	uint16_t pc[CHIP8_LOCKSTEP_LANES];            /**< Program counters. */
+	uint16_t sp[CHIP8_LOCKSTEP_LANES];            /**< Stack pointers. */
+	uint16_t stack[CHIP8_STACK_SIZE][CHIP8_LOCKSTEP_LANES]; /**< Stacks. */
+	uint16_t opcode;                              /**< Last opcode run. */
+
+	chip8_vm vms[CHIP8_LOCKSTEP_LANES]; /**< Machine of every lane. */
+	unsigned int lanes;                 /**< Amount of lanes. */
+	unsigned int span;                  /**< Lanes rounded up to vectors. */
+	uint32_t all;                       /**< Bit mask of every lane. */
+	unsigned int opnum;                 /**< Instructions per second. */
+	uint64_t cycles;                    /**< Shared virtual clock. */
+	uint64_t timer_count;               /**< 60Hz timer ticks elapsed. */
+	uint64_t converged_count;           /**< Cycles run as vectors. */
+
+	/**
+	 * True while every lane shares a program counter and registers live
+	 * in the arrays above, false while lanes run apart and registers live
+	 * in the CPU of every lane. Only pc[0] is kept up to date while true.
+	 */
+	bool converged;
+
+	uint8_t diff[CHIP8_RAM_SIZE];          /**< Non-zero where RAM differs. */
+	uint32_t writes[CHIP8_LOCKSTEP_LANES]; /**< Writes seen by diff. */
+};
+
+/**
+ * @brief Compare every lane of two vectors as unsigned bytes.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @return Vector with every bit of a lane set where a > b.
+ */
+static inline chip8_vec chip8_vgtu8(chip8_vec a, chip8_vec b)
+{
+	/* Only signed compares exist, so flip sign bits first... */
+	chip8_vec bias = chip8_vset8(0x80);
+
+	return chip8_vgt8(chip8_vxor(a, bias), chip8_vxor(b, bias));
+}
+
+/**
+ * @brief Get mask of lanes where a register equals an immediate byte.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static inline uint32_t chip8_lanes_eqi(const chip8_lockstep *ls,
+		                       const uint8_t *reg, uint8_t nn)
+{
+	chip8_vec imm = chip8_vset8(nn);
+	uint32_t mask = 0;
+
+	chip8_lanes_foreach(o, ls)
+		mask |= chip8_vmask(chip8_veq8(chip8_vload(reg + o), imm)) << o;
+	return mask & ls->all;
+}
+
+/**
+ * @brief Get mask of lanes where two registers are equal.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static inline uint32_t chip8_lanes_eq(const chip8_lockstep *ls,
+		                      const uint8_t *a, const uint8_t *b)
+{
+	uint32_t mask = 0;
+
+	chip8_lanes_foreach(o, ls)
+		mask |= chip8_vmask(chip8_veq8(chip8_vload(a + o),
+					       chip8_vload(b + o))) << o;
+	return mask & ls->all;
+}
+
+/**
+ * @brief Update difference map for a range of RAM.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_lockstep_diffrange(chip8_lockstep *ls, unsigned int addr,
+		                     unsigned int len)
+{
+	const uint8_t *lead = ls->vms[0].cpu->memory;
+
+	if (addr >= CHIP8_RAM_SIZE)
+		return;
+	if (addr + len > CHIP8_RAM_SIZE)
+		len = CHIP8_RAM_SIZE - addr;
+
+	for (unsigned int at = addr; at < addr + len; at++) {
+		ls->diff[at] = 0;
+		for (unsigned int lane = 1; lane < ls->lanes; lane++)
+			ls->diff[at] |= ls->vms[lane].cpu->memory[at] ^ lead[at];
+	}
+}
+
+/**
+ * @brief Rebuild difference map for all of RAM.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_lockstep_diffmap(chip8_lockstep *ls)
+{
+	const uint8_t *lead = ls->vms[0].cpu->memory;
+	bool same = true;
+
+	for (unsigned int at = 0; at < CHIP8_RAM_SIZE;
+	     at += CHIP8_LOCKSTEP_BLOCK) {
+		same = true;
+		for (unsigned int lane = 1; lane < ls->lanes && same; lane++)
+			same = memcmp(ls->vms[lane].cpu->memory + at, lead + at,
+				      CHIP8_LOCKSTEP_BLOCK) == 0;
+
+		if (same)
+			memset(ls->diff + at, 0, CHIP8_LOCKSTEP_BLOCK);
+		else
+			chip8_lockstep_diffrange(ls, at, CHIP8_LOCKSTEP_BLOCK);
+	}
+
+	for (unsigned int lane = 0; lane < ls->lanes; lane++)
+		ls->writes[lane] = ls->vms[lane].cpu->writes;
+}
+
+/**
+ * @brief Move registers of every lane into CPU of lane.
+ *
+ * @note INTERNAL USE ONLY! Lanes run apart afterwards.
+ */
+static void chip8_lockstep_scatter(chip8_lockstep *ls)
+{
+	for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+		chip8_cpu *cpu = ls->vms[lane].cpu;
+
+		for (unsigned int reg = 0; reg < CHIP8_VREGS; reg++)
+			cpu->v[reg] = ls->v[reg][lane];
+		for (unsigned int slot = 0; slot < CHIP8_STACK_SIZE; slot++)
+			cpu->stack[slot] = ls->stack[slot][lane];
+		cpu->dt = ls->dt[lane];
+		cpu->st = ls->st[lane];
+		cpu->i = ls->i[lane];
+		cpu->sp = ls->sp[lane];
+		cpu->pc = ls->pc[lane];
+		cpu->opcode = ls->opcode;
+	}
+	ls->converged = false;
+}
+
+/**
+ * @brief Move registers of CPU of every lane into batch.
+ *
+ * @note INTERNAL USE ONLY! Lanes run in lockstep afterwards.
+ */
+static void chip8_lockstep_gather(chip8_lockstep *ls)
+{
+	for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+		const chip8_cpu *cpu = ls->vms[lane].cpu;
+
+		for (unsigned int reg = 0; reg < CHIP8_VREGS; reg++)
+			ls->v[reg][lane] = cpu->v[reg];
+		for (unsigned int slot = 0; slot < CHIP8_STACK_SIZE; slot++)
+			ls->stack[slot][lane] = cpu->stack[slot];
+		ls->dt[lane] = cpu->dt;
+		ls->st[lane] = cpu->st;
+		ls->i[lane] = cpu->i;
+		ls->sp[lane] = cpu->sp;
+	}
+	ls->pc[0] = ls->vms[0].cpu->pc;
+	ls->opcode = ls->vms[0].cpu->opcode;
+	ls->converged = true;
+}
+
+/**
+ * @brief Run lanes in lockstep again if they all meet at one address.
+ *
+ * @note INTERNAL USE ONLY! Lanes waiting on a key, or lanes whose code at
+ *       the shared address differs, keep running apart.
+ */
+static void chip8_lockstep_rejoin(chip8_lockstep *ls)
+{
+	uint16_t pc = ls->vms[0].cpu->pc;
+	bool dirty = false;
+	bool lock = false;
+
+	for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+		const chip8_vm *vm = &ls->vms[lane];
+
+		chip8_keypad_islock(vm->keypad, &lock);
+		if (lock || vm->cpu->pc != pc)
+			return;
+		dirty |= vm->cpu->writes != ls->writes[lane];
+	}
+
+	if (dirty)
+		chip8_lockstep_diffmap(ls);
+	if (ls->diff[pc & 0xFFF] || ls->diff[(pc + 1) & 0xFFF])
+		return;
+	chip8_lockstep_gather(ls);
+}
+
+/**
+ * @brief Split lanes apart if their program counters differ.
+ *
+ * @note INTERNAL USE ONLY! Expects pc of every lane to be filled in.
+ */
+static void chip8_lockstep_split(chip8_lockstep *ls)
+{
+	for (unsigned int lane = 1; lane < ls->lanes; lane++) {
+		if (ls->pc[lane] != ls->pc[0]) {
+			chip8_lockstep_scatter(ls);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Take a branch on lanes given by mask.
+ *
+ * @note INTERNAL USE ONLY! Splits lanes apart unless all or none of them
+ *       take the branch.
+ */
+static void chip8_lockstep_branch(chip8_lockstep *ls, uint32_t taken,
+		                  uint16_t target)
+{
+	uint16_t pc = ls->pc[0];
+
+	if (taken == 0)
+		return;
+
+	if (taken == ls->all) {
+		ls->pc[0] = target;
+		return;
+	}
+
+	for (unsigned int lane = 0; lane < ls->lanes; lane++)
+		ls->pc[lane] = ((taken >> lane) & 1) ? target : pc;
+	chip8_lockstep_scatter(ls);
+}
+
+/**
+ * @brief Split lanes apart before current instruction.
+ *
+ * @note INTERNAL USE ONLY! Used for instructions lanes cannot run in
+ *       lockstep, which are then run by every lane on its own.
+ */
+static void chip8_lockstep_bail(chip8_lockstep *ls)
+{
+	for (unsigned int lane = 1; lane < ls->lanes; lane++)
+		ls->pc[lane] = ls->pc[0];
+	chip8_lockstep_scatter(ls);
+}
+
+/**
+ * @brief Run instruction on every lane with its opcode handler.
+ *
+ * @note INTERNAL USE ONLY! Used for instructions touching RAM, video, or
+ *       keypad of a lane, which vectors cannot reach. Program counter of
+ *       every lane must already point past the instruction.
+ */
+static chip8_error chip8_lockstep_each(chip8_lockstep *ls,
+		                       const chip8_instr *ins)
+{
+	chip8_error flag = CHIP8_EOK;
+	uint16_t pc = ls->pc[0];
+
+	for (unsigned int lane = 0; lane < ls->lanes; lane++)
+		ls->pc[lane] = pc;
+
+	for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+		chip8_cpu *cpu = ls->vms[lane].cpu;
+
+		for (unsigned int reg = 0; reg < CHIP8_VREGS; reg++)
+			cpu->v[reg] = ls->v[reg][lane];
+		cpu->dt = ls->dt[lane];
+		cpu->st = ls->st[lane];
+		cpu->i = ls->i[lane];
+		cpu->pc = pc;
+		cpu->opcode = ins->opcode;
+
+		flag = ins->handler(cpu, ins);
+		ls->vms[lane].status = flag;
+
+		for (unsigned int reg = 0; reg < CHIP8_VREGS; reg++)
+			ls->v[reg][lane] = cpu->v[reg];
+		ls->dt[lane] = cpu->dt;
+		ls->st[lane] = cpu->st;
+		ls->i[lane] = cpu->i;
+		ls->pc[lane] = cpu->pc;
+		if (flag != CHIP8_EOK)
+			break;
+	}
+	return flag;
+}
+
+/**
+ * @brief Run one instruction on every lane in lockstep.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @pre Lanes must be converged.
+ *
+ * @param[in,out] ls Batch to run instruction of.
+ * @param[out] ran 1 if instruction ran, 0 if lanes were split apart first.
+ * @return 0 (CHIP8_EOK) for success, chip8_error for failure.
+ */
+static chip8_error chip8_lockstep_step(chip8_lockstep *ls, unsigned long *ran)
+{
+	chip8_cpu *lead = ls->vms[0].cpu;
+	chip8_instr slow;
+	chip8_instr ins;
+	chip8_error flag = CHIP8_EOK;
+	uint16_t pc = ls->pc[0];
+	uint8_t *vx = NULL;
+	uint8_t *vy = NULL;
+	uint8_t *vf = ls->v[0xF];
+	chip8_vec one = chip8_vset8(1);
+
+	*ran = 0;
+	if (ls->diff[pc & 0xFFF] || ls->diff[(pc + 1) & 0xFFF]) {
+		chip8_lockstep_bail(ls);
+		return CHIP8_EOK;
+	}
+
+	/* Copy, so RAM writes of a lane never touch instruction of next... */
+	lead->pc = pc;
+	ins = *chip8_decode_fetch(lead, &slow);
+	vx = ls->v[ins.x];
+	vy = ls->v[ins.y];
+	ls->opcode = ins.opcode;
+	ls->pc[0] = pc + 2;
+	*ran = 1;
+
+	switch ((chip8_opcode_id)ins.id) {
+	case CHIP8_OP_00EE:
+		for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+			if (ls->sp[lane] == 0) {
+				ls->pc[0] = pc;
+				*ran = 0;
+				chip8_lockstep_bail(ls);
+				return CHIP8_EOK;
+			}
+		}
+		for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+			ls->sp[lane]--;
+			ls->pc[lane] = ls->stack[ls->sp[lane]][lane];
+		}
+		chip8_lockstep_split(ls);
+		break;
+	case CHIP8_OP_1NNN:
+		ls->pc[0] = ins.nnn;
+		break;
+	case CHIP8_OP_2NNN:
+		for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+			if (ls->sp[lane] >= CHIP8_STACK_SIZE) {
+				ls->pc[0] = pc;
+				*ran = 0;
+				chip8_lockstep_bail(ls);
+				return CHIP8_EOK;
+			}
+		}
+		for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+			ls->stack[ls->sp[lane]][lane] = pc + 2;
+			ls->sp[lane]++;
+		}
+		ls->pc[0] = ins.nnn;
+		break;
+	case CHIP8_OP_3XNN:
+		chip8_lockstep_branch(ls, chip8_lanes_eqi(ls, vx, ins.nn),
+				      pc + 4);
+		break;
+	case CHIP8_OP_4XNN:
+		chip8_lockstep_branch(ls, ~chip8_lanes_eqi(ls, vx, ins.nn) &
+				      ls->all, pc + 4);
+		break;
+	case CHIP8_OP_5XY0:
+		chip8_lockstep_branch(ls, chip8_lanes_eq(ls, vx, vy), pc + 4);
+		break;
+	case CHIP8_OP_6XNN:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(vx + o, chip8_vset8(ins.nn));
+		break;
+	case CHIP8_OP_7XNN:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(vx + o, chip8_vadd8(chip8_vload(vx + o),
+							 chip8_vset8(ins.nn)));
+		break;
+	case CHIP8_OP_8XY0:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(vx + o, chip8_vload(vy + o));
+		break;
+	case CHIP8_OP_8XY1:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(vx + o, chip8_vor(chip8_vload(vx + o),
+						       chip8_vload(vy + o)));
+		break;
+	case CHIP8_OP_8XY2:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(vx + o, chip8_vand(chip8_vload(vx + o),
+							chip8_vload(vy + o)));
+		break;
+	case CHIP8_OP_8XY3:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(vx + o, chip8_vxor(chip8_vload(vx + o),
+							chip8_vload(vy + o)));
+		break;
+	/*
+	 * Flag writes below follow the order of the opcode handlers, so VX or
+	 * VY being VF gives the same result...
+	 */
+	case CHIP8_OP_8XY4:
+		chip8_lanes_foreach(o, ls) {
+			chip8_vec a = chip8_vload(vx + o);
+			chip8_vec b = chip8_vload(vy + o);
+
+			/* Sum carries out when a > 255 - b... */
+			chip8_vstore(vf + o, chip8_vand(chip8_vgtu8(a,
+				     chip8_vxor(b, chip8_vset8(0xFF))), one));
+			chip8_vstore(vx + o, chip8_vadd8(a, b));
+		}
+		break;
+	case CHIP8_OP_8XY5:
+		chip8_lanes_foreach(o, ls) {
+			chip8_vstore(vf + o, chip8_vand(chip8_vgtu8(
+				     chip8_vload(vx + o), chip8_vload(vy + o)),
+				     one));
+			chip8_vstore(vx + o, chip8_vsub8(chip8_vload(vx + o),
+							 chip8_vload(vy + o)));
+		}
+		break;
+	case CHIP8_OP_8XY6:
+		chip8_lanes_foreach(o, ls) {
+			chip8_vstore(vf + o, chip8_vand(chip8_vload(vx + o),
+							one));
+			chip8_vstore(vx + o, chip8_vand(chip8_vsrl16(
+				     chip8_vload(vx + o), 1), chip8_vset8(0x7F)));
+		}
+		break;
+	case CHIP8_OP_8XY7:
+		chip8_lanes_foreach(o, ls) {
+			chip8_vstore(vf + o, chip8_vand(chip8_vgtu8(
+				     chip8_vload(vy + o), chip8_vload(vx + o)),
+				     one));
+			chip8_vstore(vx + o, chip8_vsub8(chip8_vload(vy + o),
+							 chip8_vload(vx + o)));
+		}
+		break;
+	case CHIP8_OP_8XYE:
+		chip8_lanes_foreach(o, ls) {
+			chip8_vstore(vf + o, chip8_vand(chip8_vsrl16(
+				     chip8_vload(vx + o), 7), one));
+			chip8_vstore(vx + o, chip8_vadd8(chip8_vload(vx + o),
+							 chip8_vload(vx + o)));
+		}
+		break;
+	case CHIP8_OP_9XY0:
+		chip8_lockstep_branch(ls, ~chip8_lanes_eq(ls, vx, vy) &
+				      ls->all, pc + 4);
+		break;
+	case CHIP8_OP_ANNN:
+#if CHIP8_LOCKSTEP_VEC > 1
+		for (unsigned int o = 0; o < ls->span * 2;
+		     o += CHIP8_LOCKSTEP_VEC)
+			chip8_vstore((uint8_t *)ls->i + o, chip8_vset16(ins.nnn));
+#else
+		for (unsigned int lane = 0; lane < ls->lanes; lane++)
+			ls->i[lane] = ins.nnn;
+#endif
+		break;
+	case CHIP8_OP_BNNN:
+		for (unsigned int lane = 0; lane < ls->lanes; lane++)
+			ls->pc[lane] = ls->v[0][lane] + ins.nnn;
+		chip8_lockstep_split(ls);
+		break;
+	case CHIP8_OP_FX07:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(vx + o, chip8_vload(ls->dt + o));
+		break;
+	case CHIP8_OP_FX15:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(ls->dt + o, chip8_vload(vx + o));
+		break;
+	case CHIP8_OP_FX18:
+		chip8_lanes_foreach(o, ls)
+			chip8_vstore(ls->st + o, chip8_vload(vx + o));
+		break;
+	default:
+		/* Anything touching RAM, video, or keypad of a lane... */
+		flag = chip8_lockstep_each(ls, &ins);
+		if (flag != CHIP8_EOK) {
+			chip8_lockstep_scatter(ls);
+			break;
+		}
+
+		if (ins.id == CHIP8_OP_FX33 || ins.id == CHIP8_OP_FX55) {
+			for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+				chip8_lockstep_diffrange(ls, ls->i[lane],
+					(ins.id == CHIP8_OP_FX33) ? 3 :
+					ins.x + 1);
+				ls->writes[lane] = ls->vms[lane].cpu->writes;
+			}
+		}
+
+		/* Lanes waiting on a key stop running, so split apart... */
+		if (ins.id == CHIP8_OP_FX0A)
+			chip8_lockstep_scatter(ls);
+		else
+			chip8_lockstep_split(ls);
+		break;
+	}
+	return flag;
+}
+
+/**
+ * @brief Run every lane for a fixed amount of cycles.
+ *
+ * @note INTERNAL USE ONLY! Ignores timers like #chip8_cpu_exec().
+ */
+static chip8_error chip8_lockstep_exec(chip8_lockstep *ls,
+		                       unsigned long count)
+{
+	chip8_error flag = CHIP8_EOK;
+	unsigned long chunk = 0;
+	unsigned long ran = 0;
+
+	while (count != 0 && flag == CHIP8_EOK) {
+		if (ls->converged) {
+			flag = chip8_lockstep_step(ls, &ran);
+			ls->converged_count += ran;
+			count -= ran;
+			continue;
+		}
+
+		chunk = (count > CHIP8_LOCKSTEP_REJOIN) ?
+			CHIP8_LOCKSTEP_REJOIN : count;
+		for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+			chip8_vm *vm = &ls->vms[lane];
+
+			vm->status = chip8_cpu_exec(vm->cpu, chunk, NULL);
+			if (vm->status != CHIP8_EOK)
+				flag = vm->status;
+		}
+		count -= chunk;
+
+		if (flag == CHIP8_EOK)
+			chip8_lockstep_rejoin(ls);
+	}
+	return flag;
+}
+
+/**
+ * @brief Get shared virtual clock cycle of next timer tick.
+ *
+ * @note INTERNAL USE ONLY! Matches #chip8_cpu_run().
+ */
+static uint64_t chip8_lockstep_nexttick(const chip8_lockstep *ls)
+{
+	return ((ls->timer_count + 1) * ls->opnum +
+		CHIP8_TIMER_HZ - 1) / CHIP8_TIMER_HZ;
+}
+
+/**
+ * @brief Tick timers of every lane for every timer boundary passed.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_lockstep_tick(chip8_lockstep *ls)
+{
+	chip8_vec one = chip8_vset8(1);
+
+	while (ls->cycles >= chip8_lockstep_nexttick(ls)) {
+		ls->timer_count++;
+		if (ls->converged) {
+			chip8_lanes_foreach(o, ls) {
+				chip8_vstore(ls->dt + o, chip8_vsubs8(
+					     chip8_vload(ls->dt + o), one));
+				chip8_vstore(ls->st + o, chip8_vsubs8(
+					     chip8_vload(ls->st + o), one));
+			}
+			continue;
+		}
+
+		for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+			chip8_cpu *cpu = ls->vms[lane].cpu;
+
+			if (cpu->dt != 0)
+				cpu->dt -= 1;
+			if (cpu->st != 0)
+				cpu->st -= 1;
+		}
+	}
+}
+
+/**
+ * @brief Create CPU, video, and keypad of lane.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_lockstep_vminit(chip8_vm *vm, unsigned int opnum)
+{
+	chip8_error flag = CHIP8_EOK;
+
+	flag = chip8_video_init(&vm->video);
+	if (flag != CHIP8_EOK)
+		return flag;
+
+	flag = chip8_keypad_init(&vm->keypad);
+	if (flag != CHIP8_EOK)
+		return flag;
+
+	vm->status = CHIP8_EOK;
+	vm->ran = 0;
+	return chip8_cpu_init(&vm->cpu, vm->video, vm->keypad, opnum);
+}
+
+chip8_error chip8_lockstep_init(chip8_lockstep **ls, unsigned int lanes,
+		                unsigned int opnum)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_lockstep *newls = NULL;
+
+	if (ls == NULL || lanes == 0 || lanes > CHIP8_LOCKSTEP_LANES)
+		return CHIP8_EINVAL;
+
+	newls = calloc(1, sizeof *newls);
+	if (newls == NULL)
+		return CHIP8_ENOMEM;
+
+	newls->lanes = lanes;
+	newls->span = (lanes + CHIP8_LOCKSTEP_VEC - 1) /
+		      CHIP8_LOCKSTEP_VEC * CHIP8_LOCKSTEP_VEC;
+	newls->all = (lanes == 32) ? UINT32_MAX : (UINT32_C(1) << lanes) - 1;
+	for (unsigned int lane = 0; lane < lanes; lane++) {
+		flag = chip8_lockstep_vminit(&newls->vms[lane], opnum);
+		if (flag != CHIP8_EOK)
+			goto error;
+	}
+
+	newls->opnum = newls->vms[0].cpu->opnum;
+	*ls = newls;
+	chip8_debugx("setup lockstep batch of %u lanes with %s\n", lanes,
+		     CHIP8_LOCKSTEP_ISA);
+	goto done;
+error:
+	chip8_lockstep_free(newls);
+	newls = NULL;
+done:
+	return flag;
+}
+
+chip8_vm *chip8_lockstep_vm(chip8_lockstep *ls, unsigned int lane)
+{
+	if (ls == NULL || lane >= ls->lanes)
+		return NULL;
+	return &ls->vms[lane];
+}
+
+unsigned int chip8_lockstep_lanes(const chip8_lockstep *ls)
+{
+	return ls->lanes;
+}
+
+const char *chip8_lockstep_isa(void)
+{
+	return CHIP8_LOCKSTEP_ISA;
+}
+
+chip8_error chip8_lockstep_run(chip8_lockstep *ls, unsigned long cycles,
+		               chip8_lockstep_stats *stats)
+{
+	chip8_error flag = CHIP8_EOK;
+	unsigned long done = 0;
+	uint64_t budget = 0;
+	uint64_t start = 0;
+
+	if (ls == NULL)
+		return CHIP8_EINVAL;
+
+	/* Machines may have been touched since last run... */
+	start = chip8_now();
+	ls->converged_count = 0;
+	for (unsigned int lane = 0; lane < ls->lanes; lane++)
+		ls->vms[lane].status = CHIP8_EOK;
+	chip8_lockstep_diffmap(ls);
+	chip8_lockstep_rejoin(ls);
+
+	while (done < cycles && flag == CHIP8_EOK) {
+		chip8_lockstep_tick(ls);
+		budget = chip8_lockstep_nexttick(ls) - ls->cycles;
+		if (budget > cycles - done)
+			budget = cycles - done;
+
+		flag = chip8_lockstep_exec(ls, budget);
+		ls->cycles += budget;
+		done += budget;
+	}
+	chip8_lockstep_tick(ls);
+
+	if (ls->converged)
+		chip8_lockstep_bail(ls);
+	for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+		ls->vms[lane].cpu->cycles = ls->cycles;
+		ls->vms[lane].cpu->timer_count = ls->timer_count;
+		ls->vms[lane].ran = done;
+	}
+
+	if (stats != NULL) {
+		stats->instructions = (uint64_t)done * ls->lanes;
+		stats->converged = ls->converged_count * ls->lanes;
+		stats->seconds = (chip8_now() - start) / 1e9;
+		stats->ips = (stats->seconds > 0.0) ?
+			     stats->instructions / stats->seconds : 0.0;
+	}
+	return flag;
+}
+
+void chip8_lockstep_free(chip8_lockstep *ls)
+{
+	if (ls == NULL)
+		return;
+
+	for (unsigned int lane = 0; lane < ls->lanes; lane++) {
+		chip8_cpu_free(ls->vms[lane].cpu);
+		chip8_keypad_free(ls->vms[lane].keypad);
+		chip8_video_free(ls->vms[lane].video);
+	}
+	free(ls);
+	chip8_debug("free CHIP-8 lockstep batch");
+}
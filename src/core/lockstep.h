@@ -0,0 +1,111 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_LOCKSTEP_H
+#define CHIP8_CORE_LOCKSTEP_H
+
+#include <stdint.h>
+
+#include "core/pool.h"
+#include "utils/error.h"
+
+#define CHIP8_LOCKSTEP_LANES 32 /**< Maximum amount of lanes in a batch. */
+
+/**
+ * @brief Statistics of a single lockstep run.
+ */
+typedef struct {
+	uint64_t instructions; /**< Instructions run by every lane. */
+	uint64_t converged;    /**< Instructions run as vector operations. */
+	double seconds;        /**< Wall-clock time of run. */
+	double ips;            /**< Aggregate instructions per second. */
+} chip8_lockstep_stats;
+
+/**
+ * @brief Batch of CHIP-8 machines run in lockstep.
+ *
+ * @note Registers of every lane are kept as struct-of-arrays, so while every
+ *       lane sits at the same program counter one instruction is executed
+ *       for the whole batch with SSE2 or AVX2 vector operations. Lanes that
+ *       branch apart fall back to running one at a time on the interpreter,
+ *       and are merged back once their program counters meet again.
+ */
+typedef struct chip8_lockstep chip8_lockstep;
+
+/**
+ * @brief Create a new batch of machines run in lockstep.
+ *
+ * @note If opnum is set to zero, then every lane will default to 700
+ *       instructions per second like #chip8_cpu_init().
+ *
+ * @pre ls cannot be NULL.
+ * @pre lanes must be between 1 and #CHIP8_LOCKSTEP_LANES.
+ * @post ls will hold lanes reset machines with empty RAM besides the font.
+ *
+ * @param[in,out] ls Batch to initialize.
+ * @param[in] lanes Amount of machines in batch.
+ * @param[in] opnum Number of instructions every lane runs per second.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_lockstep_init(chip8_lockstep **ls, unsigned int lanes,
+		                unsigned int opnum);
+
+/**
+ * @brief Get machine of lane.
+ *
+ * @note Machines may only be touched while the batch is not running, and
+ *       must only be run through #chip8_lockstep_run(), as every lane shares
+ *       one virtual clock.
+ *
+ * @pre ls cannot be NULL.
+ *
+ * @param[in] ls Batch to get machine of.
+ * @param[in] lane Index of lane.
+ * @return Machine of lane, NULL if lane is out of range.
+ */
+chip8_vm *chip8_lockstep_vm(chip8_lockstep *ls, unsigned int lane);
+
+/**
+ * @brief Get amount of lanes in batch.
+ *
+ * @pre ls cannot be NULL.
+ *
+ * @param[in] ls Batch to count lanes of.
+ * @return Amount of lanes.
+ */
+unsigned int chip8_lockstep_lanes(const chip8_lockstep *ls);
+
+/**
+ * @brief Get instruction set used for vector operations.
+ *
+ * @return "avx2", "sse2", or "scalar" if no vector instructions are used.
+ */
+const char *chip8_lockstep_isa(void);
+
+/**
+ * @brief Run every lane of batch for some cycles.
+ *
+ * @note Gives the same result as running every machine on its own with
+ *       #chip8_cpu_run(). If any lane fails the whole batch stops, see
+ *       #chip8_vm->status for the result of each lane.
+ *
+ * @pre ls cannot be NULL.
+ * @post Every lane will be advanced by cycles on the shared virtual clock.
+ *
+ * @param[in,out] ls Batch to run.
+ * @param[in] cycles Cycles to run every lane for.
+ * @param[out] stats Statistics of run, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_lockstep_run(chip8_lockstep *ls, unsigned long cycles,
+		               chip8_lockstep_stats *stats);
+
+/**
+ * @brief Free every machine of batch.
+ *
+ * @param[in,out] ls Batch to free, may be NULL.
+ */
+void chip8_lockstep_free(chip8_lockstep *ls);
+
+#endif /* CHIP8_CORE_LOCKSTEP_H */
@@ -0,0 +1,299 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/movie.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_MOVIE_MAGIC  "C8MV" /**< First bytes of every movie file. */
+#define CHIP8_MOVIE_HEADER 32     /**< Bytes of movie file header. */
+#define CHIP8_MOVIE_RUN    7      /**< Most bytes a run takes in a file. */
+#define CHIP8_MOVIE_RUNS   64     /**< Initial capacity of runs. */
+
+/**
+ * @brief Frames in a row that hold the same keys.
+ */
+typedef struct {
+	uint16_t keys;   /**< Mask of keys held down. */
+	uint32_t frames; /**< Frames keys are held for. */
+} chip8_movie_run;
+
+struct chip8_movie {
+	uint64_t seed;          /**< Random number seed of machine. */
+	unsigned int opnum;     /**< Instructions per second of machine. */
+	uint64_t frames;        /**< Frames recorded. */
+	chip8_movie_run *runs;  /**< Runs of frames. */
+	size_t nruns;           /**< Runs held. */
+	size_t capruns;         /**< Capacity of runs. */
+	size_t run;             /**< Run being played. */
+	uint32_t played;        /**< Frames of run already played. */
+	uint64_t carry;         /**< Nanoseconds not yet recorded. */
+};
+
+/**
+ * @brief Hold keys down on keypad, and release every other key.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_movie_keys(chip8_cpu *cpu, uint16_t keys)
+{
+	for (uint8_t key = 0; key < CHIP8_KEYPAD_SIZE; key++)
+		chip8_keypad_setkey(cpu->keypad, key, ((keys >> key) & 1) ?
+				    CHIP8_KEY_DOWN : CHIP8_KEY_UP);
+}
+
+/**
+ * @brief Add run of frames to movie.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_movie_addrun(chip8_movie *movie, uint16_t keys,
+		                      uint32_t frames)
+{
+	chip8_movie_run *runs = NULL;
+	size_t cap = movie->capruns * 2;
+
+	if (movie->nruns == movie->capruns) {
+		runs = realloc(movie->runs, cap * sizeof *runs);
+		if (runs == NULL)
+			return CHIP8_ENOMEM;
+		movie->runs = runs;
+		movie->capruns = cap;
+	}
+
+	movie->runs[movie->nruns].keys = keys;
+	movie->runs[movie->nruns].frames = frames;
+	movie->nruns++;
+	movie->frames += frames;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_movie_init(chip8_movie **movie, uint64_t seed,
+		             unsigned int opnum)
+{
+	chip8_movie *newmovie = NULL;
+
+	if (movie == NULL || opnum == 0)
+		return CHIP8_EINVAL;
+
+	newmovie = calloc(1, sizeof *newmovie);
+	if (newmovie == NULL)
+		return CHIP8_ENOMEM;
+
+	newmovie->runs = malloc(CHIP8_MOVIE_RUNS * sizeof *newmovie->runs);
+	if (newmovie->runs == NULL) {
+		free(newmovie);
+		return CHIP8_ENOMEM;
+	}
+
+	newmovie->capruns = CHIP8_MOVIE_RUNS;
+	newmovie->seed = seed;
+	newmovie->opnum = opnum;
+	*movie = newmovie;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_movie_load(chip8_movie **movie, const char *path)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_movie *newmovie = NULL;
+	uint8_t *buffer = NULL;
+	const uint8_t *at = NULL;
+	const uint8_t *end = NULL;
+	uint64_t seed = 0;
+	unsigned int opnum = 0;
+	uint64_t frames = 0;
+	uint64_t runs = 0;
+	uint16_t keys = 0;
+	uint64_t len = 0;
+	size_t size = 0;
+
+	if (movie == NULL || path == NULL)
+		return CHIP8_EINVAL;
+
+	flag = chip8_readrom(path, &buffer, &size);
+	if (flag != CHIP8_EOK)
+		return flag;
+
+	flag = CHIP8_EBADMOVIE;
+	at = buffer;
+	end = buffer + size;
+	if (size < CHIP8_MOVIE_HEADER ||
+	    memcmp(at, CHIP8_MOVIE_MAGIC, 4) != 0)
+		goto out_buffer;
+	at += 4;
+	if (chip8_getle(&at, 2) != CHIP8_MOVIE_VERSION)
+		goto out_buffer;
+	at += 2;
+	seed = chip8_getle(&at, 8);
+	opnum = chip8_getle(&at, 4);
+	frames = chip8_getle(&at, 8);
+	runs = chip8_getle(&at, 4);
+	if (opnum == 0 || runs > (uint64_t)(end - at) / 3)
+		goto out_buffer;
+
+	flag = chip8_movie_init(&newmovie, seed, opnum);
+	if (flag != CHIP8_EOK)
+		goto out_buffer;
+
+	/* Every run is a key mask followed by its length as a varint... */
+	for (uint64_t run = 0; run < runs && flag == CHIP8_EOK; run++) {
+		flag = CHIP8_EBADMOVIE;
+		if (end - at < 3)
+			goto out_movie;
+		keys = chip8_getle(&at, 2);
+		len = chip8_getvar(&at, end);
+		if (len == 0 || len > UINT32_MAX || at[-1] & 0x80)
+			goto out_movie;
+		flag = chip8_movie_addrun(newmovie, keys, len);
+	}
+
+	if (flag == CHIP8_EOK && (at != end || newmovie->frames != frames))
+		flag = CHIP8_EBADMOVIE;
+	if (flag != CHIP8_EOK)
+		goto out_movie;
+
+	*movie = newmovie;
+	goto out_buffer;
+
+out_movie:
+	chip8_movie_free(newmovie);
+out_buffer:
+	free(buffer);
+	return flag;
+}
+
+chip8_error chip8_movie_save(const chip8_movie *movie, const char *path)
+{
+	chip8_error flag = CHIP8_EOK;
+	uint8_t *buffer = NULL;
+	uint8_t *at = NULL;
+	FILE *file = NULL;
+
+	if (movie == NULL || path == NULL)
+		return CHIP8_EINVAL;
+
+	buffer = malloc(CHIP8_MOVIE_HEADER + movie->nruns * CHIP8_MOVIE_RUN);
+	if (buffer == NULL)
+		return CHIP8_ENOMEM;
+
+	at = buffer;
+	memcpy(at, CHIP8_MOVIE_MAGIC, 4);
+	at += 4;
+	chip8_putle(&at, CHIP8_MOVIE_VERSION, 2);
+	chip8_putle(&at, 0, 2);
+	chip8_putle(&at, movie->seed, 8);
+	chip8_putle(&at, movie->opnum, 4);
+	chip8_putle(&at, movie->frames, 8);
+	chip8_putle(&at, movie->nruns, 4);
+	for (size_t run = 0; run < movie->nruns; run++) {
+		chip8_putle(&at, movie->runs[run].keys, 2);
+		chip8_putvar(&at, movie->runs[run].frames);
+	}
+
+	file = fopen(path, "wb");
+	if (file == NULL) {
+		flag = CHIP8_ENOFILE;
+		goto out_buffer;
+	}
+
+	if (fwrite(buffer, 1, at - buffer, file) != (size_t)(at - buffer))
+		flag = CHIP8_EIO;
+	if (fclose(file) != 0)
+		flag = CHIP8_EIO;
+
+out_buffer:
+	free(buffer);
+	return flag;
+}
+
+chip8_error chip8_movie_stat(const chip8_movie *movie,
+		             chip8_movie_stats *stats)
+{
+	if (movie == NULL || stats == NULL)
+		return CHIP8_EINVAL;
+
+	stats->seed = movie->seed;
+	stats->opnum = movie->opnum;
+	stats->frames = movie->frames;
+	stats->runs = movie->nruns;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_movie_record(chip8_movie *movie, chip8_cpu *cpu,
+		               uint16_t keys)
+{
+	chip8_movie_run *last = NULL;
+
+	if (movie == NULL || cpu == NULL)
+		return CHIP8_EINVAL;
+
+	chip8_movie_keys(cpu, keys);
+	if (movie->nruns != 0)
+		last = &movie->runs[movie->nruns - 1];
+
+	if (last != NULL && last->keys == keys && last->frames < UINT32_MAX) {
+		last->frames++;
+		movie->frames++;
+	} else if (chip8_movie_addrun(movie, keys, 1) != CHIP8_EOK) {
+		return CHIP8_ENOMEM;
+	}
+	return chip8_cpu_frame(cpu);
+}
+
+chip8_error chip8_movie_cycle(chip8_movie *movie, chip8_cpu *cpu,
+		              uint16_t keys)
+{
+	chip8_error flag = CHIP8_EOK;
+	uint64_t now = 0;
+
+	if (movie == NULL || cpu == NULL)
+		return CHIP8_EINVAL;
+
+	now = chip8_now();
+	movie->carry += now - cpu->ticks;
+	cpu->ticks = now;
+
+	while (movie->carry >= CHIP8_FRAME_NS && flag == CHIP8_EOK) {
+		movie->carry -= CHIP8_FRAME_NS;
+		flag = chip8_movie_record(movie, cpu, keys);
+	}
+	return flag;
+}
+
+chip8_error chip8_movie_play(chip8_movie *movie, chip8_cpu *cpu, bool *done)
+{
+	const chip8_movie_run *run = NULL;
+
+	if (movie == NULL || cpu == NULL || done == NULL)
+		return CHIP8_EINVAL;
+
+	*done = movie->run == movie->nruns;
+	if (*done)
+		return CHIP8_EOK;
+
+	run = &movie->runs[movie->run];
+	chip8_movie_keys(cpu, run->keys);
+	if (++movie->played == run->frames) {
+		movie->played = 0;
+		movie->run++;
+	}
+	return chip8_cpu_frame(cpu);
+}
+
+void chip8_movie_free(chip8_movie *movie)
+{
+	if (movie != NULL)
+		free(movie->runs);
+	free(movie);
+}
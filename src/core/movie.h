@@ -0,0 +1,145 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_MOVIE_H
+#define CHIP8_CORE_MOVIE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/cpu.h"
+#include "utils/error.h"
+
+#define CHIP8_MOVIE_VERSION 1 /**< Version of movie files. */
+
+/**
+ * @brief Summary of an input movie.
+ */
+typedef struct {
+	uint64_t seed;      /**< Random number seed of machine. */
+	unsigned int opnum; /**< Instructions per second of machine. */
+	uint64_t frames;    /**< Frames recorded. */
+	size_t runs;        /**< Runs of frames with the same keys. */
+} chip8_movie_stats;
+
+/**
+ * @brief Input movie of a CHIP-8 machine.
+ *
+ * @note Keys are only applied at the start of every 60Hz frame on the
+ *       virtual clock, so a movie replays the exact same game given the
+ *       same ROM, seed, and speed. Frames are stored as runs of frames that
+ *       hold the same 16-bit key mask, so a movie only grows when keys
+ *       change.
+ */
+typedef struct chip8_movie chip8_movie;
+
+/**
+ * @brief Create a new empty movie to record into.
+ *
+ * @note Recording must start on a machine that just loaded its ROM after
+ *       being seeded with seed.
+ *
+ * @pre movie cannot be NULL.
+ * @pre opnum cannot be 0.
+ *
+ * @param[in,out] movie Movie to initialize.
+ * @param[in] seed Random number seed of recorded machine.
+ * @param[in] opnum Instructions per second of recorded machine.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_movie_init(chip8_movie **movie, uint64_t seed,
+		             unsigned int opnum);
+
+/**
+ * @brief Load movie from file to play back.
+ *
+ * @pre movie and path cannot be NULL.
+ *
+ * @param[in,out] movie Movie to initialize.
+ * @param[in] path File to read movie from.
+ * @return 0 (#CHIP8_EOK) for success, #CHIP8_EBADMOVIE if file is not a
+ *         valid movie of this version, or #chip8_error code for failure.
+ */
+chip8_error chip8_movie_load(chip8_movie **movie, const char *path);
+
+/**
+ * @brief Save movie to file.
+ *
+ * @pre movie and path cannot be NULL.
+ *
+ * @param[in] movie Movie to save.
+ * @param[in] path File to write movie to.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_movie_save(const chip8_movie *movie, const char *path);
+
+/**
+ * @brief Get summary of movie.
+ *
+ * @pre movie and stats cannot be NULL.
+ *
+ * @param[in] movie Movie to summarize.
+ * @param[out] stats Summary of movie.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_movie_stat(const chip8_movie *movie,
+		             chip8_movie_stats *stats);
+
+/**
+ * @brief Apply keys and run a single frame, recording it into movie.
+ *
+ * @pre movie and cpu cannot be NULL.
+ *
+ * @param[in,out] movie Movie to record into.
+ * @param[in,out] cpu CHIP-8 CPU context to run.
+ * @param[in] keys Mask of keys held down, bit n being key n.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_movie_record(chip8_movie *movie, chip8_cpu *cpu,
+		               uint16_t keys);
+
+/**
+ * @brief Record frames in real time.
+ *
+ * @note Runs one frame through #chip8_movie_record() for every 60Hz frame
+ *       of wall-clock time passed since the last call, the same way
+ *       #chip8_cpu_cycle() paces instructions.
+ *
+ * @pre movie and cpu cannot be NULL.
+ *
+ * @param[in,out] movie Movie to record into.
+ * @param[in,out] cpu CHIP-8 CPU context to run.
+ * @param[in] keys Mask of keys held down, bit n being key n.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_movie_cycle(chip8_movie *movie, chip8_cpu *cpu,
+		              uint16_t keys);
+
+/**
+ * @brief Apply keys of next frame of movie and run it.
+ *
+ * @note Playback must start on a machine that just loaded the same ROM
+ *       after being created with the speed of the movie and seeded with its
+ *       seed. Runs as fast as the host allows.
+ *
+ * @pre movie, cpu, and done cannot be NULL.
+ * @post done will be true once every frame was played, and cpu is left
+ *       untouched.
+ *
+ * @param[in,out] movie Movie to play.
+ * @param[in,out] cpu CHIP-8 CPU context to run.
+ * @param[out] done Whether or not movie already ended.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_movie_play(chip8_movie *movie, chip8_cpu *cpu, bool *done);
+
+/**
+ * @brief Free movie.
+ *
+ * @param[in,out] movie Movie to free, may be NULL.
+ */
+void chip8_movie_free(chip8_movie *movie);
+
+#endif /* CHIP8_CORE_MOVIE_H */
@@ -6,115 +6,159 @@
 #include "core/video.h"
 #include "core/keypad.h"
 #include "utils/auxfun.h"
+#include "utils/error.h"
 
-void chip8_opcode_00E0(chip8_cpu *cpu)
+chip8_error chip8_opcode_bad(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	chip8_debugx("bad opcode - %04X\n", cpu->opcode);
+	return CHIP8_EBADOP;
+}
+
+chip8_error chip8_opcode_00CN(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	chip8_video_scroll_down(cpu->video, ins->n);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_00E0(chip8_cpu *cpu, const chip8_instr *ins)
 {
 	chip8_video_clear(cpu->video);
-	chip8_debug("opcode 0E00");
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_00EE(chip8_cpu *cpu)
+chip8_error chip8_opcode_00EE(chip8_cpu *cpu, const chip8_instr *ins)
 {
 	cpu->sp--;
 	cpu->pc = cpu->stack[cpu->sp];
-	chip8_debug("opcode 00EE");
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_00FB(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	chip8_video_scroll_right(cpu->video, 4);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_00FC(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	chip8_video_scroll_left(cpu->video, 4);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_00FE(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	chip8_video_resolution(cpu->video, false);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_1NNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_00FF(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint16_t nnn = cpu->opcode & 0x0FFF;
+	chip8_video_resolution(cpu->video, true);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_1NNN(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	uint16_t nnn = ins->nnn;
 	cpu->pc = nnn;
-	chip8_debugx("opcode 1NNN - %04X\n", cpu->opcode);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_2NNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_2NNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint16_t nnn = cpu->opcode & 0x0FFF;
+	uint16_t nnn = ins->nnn;
 	cpu->stack[cpu->sp] = cpu->pc;
 	cpu->sp++;
 	cpu->pc = nnn;
-	chip8_debug("opcode 2NNN");
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_3XNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_3XNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t nn = cpu->opcode & 0x00FF;
+	uint8_t x = ins->x;
+	uint8_t nn = ins->nn;
 	 if (cpu->v[x] == nn)
             {
                 cpu->pc += 2;
             }
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_4XNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_4XNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t nn = cpu->opcode & 0x00FF;
+	uint8_t x = ins->x;
+	uint8_t nn = ins->nn;
 	if (cpu->v[x] != nn)
             {
                 cpu->pc += 2;
             }
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_5XY0(chip8_cpu *cpu)
+chip8_error chip8_opcode_5XY0(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	if (cpu->v[x] == cpu->v[y])
             {
                 cpu->pc += 2;
             }
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_6XNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_6XNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t nn = cpu->opcode & 0x00FF;
+	uint8_t x = ins->x;
+	uint8_t nn = ins->nn;
 	cpu->v[x] = nn;
-	chip8_debugx("opcode 6XNN - %04X\n", cpu->opcode);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_7XNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_7XNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t nn = cpu->opcode & 0x00FF;
+	uint8_t x = ins->x;
+	uint8_t nn = ins->nn;
 	cpu->v[x] += nn;
-	chip8_debugx("opcode 7XNN - %04X\n", cpu->opcode);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY0(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY0(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	cpu->v[x] = cpu->v[y];
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY1(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY1(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	cpu->v[x] = cpu->v[x] | cpu->v[y];
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY2(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY2(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	cpu->v[x] = cpu->v[x] & cpu->v[y];
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY3(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY3(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	cpu->v[x] = cpu->v[x] ^ cpu->v[y];
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY4(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY4(chip8_cpu *cpu, const chip8_instr *ins)
 {
 	uint16_t tmp = 0;
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	tmp = cpu->v[x] + cpu->v[y];
         cpu->v[0x0f] = false;
         if (tmp > 0xff)
@@ -123,12 +167,13 @@ void chip8_opcode_8XY4(chip8_cpu *cpu)
         }
 
         cpu->v[x] = tmp;
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY5(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY5(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	if (cpu->v[x] > cpu->v[y])
 	{
         	cpu->v[0x0F] = true; 
@@ -139,11 +184,12 @@ void chip8_opcode_8XY5(chip8_cpu *cpu)
 	}
 
 	cpu->v[x] = cpu->v[x] - cpu->v[y];
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY6(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY6(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 
 	if (cpu->v[x] & 0x1)
 		cpu->v[0xf] = 1;
@@ -151,12 +197,13 @@ void chip8_opcode_8XY6(chip8_cpu *cpu)
 		cpu->v[0xf] = 0;
 
 	cpu->v[x] = cpu->v[x] >> 1;
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XY7(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XY7(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;	
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;	
 	if (cpu->v[y] > cpu->v[x])
 	{
         	cpu->v[0x0F] = true; 
@@ -166,11 +213,12 @@ void chip8_opcode_8XY7(chip8_cpu *cpu)
         	cpu->v[0x0F] = false;
 	}
 	cpu->v[x] = cpu->v[y] - cpu->v[x];
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_8XYE(chip8_cpu *cpu)
+chip8_error chip8_opcode_8XYE(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 
 	if (cpu->v[x] & 0x80)
 		cpu->v[0xf] = 1;
@@ -178,148 +226,211 @@ void chip8_opcode_8XYE(chip8_cpu *cpu)
 		cpu->v[0xf] = 0;
 
 	cpu->v[x] = cpu->v[x] << 1;
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_9XY0(chip8_cpu *cpu)
+chip8_error chip8_opcode_9XY0(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
+	uint8_t x = ins->x;
+	uint8_t y = ins->y;
 	if (cpu->v[x] != cpu->v[y])
 	{
         	cpu->pc += 2;
 	}
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_ANNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_ANNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint16_t nnn = cpu->opcode & 0x0FFF;
+	uint16_t nnn = ins->nnn;
 	cpu->i = nnn;
-	chip8_debugx("opcode ANNN - %04X\n", cpu->opcode);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_BNNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_BNNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint16_t nnn = cpu->opcode & 0x0FFF;
+	uint16_t nnn = ins->nnn;
 	cpu->pc = cpu->v[0] + nnn;
-	chip8_debugx("BNNN PC (%d) = V0 (%d) + NNN (%d)\n", cpu->pc, cpu->v[0], nnn);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_CXNN(chip8_cpu *cpu)
+chip8_error chip8_opcode_CXNN(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t nn = cpu->opcode & 0x00FF;
-	uint8_t r = rand() % 256;
+	uint8_t x = ins->x;
+	uint8_t nn = ins->nn;
+	uint8_t r = chip8_cpu_rand(cpu);
 
 	cpu->v[x] = r & nn;
-	chip8_debug("opcode CXNN");
-}
-
-void chip8_opcode_DXYN(chip8_cpu *cpu)
-{
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
-	uint8_t y = (cpu->opcode & 0x00F0) >> 4;
-	uint8_t n = cpu->opcode & 0x000F;
-	uint8_t xpos = cpu->v[x];
-	uint8_t ypos = cpu->v[y];
-	uint8_t pixel = 0;
-
-	cpu->v[0xF] = 0;
-	for (int col = 0; col < n; col++) {
-		pixel = cpu->memory[cpu->i + col];
-		for (int row = 0; row < 8; row++) {
-			if ((pixel & (0x80 >> row)) != 0) {
-				if (cpu->video->pixels[ypos + col][xpos + row] == 1)
-					cpu->v[0xF] = 1;
-				cpu->video->pixels[ypos + col][xpos + row] ^= 1;
-			}
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_DXYN(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	chip8_video *video = cpu->video;
+	const unsigned int height = chip8_video_height(video);
+	uint64_t *rows = video->rows;
+	uint8_t xpos = cpu->v[ins->x] % chip8_video_width(video);
+	uint8_t ypos = cpu->v[ins->y] % height;
+	uint8_t n = ins->n;
+	uint8_t bytes = 1;
+	uint64_t sprite = 0;
+	uint64_t left = 0;
+	uint64_t right = 0;
+	uint64_t hit = 0;
+
+	/* DXY0 draws 16x16 sprites, two bytes per row... */
+	if (n == 0) {
+		n = 16;
+		bytes = 2;
+	}
+
+	/* Sprites start wrapped around the screen, but get clipped at the
+	 * right and bottom edges... */
+	if (n > height - ypos)
+		n = height - ypos;
+	for (int line = 0; line < n; line++) {
+		sprite = cpu->memory[cpu->i + bytes * line];
+		if (bytes == 2)
+			sprite = sprite << 8 |
+				 cpu->memory[cpu->i + bytes * line + 1];
+		sprite <<= 64 - 8 * bytes;
+
+		if (!video->hires) {
+			hit |= rows[ypos + line] & (sprite >> xpos);
+			rows[ypos + line] ^= sprite >> xpos;
+			continue;
 		}
+
+		/* High resolution rows span two words, split sprite row
+		 * between them... */
+		left = (xpos < 64) ? sprite >> xpos : 0;
+		right = (xpos < 64) ? ((xpos == 0) ? 0 : sprite << (64 - xpos)) :
+			sprite >> (xpos - 64);
+		hit |= (rows[2 * (ypos + line)] & left) |
+		       (rows[2 * (ypos + line) + 1] & right);
+		rows[2 * (ypos + line)] ^= left;
+		rows[2 * (ypos + line) + 1] ^= right;
 	}
-	chip8_debugx("opcode DXYN - %04X, X=%d, Y=%d\n", cpu->opcode, cpu->v[x], cpu->v[y]);
+	cpu->v[0xF] = hit != 0;
+	video->dirty |= (((uint64_t)1 << n) - 1) << ypos;
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_EX9E(chip8_cpu *cpu)
+chip8_error chip8_opcode_EX9E(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	chip8_keypad_state state = 0;
 	chip8_keypad_getkey(cpu->keypad, cpu->v[x], &state);
 	if (state == CHIP8_KEY_DOWN)
 		cpu->pc += 2;
-	chip8_debug("opcode EX9E");
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_EXA1(chip8_cpu *cpu)
+chip8_error chip8_opcode_EXA1(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	chip8_keypad_state state = 0;
 	chip8_keypad_getkey(cpu->keypad, cpu->v[x], &state);
 	if (state == CHIP8_KEY_UP)
 		cpu->pc += 2;
-	chip8_debug("opcode EXA1");
+	return CHIP8_EOK;
 }
 
 //added
-void chip8_opcode_FX07(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX07(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	cpu->v[x] = cpu->dt;
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_FX0A(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX0A(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	chip8_keypad_lock(cpu->keypad, &cpu->v[x]);
-	chip8_debug("opcode FX0A");
+	return CHIP8_EOK;
 }
 
 //added
-void chip8_opcode_FX15(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX15(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	cpu->dt = cpu->v[x];
+	return CHIP8_EOK;
 }
 
 //added
-void chip8_opcode_FX18(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX18(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	cpu->st = cpu->v[x];
+	return CHIP8_EOK;
 }
 
 //added
-void chip8_opcode_FX1E(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX1E(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	cpu->i += cpu->v[x];
+	return CHIP8_EOK;
 }
 
 //added
-void chip8_opcode_FX29(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX29(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	cpu->i = cpu->v[x] * 0x05;
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_FX33(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX30(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
+	cpu->i = CHIP8_FONT_LARGE + (cpu->v[x] & 0xF) * 10;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_FX33(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	uint8_t x = ins->x;
 	cpu->memory[cpu->i] = cpu->v[x] / 100;
 	cpu->memory[cpu->i + 1] = (cpu->v[x] / 10) % 10;
 	cpu->memory[cpu->i + 2] = (cpu->v[x] % 100) % 10;
-	chip8_debug("opcode FX33");
+	chip8_cpu_invalidate(cpu, cpu->i, 3);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_FX55(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX55(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	for(unsigned int reg = 0; reg <= x; reg++) {
 		cpu->memory[cpu->i + reg] = cpu->v[reg];
 	}
+	chip8_cpu_invalidate(cpu, cpu->i, x + 1);
+	return CHIP8_EOK;
 }
 
-void chip8_opcode_FX65(chip8_cpu *cpu)
+chip8_error chip8_opcode_FX65(chip8_cpu *cpu, const chip8_instr *ins)
 {
-	uint8_t x = (cpu->opcode & 0x0F00) >> 8;
+	uint8_t x = ins->x;
 	for(unsigned int reg = 0; reg <= x; reg++) {
 		cpu->v[reg] = cpu->memory[cpu->i + reg];
 	}
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_FX75(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	uint8_t x = ins->x;
+	for (unsigned int reg = 0; reg <= x; reg++)
+		cpu->rpl[reg] = cpu->v[reg];
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_opcode_FX85(chip8_cpu *cpu, const chip8_instr *ins)
+{
+	uint8_t x = ins->x;
+	for (unsigned int reg = 0; reg <= x; reg++)
+		cpu->v[reg] = cpu->rpl[reg];
+	return CHIP8_EOK;
 }
@@ -6,6 +6,86 @@
 #define CHIP8_OPCODE_H
 
 #include "core/cpu.h"
+#include "utils/error.h"
+
+/**
+ * @brief Identifiers of every instruction the opcode decoder understands.
+ *
+ * @note #CHIP8_OP_BAD is always zero so that zeroed decode tables route to
+ *       #chip8_opcode_bad() by default.
+ */
+typedef enum {
+	CHIP8_OP_BAD = 0, /**< Invalid or unsupported instruction. */
+	CHIP8_OP_00CN,    /**< 00CN instruction, SUPER-CHIP. */
+	CHIP8_OP_00E0,    /**< 00E0 instruction. */
+	CHIP8_OP_00EE,    /**< 00EE instruction. */
+	CHIP8_OP_00FB,    /**< 00FB instruction, SUPER-CHIP. */
+	CHIP8_OP_00FC,    /**< 00FC instruction, SUPER-CHIP. */
+	CHIP8_OP_00FE,    /**< 00FE instruction, SUPER-CHIP. */
+	CHIP8_OP_00FF,    /**< 00FF instruction, SUPER-CHIP. */
+	CHIP8_OP_1NNN,    /**< 1NNN instruction. */
+	CHIP8_OP_2NNN,    /**< 2NNN instruction. */
+	CHIP8_OP_3XNN,    /**< 3XNN instruction. */
+	CHIP8_OP_4XNN,    /**< 4XNN instruction. */
+	CHIP8_OP_5XY0,    /**< 5XY0 instruction. */
+	CHIP8_OP_6XNN,    /**< 6XNN instruction. */
+	CHIP8_OP_7XNN,    /**< 7XNN instruction. */
+	CHIP8_OP_8XY0,    /**< 8XY0 instruction. */
+	CHIP8_OP_8XY1,    /**< 8XY1 instruction. */
+	CHIP8_OP_8XY2,    /**< 8XY2 instruction. */
+	CHIP8_OP_8XY3,    /**< 8XY3 instruction. */
+	CHIP8_OP_8XY4,    /**< 8XY4 instruction. */
+	CHIP8_OP_8XY5,    /**< 8XY5 instruction. */
+	CHIP8_OP_8XY6,    /**< 8XY6 instruction. */
+	CHIP8_OP_8XY7,    /**< 8XY7 instruction. */
+	CHIP8_OP_8XYE,    /**< 8XYE instruction. */
+	CHIP8_OP_9XY0,    /**< 9XY0 instruction. */
+	CHIP8_OP_ANNN,    /**< ANNN instruction. */
+	CHIP8_OP_BNNN,    /**< BNNN instruction. */
+	CHIP8_OP_CXNN,    /**< CXNN instruction. */
+	CHIP8_OP_DXYN,    /**< DXYN instruction. */
+	CHIP8_OP_EX9E,    /**< EX9E instruction. */
+	CHIP8_OP_EXA1,    /**< EXA1 instruction. */
+	CHIP8_OP_FX07,    /**< FX07 instruction. */
+	CHIP8_OP_FX0A,    /**< FX0A instruction. */
+	CHIP8_OP_FX15,    /**< FX15 instruction. */
+	CHIP8_OP_FX18,    /**< FX18 instruction. */
+	CHIP8_OP_FX1E,    /**< FX1E instruction. */
+	CHIP8_OP_FX29,    /**< FX29 instruction. */
+	CHIP8_OP_FX30,    /**< FX30 instruction, SUPER-CHIP. */
+	CHIP8_OP_FX33,    /**< FX33 instruction. */
+	CHIP8_OP_FX55,    /**< FX55 instruction. */
+	CHIP8_OP_FX65,    /**< FX65 instruction. */
+	CHIP8_OP_FX75,    /**< FX75 instruction, SUPER-CHIP. */
+	CHIP8_OP_FX85,    /**< FX85 instruction, SUPER-CHIP. */
+	CHIP8_OP_COUNT    /**< Instruction count INTERNAL USE ONLY! */
+} chip8_opcode_id;
+
+/**
+ * @brief Handle an invalid opcode.
+ *
+ * @pre cpu must not be NULL.
+ * @post CPU state is left untouched.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return Always #CHIP8_EBADOP.
+ */
+chip8_error chip8_opcode_bad(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Scroll the screen down N rows.
+ *
+ * @note Scrolls by N pixels of the current resolution.
+ *
+ * @pre cpu must not be NULL.
+ * @post Screen will be scrolled down N rows, blank rows entering at the top.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_00CN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Clear the screen.
@@ -14,8 +94,10 @@
  * @post Screen will be cleared fully.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_00E0(chip8_cpu *cpu);
+chip8_error chip8_opcode_00E0(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Return from subroutine.
@@ -24,8 +106,58 @@ void chip8_opcode_00E0(chip8_cpu *cpu);
  * @post PC will be loaded with popped value from stack.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_00EE(chip8_cpu *cpu);
+chip8_error chip8_opcode_00EE(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Scroll the screen right 4 pixels.
+ *
+ * @pre cpu must not be NULL.
+ * @post Screen will be scrolled right, blank columns entering at the left.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_00FB(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Scroll the screen left 4 pixels.
+ *
+ * @pre cpu must not be NULL.
+ * @post Screen will be scrolled left, blank columns entering at the right.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_00FC(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Switch to 64x32 low resolution.
+ *
+ * @pre cpu must not be NULL.
+ * @post Screen will be cleared in low resolution.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_00FE(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Switch to 128x64 high resolution.
+ *
+ * @pre cpu must not be NULL.
+ * @post Screen will be cleared in high resolution.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_00FF(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Jump to address NNN.
@@ -34,8 +166,10 @@ void chip8_opcode_00EE(chip8_cpu *cpu);
  * @post PC will be loaded with immediate value NNN.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_1NNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_1NNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Execute subroutine starting at address NNN.
@@ -44,8 +178,10 @@ void chip8_opcode_1NNN(chip8_cpu *cpu);
  * @post PC will be pushed onto stack before jumping to address NNN.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_2NNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_2NNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Skip next instruction if VX == NN.
@@ -54,8 +190,10 @@ void chip8_opcode_2NNN(chip8_cpu *cpu);
  * @post PC += 2 if VX == NN.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_3XNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_3XNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Skip next instruction if VX != NN.
@@ -64,8 +202,10 @@ void chip8_opcode_3XNN(chip8_cpu *cpu);
  * @post PC += 2 if VX != NN.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_4XNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_4XNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Skip next instruction if VX == VY.
@@ -74,8 +214,10 @@ void chip8_opcode_4XNN(chip8_cpu *cpu);
  * @post PC += 2 if VX == VY.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_5XY0(chip8_cpu *cpu);
+chip8_error chip8_opcode_5XY0(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Load NN into VX.
@@ -84,8 +226,10 @@ void chip8_opcode_5XY0(chip8_cpu *cpu);
  * @post VX = NN.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_6XNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_6XNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Add NN to VX.
@@ -94,8 +238,10 @@ void chip8_opcode_6XNN(chip8_cpu *cpu);
  * @post VX = VX + NN.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_7XNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_7XNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store VY into VX.
@@ -104,8 +250,10 @@ void chip8_opcode_7XNN(chip8_cpu *cpu);
  * @post VX = VY.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY0(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY0(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Logical OR VX with VY.
@@ -114,8 +262,10 @@ void chip8_opcode_8XY0(chip8_cpu *cpu);
  * @post VX = VX | VY.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY1(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY1(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Logical AND VX with VY.
@@ -124,8 +274,10 @@ void chip8_opcode_8XY1(chip8_cpu *cpu);
  * @post VX = VX & VY.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY2(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY2(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Logical XOR VX with VY.
@@ -134,8 +286,10 @@ void chip8_opcode_8XY2(chip8_cpu *cpu);
  * @post VX = VX ^ VY.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY3(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY3(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Add VY to VX.
@@ -146,8 +300,10 @@ void chip8_opcode_8XY3(chip8_cpu *cpu);
  * @post VX = VX + VY and VF = 1 if carry occurs.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY4(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY4(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Subtract VY from VX.
@@ -158,8 +314,10 @@ void chip8_opcode_8XY4(chip8_cpu *cpu);
  * @post VX = VX - VY and VF = 1 if borrow occurs.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY5(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY5(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store right shifted VY into VX.
@@ -171,8 +329,10 @@ void chip8_opcode_8XY5(chip8_cpu *cpu);
  * @post VX = VY >> 1 and VF = lsb prior to shift.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY6(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY6(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Set VX to the value of VY minus VX.
@@ -183,8 +343,10 @@ void chip8_opcode_8XY6(chip8_cpu *cpu);
  * @post VX = VY - VX and VF = 1 if borrow does not occur.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XY7(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XY7(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store left shifted VY into VX.
@@ -196,8 +358,10 @@ void chip8_opcode_8XY7(chip8_cpu *cpu);
  * @post VX = VY << 1 and VF = msb prior to shift.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_8XYE(chip8_cpu *cpu);
+chip8_error chip8_opcode_8XYE(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Skip next instruction if VX != VY.
@@ -206,8 +370,10 @@ void chip8_opcode_8XYE(chip8_cpu *cpu);
  * @post PC += 2 if VX != VY.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_9XY0(chip8_cpu *cpu);
+chip8_error chip8_opcode_9XY0(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store address NNN in I.
@@ -216,8 +382,10 @@ void chip8_opcode_9XY0(chip8_cpu *cpu);
  * @post I = NNN.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_ANNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_ANNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Jump to address NNN + V0
@@ -226,29 +394,38 @@ void chip8_opcode_ANNN(chip8_cpu *cpu);
  * @post PC = NNN + V0.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_BNNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_BNNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store random number with mask of NN in VX.
  *
  * @pre cpu must not be NULL.
- * @post VX = rand() & NN.
+ * @post VX = random byte of CPU & NN, see #chip8_cpu_rand().
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_CXNN(chip8_cpu *cpu);
+chip8_error chip8_opcode_CXNN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Draw sprite at position VX, VY with N bytes of sprite data starting
  *        at the address stored in I.
  *
+ * @note DXY0 draws a SUPER-CHIP 16x16 sprite of two bytes per row instead,
+ *       in either resolution. VF is set to 1 if any lit pixel is erased.
+ *
  * @pre cpu must not be NULL.
  * @post Draw N + I sprite at position VX, VY.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_DXYN(chip8_cpu *cpu);
+chip8_error chip8_opcode_DXYN(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Skip next instruction if current key value == VX.
@@ -257,8 +434,10 @@ void chip8_opcode_DXYN(chip8_cpu *cpu);
  * @post PC += 2 if VX == Key vaule.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_EX9E(chip8_cpu *cpu);
+chip8_error chip8_opcode_EX9E(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Skip next instruction if current key value != VX.
@@ -267,8 +446,10 @@ void chip8_opcode_EX9E(chip8_cpu *cpu);
  * @post PC += 2 if VX != Key vaule.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_EXA1(chip8_cpu *cpu);
+chip8_error chip8_opcode_EXA1(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store current value of delay timer in VX.
@@ -277,8 +458,10 @@ void chip8_opcode_EXA1(chip8_cpu *cpu);
  * @post VX = delay timer.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX07(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX07(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Wait for key press and store the key value in VX.
@@ -287,8 +470,10 @@ void chip8_opcode_FX07(chip8_cpu *cpu);
  * @post Wait for keypress then VX = key value.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX0A(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX0A(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Set delay timer to the value of register VX.
@@ -297,8 +482,10 @@ void chip8_opcode_FX0A(chip8_cpu *cpu);
  * @post Delay timer = VX.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX15(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX15(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Set sound timer to the value of register VX.
@@ -307,8 +494,10 @@ void chip8_opcode_FX15(chip8_cpu *cpu);
  * @post Sound timer = VX
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX18(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX18(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Add VX to I.
@@ -317,8 +506,10 @@ void chip8_opcode_FX18(chip8_cpu *cpu);
  * @post I = I + VX.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX1E(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX1E(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Set I to the memory address of sprite data corresponding to the
@@ -328,8 +519,23 @@ void chip8_opcode_FX1E(chip8_cpu *cpu);
  * @post I = VX * 0x5.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_FX29(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Set I to the memory address of large 8x10 sprite data
+ *        corresponding to the hex digit in VX.
+ *
+ * @pre cpu must not be NULL.
+ * @post I = #CHIP8_FONT_LARGE + VX * 10.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX29(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX30(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store the BCD of VX in I, I + 1, and I + 2.
@@ -338,8 +544,10 @@ void chip8_opcode_FX29(chip8_cpu *cpu);
  * @post BCD of VX in I, I + 1, and I + 2.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX33(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX33(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Store the values of V0 to VX inclusive in memory starting at I.
@@ -348,8 +556,10 @@ void chip8_opcode_FX33(chip8_cpu *cpu);
  * @post V0...VX in I.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX55(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX55(chip8_cpu *cpu, const chip8_instr *ins);
 
 /**
  * @brief Fill V0 to VX inclusive with values stored at memory starting at I.
@@ -360,7 +570,33 @@ void chip8_opcode_FX55(chip8_cpu *cpu);
  * @post V0...VX from I.
  *
  * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_FX65(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Store the values of V0 to VX inclusive in RPL flags.
+ *
+ * @pre cpu must not be NULL.
+ * @post V0...VX in RPL flags.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_opcode_FX75(chip8_cpu *cpu, const chip8_instr *ins);
+
+/**
+ * @brief Fill V0 to VX inclusive with values stored in RPL flags.
+ *
+ * @pre cpu must not be NULL.
+ * @post V0...VX from RPL flags.
+ *
+ * @param[in,out] cpu CHIP-8 cpu context to process.
+ * @param[in] ins Predecoded instruction to process.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
  */
-void chip8_opcode_FX65(chip8_cpu *cpu);
+chip8_error chip8_opcode_FX85(chip8_cpu *cpu, const chip8_instr *ins);
 
 #endif /* CHIP8_OPCODE_H */
@@ -0,0 +1,403 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/pool.h"
+#include "core/video.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_POOL_SLICE 4096 /**< Cycles run before rescheduling machine. */
+
+/**
+ * @brief Deque of machine indices owned by a worker.
+ *
+ * @note Ring buffer holding items from #head to #tail, the owner works at the
+ *       tail end while thieves take from the head end.
+ */
+typedef struct {
+	pthread_mutex_t lock; /**< Guards every other member. */
+	size_t *slots;        /**< Ring of machine indices. */
+	size_t size;          /**< Capacity of ring. */
+	size_t head;          /**< Oldest item, stolen first. */
+	size_t tail;          /**< One past newest item. */
+} chip8_pool_deque;
+
+/**
+ * @brief Worker thread of pool.
+ */
+typedef struct {
+	chip8_pool *pool;       /**< Pool worker belongs to. */
+	pthread_t thread;       /**< Thread of worker. */
+	unsigned int id;        /**< Index of worker in pool. */
+	unsigned long steals;   /**< Slices stolen during current run. */
+	chip8_pool_deque deque; /**< Machines owned by worker. */
+} chip8_pool_worker;
+
+struct chip8_pool {
+	chip8_vm *vms;              /**< Machines of pool. */
+	size_t size;                /**< Amount of machines. */
+	chip8_pool_worker *workers; /**< Workers of pool. */
+	unsigned int threads;       /**< Amount of workers. */
+	unsigned int started;       /**< Amount of workers running. */
+	pthread_mutex_t lock;       /**< Guards generation and quit. */
+	pthread_cond_t wake;        /**< Signals new run or quit to workers. */
+	pthread_cond_t done;        /**< Signals end of run to caller. */
+	unsigned long generation;   /**< Current run number. */
+	bool quit;                  /**< Workers must exit. */
+	unsigned long cycles;       /**< Cycles every machine runs this run. */
+	size_t remaining;           /**< Machines not done, accessed atomically. */
+};
+
+/**
+ * @brief Push machine onto tail of deque.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_pool_push(chip8_pool_deque *deque, size_t index)
+{
+	pthread_mutex_lock(&deque->lock);
+	deque->slots[deque->tail % deque->size] = index;
+	deque->tail++;
+	pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+ * @brief Pop machine from tail of deque.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @return True if a machine was popped, false if deque is empty.
+ */
+static bool chip8_pool_pop(chip8_pool_deque *deque, size_t *index)
+{
+	bool found = false;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->head != deque->tail) {
+		deque->tail--;
+		*index = deque->slots[deque->tail % deque->size];
+		found = true;
+	}
+	pthread_mutex_unlock(&deque->lock);
+	return found;
+}
+
+/**
+ * @brief Take machine from head of deque of another worker.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @return True if a machine was stolen, false if every other deque is empty.
+ */
+static bool chip8_pool_steal(chip8_pool_worker *worker, size_t *index)
+{
+	chip8_pool *pool = worker->pool;
+	chip8_pool_deque *victim = NULL;
+	bool found = false;
+
+	for (unsigned int n = 1; n < pool->threads && !found; n++) {
+		victim = &pool->workers[(worker->id + n) % pool->threads].deque;
+		pthread_mutex_lock(&victim->lock);
+		if (victim->head != victim->tail) {
+			*index = victim->slots[victim->head % victim->size];
+			victim->head++;
+			found = true;
+		}
+		pthread_mutex_unlock(&victim->lock);
+	}
+
+	if (found)
+		worker->steals++;
+	return found;
+}
+
+/**
+ * @brief Run a slice of a machine.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @return True if machine has cycles left, false if it is done.
+ */
+static bool chip8_pool_slice(chip8_pool *pool, chip8_vm *vm)
+{
+	unsigned long left = pool->cycles - vm->ran;
+	unsigned long ran = 0;
+
+	if (left > CHIP8_POOL_SLICE)
+		left = CHIP8_POOL_SLICE;
+
+	while (left != 0 && vm->status == CHIP8_EOK) {
+		vm->status = chip8_cpu_run(vm->cpu, left, &ran);
+		vm->ran += ran;
+		left -= ran;
+	}
+	return vm->status == CHIP8_EOK && vm->ran < pool->cycles;
+}
+
+/**
+ * @brief Work on machines until every machine of current run is done.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_pool_work(chip8_pool_worker *worker)
+{
+	chip8_pool *pool = worker->pool;
+	size_t index = 0;
+
+	while (__atomic_load_n(&pool->remaining, __ATOMIC_ACQUIRE) != 0) {
+		if (!chip8_pool_pop(&worker->deque, &index) &&
+		    !chip8_pool_steal(worker, &index)) {
+			sched_yield();
+			continue;
+		}
+
+		if (chip8_pool_slice(pool, &pool->vms[index])) {
+			chip8_pool_push(&worker->deque, index);
+			continue;
+		}
+
+		/* Last machine done, so wake up caller... */
+		if (__atomic_sub_fetch(&pool->remaining, 1,
+				       __ATOMIC_ACQ_REL) == 0) {
+			pthread_mutex_lock(&pool->lock);
+			pthread_cond_broadcast(&pool->done);
+			pthread_mutex_unlock(&pool->lock);
+		}
+	}
+}
+
+/**
+ * @brief Starting point of worker threads.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void *chip8_pool_main(void *arg)
+{
+	chip8_pool_worker *worker = arg;
+	chip8_pool *pool = worker->pool;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (!pool->quit && pool->generation == seen)
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		if (pool->quit)
+			break;
+
+		seen = pool->generation;
+		pthread_mutex_unlock(&pool->lock);
+		chip8_pool_work(worker);
+		pthread_mutex_lock(&pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+/**
+ * @brief Create CPU, video, and keypad of machine.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_pool_vminit(chip8_vm *vm)
+{
+	chip8_error flag = CHIP8_EOK;
+
+	flag = chip8_video_init(&vm->video);
+	if (flag != CHIP8_EOK)
+		return flag;
+
+	flag = chip8_keypad_init(&vm->keypad);
+	if (flag != CHIP8_EOK)
+		return flag;
+
+	vm->status = CHIP8_EOK;
+	vm->ran = 0;
+	return chip8_cpu_init(&vm->cpu, vm->video, vm->keypad, 0);
+}
+
+chip8_error chip8_pool_init(chip8_pool **pool, size_t vms,
+		            unsigned int threads)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_pool *newpool = NULL;
+	long cores = 0;
+
+	if (pool == NULL || vms == 0)
+		return CHIP8_EINVAL;
+
+	if (threads == 0) {
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cores > 0) ? cores : 1;
+	}
+
+	newpool = calloc(1, sizeof *newpool);
+	if (newpool == NULL)
+		return CHIP8_ENOMEM;
+
+	pthread_mutex_init(&newpool->lock, NULL);
+	pthread_cond_init(&newpool->wake, NULL);
+	pthread_cond_init(&newpool->done, NULL);
+	newpool->size = vms;
+	newpool->threads = threads;
+	newpool->vms = calloc(vms, sizeof *newpool->vms);
+	newpool->workers = calloc(threads, sizeof *newpool->workers);
+	if (newpool->vms == NULL || newpool->workers == NULL) {
+		newpool->threads = 0;
+		flag = CHIP8_ENOMEM;
+		goto error;
+	}
+
+	for (unsigned int id = 0; id < threads; id++) {
+		chip8_pool_worker *worker = &newpool->workers[id];
+
+		worker->pool = newpool;
+		worker->id = id;
+		worker->deque.size = vms;
+		pthread_mutex_init(&worker->deque.lock, NULL);
+	}
+
+	for (unsigned int id = 0; id < threads; id++) {
+		chip8_pool_deque *deque = &newpool->workers[id].deque;
+
+		deque->slots = malloc(vms * sizeof *deque->slots);
+		if (deque->slots == NULL) {
+			flag = CHIP8_ENOMEM;
+			goto error;
+		}
+	}
+
+	for (size_t vm = 0; vm < vms; vm++) {
+		flag = chip8_pool_vminit(&newpool->vms[vm]);
+		if (flag != CHIP8_EOK)
+			goto error;
+	}
+
+	for (unsigned int id = 0; id < threads; id++) {
+		if (pthread_create(&newpool->workers[id].thread, NULL,
+				   chip8_pool_main,
+				   &newpool->workers[id]) != 0) {
+			flag = CHIP8_ENOMEM;
+			goto error;
+		}
+		newpool->started++;
+	}
+
+	*pool = newpool;
+	chip8_debugx("setup pool of %zu machines on %u threads\n", vms,
+		     threads);
+	goto done;
+error:
+	chip8_pool_free(newpool);
+	newpool = NULL;
+done:
+	return flag;
+}
+
+chip8_vm *chip8_pool_vm(chip8_pool *pool, size_t index)
+{
+	if (pool == NULL || index >= pool->size)
+		return NULL;
+	return &pool->vms[index];
+}
+
+size_t chip8_pool_size(const chip8_pool *pool)
+{
+	return pool->size;
+}
+
+unsigned int chip8_pool_threads(const chip8_pool *pool)
+{
+	return pool->threads;
+}
+
+chip8_error chip8_pool_run(chip8_pool *pool, unsigned long cycles,
+		           chip8_pool_stats *stats)
+{
+	chip8_error flag = CHIP8_EOK;
+	uint64_t start = 0;
+	uint64_t total = 0;
+	unsigned long steals = 0;
+
+	if (pool == NULL)
+		return CHIP8_EINVAL;
+
+	/* Hand out machines round robin, workers balance the rest... */
+	for (unsigned int id = 0; id < pool->threads; id++)
+		pool->workers[id].steals = 0;
+	for (size_t vm = 0; vm < pool->size; vm++) {
+		pool->vms[vm].ran = 0;
+		pool->vms[vm].status = CHIP8_EOK;
+		chip8_pool_push(&pool->workers[vm % pool->threads].deque, vm);
+	}
+
+	start = chip8_now();
+	pthread_mutex_lock(&pool->lock);
+	pool->cycles = cycles;
+	__atomic_store_n(&pool->remaining, pool->size, __ATOMIC_RELEASE);
+	pool->generation++;
+	pthread_cond_broadcast(&pool->wake);
+	while (__atomic_load_n(&pool->remaining, __ATOMIC_ACQUIRE) != 0)
+		pthread_cond_wait(&pool->done, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (size_t vm = 0; vm < pool->size; vm++) {
+		total += pool->vms[vm].ran;
+		if (flag == CHIP8_EOK)
+			flag = pool->vms[vm].status;
+	}
+	for (unsigned int id = 0; id < pool->threads; id++)
+		steals += pool->workers[id].steals;
+
+	if (stats != NULL) {
+		stats->instructions = total;
+		stats->seconds = (chip8_now() - start) / 1e9;
+		stats->ips = (stats->seconds > 0.0) ?
+			     total / stats->seconds : 0.0;
+		stats->steals = steals;
+	}
+	return flag;
+}
+
+void chip8_pool_free(chip8_pool *pool)
+{
+	if (pool == NULL)
+		return;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->quit = true;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	for (unsigned int id = 0; id < pool->started; id++)
+		pthread_join(pool->workers[id].thread, NULL);
+
+	for (size_t vm = 0; pool->vms != NULL && vm < pool->size; vm++) {
+		chip8_cpu_free(pool->vms[vm].cpu);
+		chip8_keypad_free(pool->vms[vm].keypad);
+		chip8_video_free(pool->vms[vm].video);
+	}
+
+	for (unsigned int id = 0; pool->workers != NULL &&
+	     id < pool->threads; id++) {
+		free(pool->workers[id].deque.slots);
+		pthread_mutex_destroy(&pool->workers[id].deque.lock);
+	}
+
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->wake);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->vms);
+	free(pool->workers);
+	free(pool);
+	chip8_debug("free CHIP-8 pool");
+}
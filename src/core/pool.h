@@ -0,0 +1,124 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_POOL_H
+#define CHIP8_CORE_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/video.h"
+#include "utils/error.h"
+
+/**
+ * @brief Independent CHIP-8 machine owned by a pool.
+ *
+ * @note Every machine has its own CPU, video, and keypad, so machines never
+ *       share state and can run on any thread.
+ */
+typedef struct {
+	chip8_cpu *cpu;       /**< CPU of machine. */
+	chip8_video *video;   /**< Video of machine. */
+	chip8_keypad *keypad; /**< Keypad of machine. */
+	unsigned long ran;    /**< Cycles run during last pool run. */
+	chip8_error status;   /**< Result of last pool run. */
+} chip8_vm;
+
+/**
+ * @brief Statistics of a single pool run.
+ */
+typedef struct {
+	uint64_t instructions; /**< Instructions run by every machine. */
+	double seconds;        /**< Wall-clock time of run. */
+	double ips;            /**< Aggregate instructions per second. */
+	unsigned long steals;  /**< Slices stolen from other workers. */
+} chip8_pool_stats;
+
+/**
+ * @brief Pool of CHIP-8 machines run by a work-stealing thread pool.
+ *
+ * @note Every worker owns a deque of machines. Workers run a slice of the
+ *       machine at the bottom of their own deque and push it back if it has
+ *       cycles left, and steal from the top of other deques once their own
+ *       runs dry.
+ */
+typedef struct chip8_pool chip8_pool;
+
+/**
+ * @brief Create a new pool of machines and start its workers.
+ *
+ * @note Set threads to 0 to use one worker per online CPU core.
+ *
+ * @pre pool cannot be NULL.
+ * @pre vms cannot be 0.
+ * @post pool will hold vms reset machines with empty RAM besides the font.
+ *
+ * @param[in,out] pool Pool to initialize.
+ * @param[in] vms Amount of machines to create.
+ * @param[in] threads Amount of worker threads to start.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_pool_init(chip8_pool **pool, size_t vms,
+		            unsigned int threads);
+
+/**
+ * @brief Get machine of pool.
+ *
+ * @note Machines may only be touched while the pool is not running.
+ *
+ * @pre pool cannot be NULL.
+ *
+ * @param[in] pool Pool to get machine of.
+ * @param[in] index Index of machine.
+ * @return Machine at index, NULL if index is out of range.
+ */
+chip8_vm *chip8_pool_vm(chip8_pool *pool, size_t index);
+
+/**
+ * @brief Get amount of machines in pool.
+ *
+ * @pre pool cannot be NULL.
+ *
+ * @param[in] pool Pool to count machines of.
+ * @return Amount of machines.
+ */
+size_t chip8_pool_size(const chip8_pool *pool);
+
+/**
+ * @brief Get amount of worker threads in pool.
+ *
+ * @pre pool cannot be NULL.
+ *
+ * @param[in] pool Pool to count workers of.
+ * @return Amount of worker threads.
+ */
+unsigned int chip8_pool_threads(const chip8_pool *pool);
+
+/**
+ * @brief Run every machine of pool for some cycles.
+ *
+ * @note Blocks until every machine ran all its cycles or failed, see
+ *       #chip8_vm->status for the result of each machine.
+ *
+ * @pre pool cannot be NULL.
+ * @post Every machine will be advanced by cycles on its virtual clock.
+ *
+ * @param[in,out] pool Pool to run.
+ * @param[in] cycles Cycles to run every machine for.
+ * @param[out] stats Statistics of run, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_pool_run(chip8_pool *pool, unsigned long cycles,
+		           chip8_pool_stats *stats);
+
+/**
+ * @brief Stop workers and free every machine of pool.
+ *
+ * @param[in,out] pool Pool to free, may be NULL.
+ */
+void chip8_pool_free(chip8_pool *pool);
+
+#endif /* CHIP8_CORE_POOL_H */
@@ -0,0 +1,246 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/cpu.h"
+#include "core/decode.h"
+#include "core/opcode.h"
+#include "core/prof.h"
+#include "core/trace.h"
+#include "utils/error.h"
+
+#define CHIP8_PROF_NAME(op) [CHIP8_OP_##op] = #op,
+
+/**
+ * @brief Name of every instruction.
+ */
+static const char *const chip8_prof_names[CHIP8_OP_COUNT] = {
+	[CHIP8_OP_BAD] = "bad",
+	CHIP8_PROF_NAME(00CN) CHIP8_PROF_NAME(00E0) CHIP8_PROF_NAME(00EE)
+	CHIP8_PROF_NAME(00FB) CHIP8_PROF_NAME(00FC) CHIP8_PROF_NAME(00FE)
+	CHIP8_PROF_NAME(00FF) CHIP8_PROF_NAME(1NNN) CHIP8_PROF_NAME(2NNN)
+	CHIP8_PROF_NAME(3XNN) CHIP8_PROF_NAME(4XNN) CHIP8_PROF_NAME(5XY0)
+	CHIP8_PROF_NAME(6XNN) CHIP8_PROF_NAME(7XNN) CHIP8_PROF_NAME(8XY0)
+	CHIP8_PROF_NAME(8XY1) CHIP8_PROF_NAME(8XY2) CHIP8_PROF_NAME(8XY3)
+	CHIP8_PROF_NAME(8XY4) CHIP8_PROF_NAME(8XY5) CHIP8_PROF_NAME(8XY6)
+	CHIP8_PROF_NAME(8XY7) CHIP8_PROF_NAME(8XYE) CHIP8_PROF_NAME(9XY0)
+	CHIP8_PROF_NAME(ANNN) CHIP8_PROF_NAME(BNNN) CHIP8_PROF_NAME(CXNN)
+	CHIP8_PROF_NAME(DXYN) CHIP8_PROF_NAME(EX9E) CHIP8_PROF_NAME(EXA1)
+	CHIP8_PROF_NAME(FX07) CHIP8_PROF_NAME(FX0A) CHIP8_PROF_NAME(FX15)
+	CHIP8_PROF_NAME(FX18) CHIP8_PROF_NAME(FX1E) CHIP8_PROF_NAME(FX29)
+	CHIP8_PROF_NAME(FX30) CHIP8_PROF_NAME(FX33) CHIP8_PROF_NAME(FX55)
+	CHIP8_PROF_NAME(FX65) CHIP8_PROF_NAME(FX75) CHIP8_PROF_NAME(FX85)
+};
+
+/**
+ * @brief Counter paired with what it counts.
+ */
+typedef struct {
+	uint64_t count; /**< Times key ran. */
+	uint16_t key;   /**< Instruction identifier or address. */
+} chip8_prof_entry;
+
+/**
+ * @brief Order entries busiest first, then by key.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static int chip8_prof_cmp(const void *a, const void *b)
+{
+	const chip8_prof_entry *x = a;
+	const chip8_prof_entry *y = b;
+
+	if (x->count != y->count)
+		return (x->count < y->count) ? 1 : -1;
+	return x->key - y->key;
+}
+
+/**
+ * @brief Sort every non-zero counter into entries.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @return Amount of entries filled.
+ */
+static size_t chip8_prof_sort(const uint64_t *counts, size_t len,
+		              chip8_prof_entry *entries)
+{
+	size_t used = 0;
+
+	for (size_t n = 0; n < len; n++) {
+		if (counts[n] == 0)
+			continue;
+		entries[used].count = counts[n];
+		entries[used].key = n;
+		used++;
+	}
+	qsort(entries, used, sizeof *entries, chip8_prof_cmp);
+	return used;
+}
+
+/**
+ * @brief Total instructions counted by profile.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static uint64_t chip8_prof_total(const chip8_prof *prof)
+{
+	uint64_t total = 0;
+
+	for (int id = 0; id < CHIP8_OP_COUNT; id++)
+		total += prof->ops[id];
+	return total;
+}
+
+chip8_error chip8_prof_init(chip8_prof **prof)
+{
+	chip8_prof *newprof = NULL;
+
+	if (prof == NULL)
+		return CHIP8_EINVAL;
+
+	newprof = calloc(1, sizeof *newprof);
+	if (newprof == NULL)
+		return CHIP8_ENOMEM;
+
+	*prof = newprof;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_prof_clear(chip8_prof *prof)
+{
+	if (prof == NULL)
+		return CHIP8_EINVAL;
+
+	memset(prof, 0, sizeof *prof);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_prof_exec(chip8_prof *prof, chip8_cpu *cpu,
+		            unsigned long budget, unsigned long *ran)
+{
+	chip8_error flag = CHIP8_EOK;
+	const chip8_instr *ins = NULL;
+	chip8_instr slow;
+	unsigned long done = 0;
+	uint16_t opcode = 0;
+	uint16_t pc = 0;
+	uint8_t id = 0;
+
+	if (prof == NULL || cpu == NULL || ran == NULL)
+		return CHIP8_EINVAL;
+
+	while (done < budget && flag == CHIP8_EOK) {
+		ins = chip8_decode_fetch(cpu, &slow);
+		id = ins->id;
+		opcode = ins->opcode;
+		pc = cpu->pc;
+		prof->ops[id]++;
+		prof->pcs[pc & (CHIP8_RAM_SIZE - 1)]++;
+		cpu->opcode = opcode;
+		cpu->pc += 2;
+
+		/* Handler may drop ins from the predecode cache... */
+		flag = ins->handler(cpu, ins);
+		if (cpu->trace != NULL)
+			chip8_trace_push(cpu->trace, cpu, cpu->cycles + done,
+					 pc, opcode);
+		done++;
+		if (id == CHIP8_OP_FX0A)
+			break;
+	}
+
+	*ran = done;
+	return flag;
+}
+
+const char *chip8_prof_opname(chip8_opcode_id id)
+{
+	if (id >= CHIP8_OP_COUNT || chip8_prof_names[id] == NULL)
+		return chip8_prof_names[CHIP8_OP_BAD];
+	return chip8_prof_names[id];
+}
+
+chip8_error chip8_prof_report(const chip8_prof *prof, FILE *file,
+		              unsigned int top)
+{
+	chip8_prof_entry *entries = NULL;
+	uint64_t total = 0;
+	size_t used = 0;
+
+	if (prof == NULL || file == NULL)
+		return CHIP8_EINVAL;
+
+	entries = malloc(CHIP8_RAM_SIZE * sizeof *entries);
+	if (entries == NULL)
+		return CHIP8_ENOMEM;
+
+	total = chip8_prof_total(prof);
+	fprintf(file, "instructions: %llu\nblocked on FX0A: %llu cycles\n\n",
+		(unsigned long long)total, (unsigned long long)prof->blocked);
+
+	fprintf(file, "%-8s %20s %8s\n", "opcode", "count", "share");
+	used = chip8_prof_sort(prof->ops, CHIP8_OP_COUNT, entries);
+	for (size_t n = 0; n < used; n++)
+		fprintf(file, "%-8s %20llu %7.2f%%\n",
+			chip8_prof_opname(entries[n].key),
+			(unsigned long long)entries[n].count,
+			entries[n].count * 100.0 / total);
+
+	fprintf(file, "\n%-8s %20s %8s\n", "pc", "count", "share");
+	used = chip8_prof_sort(prof->pcs, CHIP8_RAM_SIZE, entries);
+	if (top != 0 && used > top)
+		used = top;
+	for (size_t n = 0; n < used; n++)
+		fprintf(file, "0x%03X    %20llu %7.2f%%\n", entries[n].key,
+			(unsigned long long)entries[n].count,
+			entries[n].count * 100.0 / total);
+
+	free(entries);
+	return ferror(file) ? CHIP8_EIO : CHIP8_EOK;
+}
+
+chip8_error chip8_prof_json(const chip8_prof *prof, FILE *file)
+{
+	chip8_prof_entry *entries = NULL;
+	size_t used = 0;
+
+	if (prof == NULL || file == NULL)
+		return CHIP8_EINVAL;
+
+	entries = malloc(CHIP8_RAM_SIZE * sizeof *entries);
+	if (entries == NULL)
+		return CHIP8_ENOMEM;
+
+	fprintf(file, "{\n  \"instructions\": %llu,\n  \"blocked\": %llu,\n"
+		"  \"ops\": [\n",
+		(unsigned long long)chip8_prof_total(prof),
+		(unsigned long long)prof->blocked);
+	used = chip8_prof_sort(prof->ops, CHIP8_OP_COUNT, entries);
+	for (size_t n = 0; n < used; n++)
+		fprintf(file, "    {\"op\": \"%s\", \"count\": %llu}%s\n",
+			chip8_prof_opname(entries[n].key),
+			(unsigned long long)entries[n].count,
+			(n + 1 < used) ? "," : "");
+
+	fprintf(file, "  ],\n  \"pcs\": [\n");
+	used = chip8_prof_sort(prof->pcs, CHIP8_RAM_SIZE, entries);
+	for (size_t n = 0; n < used; n++)
+		fprintf(file, "    {\"pc\": %u, \"count\": %llu}%s\n",
+			entries[n].key, (unsigned long long)entries[n].count,
+			(n + 1 < used) ? "," : "");
+	fprintf(file, "  ]\n}\n");
+
+	free(entries);
+	return ferror(file) ? CHIP8_EIO : CHIP8_EOK;
+}
+
+void chip8_prof_free(chip8_prof *prof)
+{
+	free(prof);
+}
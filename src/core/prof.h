@@ -0,0 +1,116 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_PROF_H
+#define CHIP8_CORE_PROF_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "core/cpu.h"
+#include "core/opcode.h"
+#include "utils/error.h"
+
+/**
+ * @brief Execution profile of a CHIP-8 CPU.
+ *
+ * @note Attach with #chip8_cpu_setprof(). While attached, the CPU runs every
+ *       instruction through #chip8_prof_exec() instead of the JIT or the
+ *       regular interpreter, which also feeds any attached trace. A CPU
+ *       without a profiler never looks at any of this past a single pointer
+ *       check per batch of instructions.
+ */
+typedef struct chip8_prof {
+	uint64_t ops[CHIP8_OP_COUNT]; /**< Executions per instruction. */
+	uint64_t pcs[CHIP8_RAM_SIZE]; /**< Executions per address. */
+	uint64_t blocked;             /**< Cycles spent blocked on FX0A. */
+} chip8_prof;
+
+/**
+ * @brief Create a new empty profile.
+ *
+ * @pre prof cannot be NULL.
+ *
+ * @param[in,out] prof Profile to initialize.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_prof_init(chip8_prof **prof);
+
+/**
+ * @brief Reset every counter of profile to zero.
+ *
+ * @pre prof cannot be NULL.
+ *
+ * @param[in,out] prof Profile to clear.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_prof_clear(chip8_prof *prof);
+
+/**
+ * @brief Interpret a batch of instructions, counting each one.
+ *
+ * @note Profiling variant of #chip8_interp_exec(), with the same rules for
+ *       ending a batch early.
+ *
+ * @pre prof, cpu and ran cannot be NULL.
+ * @pre Keypad of cpu must not be locked.
+ * @post cpu state will be updated by every instruction executed.
+ *
+ * @param[in,out] prof Profile to count into.
+ * @param[in,out] cpu CHIP-8 CPU context to execute.
+ * @param[in] budget Maximum amount of instructions to execute.
+ * @param[out] ran Amount of instructions executed.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_prof_exec(chip8_prof *prof, chip8_cpu *cpu,
+		            unsigned long budget, unsigned long *ran);
+
+/**
+ * @brief Get name of an instruction, such as "DXYN".
+ *
+ * @param[in] id Instruction identifier to name.
+ * @return Name of instruction, "bad" for invalid identifiers.
+ */
+const char *chip8_prof_opname(chip8_opcode_id id);
+
+/**
+ * @brief Write profile as a human readable report.
+ *
+ * @note Instructions and addresses are sorted by how often they ran, the
+ *       busiest first.
+ *
+ * @pre prof and file cannot be NULL.
+ *
+ * @param[in] prof Profile to report.
+ * @param[in,out] file File to write report to.
+ * @param[in] top Most addresses to list, 0 to list every address that ran.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_prof_report(const chip8_prof *prof, FILE *file,
+		              unsigned int top);
+
+/**
+ * @brief Write profile as JSON.
+ *
+ * @note Holds the same sorted instructions and addresses as
+ *       #chip8_prof_report(), leaving out anything that never ran.
+ *
+ * @pre prof and file cannot be NULL.
+ *
+ * @param[in] prof Profile to write.
+ * @param[in,out] file File to write JSON to.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_prof_json(const chip8_prof *prof, FILE *file);
+
+/**
+ * @brief Free profile.
+ *
+ * @pre Profile must not be attached to any CPU.
+ *
+ * @param[in,out] prof Profile to free, may be NULL.
+ */
+void chip8_prof_free(chip8_prof *prof);
+
+#endif /* CHIP8_CORE_PROF_H */
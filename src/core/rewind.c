@@ -0,0 +1,402 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/cpu.h"
+#include "core/rewind.h"
+#include "core/state.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_REWIND_RUN      4  /**< Equal bytes that end a literal run. */
+#define CHIP8_REWIND_SEGMENTS 16 /**< Initial capacity of segment ring. */
+
+/** Worst case size of a delta, every literal run costing two varints. */
+#define CHIP8_REWIND_DELTA_MAX (2 * CHIP8_STATE_SIZE + 8)
+
+/**
+ * @brief Keyframe followed by the deltas of the frames after it.
+ */
+typedef struct {
+	uint8_t *data;       /**< Encoded frames. */
+	size_t len;          /**< Bytes of data used. */
+	size_t cap;          /**< Bytes of data allocated. */
+	uint32_t *ends;      /**< End of every frame in data. */
+	unsigned int frames; /**< Frames held. */
+} chip8_rewind_seg;
+
+struct chip8_rewind {
+	chip8_rewind_seg *segs;   /**< Ring of segments. */
+	size_t nsegs;             /**< Segments held. */
+	size_t capsegs;           /**< Capacity of segment ring. */
+	size_t oldest;            /**< Ring slot of oldest segment. */
+	size_t budget;            /**< Bytes frames may take up. */
+	size_t bytes;             /**< Bytes allocated for frames. */
+	unsigned int interval;    /**< Frames between keyframes. */
+	uint64_t frames;          /**< Frames held. */
+	uint64_t tick;            /**< Timer tick of newest frame. */
+	uint64_t carry;           /**< Nanoseconds not yet rewound. */
+	chip8_state state;        /**< Scratch snapshot. */
+	uint8_t last[CHIP8_STATE_SIZE];         /**< Newest frame. */
+	uint8_t next[CHIP8_STATE_SIZE];         /**< Frame being recorded. */
+	uint8_t delta[CHIP8_REWIND_DELTA_MAX];  /**< Delta being recorded. */
+};
+
+/* Keyframes are deltas against nothing at all. */
+static const uint8_t CHIP8_REWIND_ZERO[CHIP8_STATE_SIZE];
+
+/**
+ * @brief Encode XOR of two frames as runs of skipped and literal bytes.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @param[in] prev Frame before.
+ * @param[in] cur Frame after.
+ * @param[out] out Delta, at least #CHIP8_REWIND_DELTA_MAX bytes.
+ * @return Size of delta.
+ */
+static size_t chip8_rewind_diff(const uint8_t *prev, const uint8_t *cur,
+		                uint8_t *out)
+{
+	uint8_t *at = out;
+	size_t pos = 0;
+	size_t skip = 0;
+	size_t start = 0;
+	size_t same = 0;
+
+	while (pos < CHIP8_STATE_SIZE) {
+		skip = pos;
+		while (pos < CHIP8_STATE_SIZE && prev[pos] == cur[pos])
+			pos++;
+		if (pos == CHIP8_STATE_SIZE)
+			break;
+		skip = pos - skip;
+
+		/* Short stretches of equal bytes are cheaper kept literal... */
+		for (start = pos; pos < CHIP8_STATE_SIZE; pos += same + 1) {
+			for (same = 0; pos + same < CHIP8_STATE_SIZE &&
+			     same < CHIP8_REWIND_RUN &&
+			     prev[pos + same] == cur[pos + same]; same++)
+				;
+			if (same == CHIP8_REWIND_RUN ||
+			    pos + same == CHIP8_STATE_SIZE)
+				break;
+		}
+
+		chip8_putvar(&at, skip);
+		chip8_putvar(&at, pos - start);
+		for (size_t n = start; n < pos; n++)
+			*at++ = prev[n] ^ cur[n];
+	}
+	return at - out;
+}
+
+/**
+ * @brief Apply delta made by chip8_rewind_diff() to frame.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_rewind_patch(uint8_t *frame, const uint8_t *delta,
+		               size_t len)
+{
+	const uint8_t *end = delta + len;
+	size_t pos = 0;
+	size_t run = 0;
+
+	while (delta < end) {
+		pos += chip8_getvar(&delta, end);
+		run = chip8_getvar(&delta, end);
+		while (run-- != 0)
+			frame[pos++] ^= *delta++;
+	}
+}
+
+/**
+ * @brief Get segment of rewind buffer, 0 being the oldest.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_rewind_seg *chip8_rewind_seg_at(const chip8_rewind *rewind,
+		                             size_t index)
+{
+	return &rewind->segs[(rewind->oldest + index) % rewind->capsegs];
+}
+
+/**
+ * @brief Free segment and give its bytes back to the budget.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_rewind_seg_free(chip8_rewind *rewind, chip8_rewind_seg *seg)
+{
+	rewind->bytes -= seg->cap + rewind->interval * sizeof *seg->ends;
+	rewind->frames -= seg->frames;
+	free(seg->data);
+	free(seg->ends);
+	memset(seg, 0, sizeof *seg);
+}
+
+/**
+ * @brief Start new segment after the newest one.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_rewind_seg_new(chip8_rewind *rewind)
+{
+	chip8_rewind_seg *segs = NULL;
+	chip8_rewind_seg *seg = NULL;
+	size_t cap = rewind->capsegs * 2;
+
+	/* Unroll ring into a bigger one... */
+	if (rewind->nsegs == rewind->capsegs) {
+		segs = calloc(cap, sizeof *segs);
+		if (segs == NULL)
+			return CHIP8_ENOMEM;
+
+		for (size_t n = 0; n < rewind->nsegs; n++)
+			segs[n] = *chip8_rewind_seg_at(rewind, n);
+		free(rewind->segs);
+		rewind->segs = segs;
+		rewind->bytes += (cap - rewind->capsegs) * sizeof *segs;
+		rewind->capsegs = cap;
+		rewind->oldest = 0;
+	}
+
+	seg = chip8_rewind_seg_at(rewind, rewind->nsegs);
+	seg->ends = malloc(rewind->interval * sizeof *seg->ends);
+	if (seg->ends == NULL)
+		return CHIP8_ENOMEM;
+	rewind->bytes += rewind->interval * sizeof *seg->ends;
+	rewind->nsegs++;
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Append encoded frame to newest segment.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_rewind_seg_push(chip8_rewind *rewind,
+		                         const uint8_t *frame, size_t len)
+{
+	chip8_rewind_seg *seg = chip8_rewind_seg_at(rewind, rewind->nsegs - 1);
+	uint8_t *data = NULL;
+	size_t cap = (seg->cap != 0) ? seg->cap : CHIP8_STATE_SIZE;
+
+	while (seg->len + len > cap)
+		cap *= 2;
+
+	if (cap != seg->cap) {
+		data = realloc(seg->data, cap);
+		if (data == NULL)
+			return CHIP8_ENOMEM;
+		rewind->bytes += cap - seg->cap;
+		seg->data = data;
+		seg->cap = cap;
+	}
+
+	memcpy(seg->data + seg->len, frame, len);
+	seg->len += len;
+	seg->ends[seg->frames++] = seg->len;
+	rewind->frames++;
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Decode frame into encoded save state.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @pre frame must be less than the amount of frames held.
+ */
+static void chip8_rewind_frame(const chip8_rewind *rewind, uint64_t frame,
+		               uint8_t *buffer)
+{
+	/* Every segment but the newest is full... */
+	const chip8_rewind_seg *seg =
+		chip8_rewind_seg_at(rewind, frame / rewind->interval);
+	size_t start = 0;
+
+	memset(buffer, 0, CHIP8_STATE_SIZE);
+	for (unsigned int n = 0; n <= frame % rewind->interval; n++) {
+		chip8_rewind_patch(buffer, seg->data + start,
+				   seg->ends[n] - start);
+		start = seg->ends[n];
+	}
+}
+
+chip8_error chip8_rewind_init(chip8_rewind **rewind, size_t budget,
+		              unsigned int interval)
+{
+	chip8_rewind *newrw = NULL;
+
+	if (rewind == NULL)
+		return CHIP8_EINVAL;
+
+	newrw = calloc(1, sizeof *newrw);
+	if (newrw == NULL)
+		return CHIP8_ENOMEM;
+
+	newrw->segs = calloc(CHIP8_REWIND_SEGMENTS, sizeof *newrw->segs);
+	if (newrw->segs == NULL) {
+		free(newrw);
+		return CHIP8_ENOMEM;
+	}
+
+	newrw->capsegs = CHIP8_REWIND_SEGMENTS;
+	newrw->bytes = CHIP8_REWIND_SEGMENTS * sizeof *newrw->segs;
+	newrw->budget = (budget != 0) ? budget : CHIP8_REWIND_BUDGET;
+	newrw->interval = (interval != 0) ? interval : CHIP8_REWIND_INTERVAL;
+	*rewind = newrw;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_rewind_push(chip8_rewind *rewind, const chip8_cpu *cpu)
+{
+	chip8_error flag = CHIP8_EOK;
+	const chip8_rewind_seg *seg = NULL;
+	size_t len = 0;
+
+	if (rewind == NULL || cpu == NULL)
+		return CHIP8_EINVAL;
+
+	if (rewind->frames != 0 && cpu->timer_count == rewind->tick)
+		return CHIP8_EOK;
+
+	flag = chip8_state_snap(cpu, &rewind->state);
+	if (flag != CHIP8_EOK)
+		return flag;
+	chip8_state_encode(&rewind->state, rewind->next, sizeof rewind->next);
+
+	if (rewind->nsegs != 0)
+		seg = chip8_rewind_seg_at(rewind, rewind->nsegs - 1);
+
+	if (seg == NULL || seg->frames == rewind->interval) {
+		flag = chip8_rewind_seg_new(rewind);
+		if (flag != CHIP8_EOK)
+			return flag;
+		len = chip8_rewind_diff(CHIP8_REWIND_ZERO, rewind->next,
+					rewind->delta);
+	} else {
+		len = chip8_rewind_diff(rewind->last, rewind->next,
+					rewind->delta);
+	}
+
+	flag = chip8_rewind_seg_push(rewind, rewind->delta, len);
+	if (flag != CHIP8_EOK)
+		return flag;
+	memcpy(rewind->last, rewind->next, sizeof rewind->last);
+	rewind->tick = cpu->timer_count;
+
+	/* Newest segment always stays, even if it alone is over budget... */
+	while (rewind->bytes > rewind->budget && rewind->nsegs > 1) {
+		chip8_rewind_seg_free(rewind, chip8_rewind_seg_at(rewind, 0));
+		rewind->oldest = (rewind->oldest + 1) % rewind->capsegs;
+		rewind->nsegs--;
+	}
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_rewind_seek(const chip8_rewind *rewind, uint64_t frame,
+		              chip8_state *state)
+{
+	uint8_t buffer[CHIP8_STATE_SIZE];
+
+	if (rewind == NULL || state == NULL || frame >= rewind->frames)
+		return CHIP8_EINVAL;
+
+	chip8_rewind_frame(rewind, frame, buffer);
+	return chip8_state_decode(state, buffer, sizeof buffer);
+}
+
+chip8_error chip8_rewind_back(chip8_rewind *rewind, chip8_cpu *cpu,
+		              uint64_t frames)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_rewind_seg *seg = NULL;
+	unsigned int drop = 0;
+
+	if (rewind == NULL || cpu == NULL || frames >= rewind->frames)
+		return CHIP8_EINVAL;
+
+	while (frames != 0) {
+		seg = chip8_rewind_seg_at(rewind, rewind->nsegs - 1);
+		drop = (frames < seg->frames) ? frames : seg->frames;
+		frames -= drop;
+
+		if (drop == seg->frames) {
+			chip8_rewind_seg_free(rewind, seg);
+			rewind->nsegs--;
+			continue;
+		}
+
+		seg->frames -= drop;
+		seg->len = seg->ends[seg->frames - 1];
+		rewind->frames -= drop;
+	}
+
+	chip8_rewind_frame(rewind, rewind->frames - 1, rewind->last);
+	flag = chip8_state_decode(&rewind->state, rewind->last,
+				  sizeof rewind->last);
+	if (flag != CHIP8_EOK)
+		return flag;
+
+	rewind->tick = rewind->state.timer_count;
+	return chip8_state_restore(cpu, &rewind->state);
+}
+
+chip8_error chip8_rewind_cycle(chip8_rewind *rewind, chip8_cpu *cpu)
+{
+	uint64_t now = 0;
+	uint64_t frames = 0;
+
+	if (rewind == NULL || cpu == NULL)
+		return CHIP8_EINVAL;
+
+	now = chip8_now();
+	rewind->carry += now - cpu->ticks;
+	cpu->ticks = now;
+
+	frames = rewind->carry / CHIP8_FRAME_NS;
+	rewind->carry %= CHIP8_FRAME_NS;
+	if (frames == 0 || rewind->frames == 0)
+		return CHIP8_EOK;
+
+	/* Hold on to oldest frame once there is nothing further back... */
+	if (frames >= rewind->frames)
+		frames = rewind->frames - 1;
+	chip8_debugx("rewind %lu frames\n", (unsigned long)frames);
+	return chip8_rewind_back(rewind, cpu, frames);
+}
+
+chip8_error chip8_rewind_stat(const chip8_rewind *rewind,
+		              chip8_rewind_stats *stats)
+{
+	if (rewind == NULL || stats == NULL)
+		return CHIP8_EINVAL;
+
+	stats->frames = rewind->frames;
+	stats->keyframes = rewind->nsegs;
+	stats->bytes = rewind->bytes;
+	return CHIP8_EOK;
+}
+
+void chip8_rewind_free(chip8_rewind *rewind)
+{
+	if (rewind == NULL)
+		return;
+
+	while (rewind->nsegs != 0) {
+		rewind->nsegs--;
+		chip8_rewind_seg_free(rewind,
+				      chip8_rewind_seg_at(rewind, rewind->nsegs));
+	}
+	free(rewind->segs);
+	free(rewind);
+}
@@ -0,0 +1,138 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_REWIND_H
+#define CHIP8_CORE_REWIND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/cpu.h"
+#include "core/state.h"
+#include "utils/error.h"
+
+#define CHIP8_REWIND_BUDGET   (8u << 20) /**< Default memory budget. */
+#define CHIP8_REWIND_INTERVAL 60         /**< Default keyframe interval. */
+
+/**
+ * @brief Memory use of a rewind buffer.
+ */
+typedef struct {
+	uint64_t frames;    /**< Frames held. */
+	uint64_t keyframes; /**< Frames held in full. */
+	size_t bytes;       /**< Bytes allocated for frames. */
+} chip8_rewind_stats;
+
+/**
+ * @brief Rewind buffer of recent frames of a CHIP-8 machine.
+ *
+ * @note Frames are held as encoded save states. Every interval frames a
+ *       keyframe starts a new segment, and every other frame only holds the
+ *       run-length encoded XOR against the frame before it, which is mostly
+ *       zero. Whole segments are dropped oldest first once the memory budget
+ *       is used up.
+ */
+typedef struct chip8_rewind chip8_rewind;
+
+/**
+ * @brief Create a new empty rewind buffer.
+ *
+ * @note Set budget to 0 to use #CHIP8_REWIND_BUDGET, and interval to 0 to use
+ *       #CHIP8_REWIND_INTERVAL.
+ *
+ * @pre rewind cannot be NULL.
+ *
+ * @param[in,out] rewind Rewind buffer to initialize.
+ * @param[in] budget Bytes frames may take up.
+ * @param[in] interval Frames between keyframes.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_rewind_init(chip8_rewind **rewind, size_t budget,
+		              unsigned int interval);
+
+/**
+ * @brief Record current frame of CHIP-8 machine.
+ *
+ * @note Only one frame is recorded per 60Hz timer tick, so this can be called
+ *       as often as the machine is run.
+ *
+ * @pre rewind and cpu cannot be NULL.
+ *
+ * @param[in,out] rewind Rewind buffer to record into.
+ * @param[in] cpu CHIP-8 CPU context to record.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_rewind_push(chip8_rewind *rewind, const chip8_cpu *cpu);
+
+/**
+ * @brief Get recorded frame.
+ *
+ * @note Decodes forward from the keyframe of the frame, so seeking costs at
+ *       most interval small deltas.
+ *
+ * @pre rewind and state cannot be NULL.
+ * @pre frame must be less than the amount of frames held.
+ *
+ * @param[in] rewind Rewind buffer to seek in.
+ * @param[in] frame Frame to get, 0 being the oldest frame held.
+ * @param[out] state Snapshot to fill with frame.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_rewind_seek(const chip8_rewind *rewind, uint64_t frame,
+		              chip8_state *state);
+
+/**
+ * @brief Step CHIP-8 machine back to an earlier frame.
+ *
+ * @note Frames newer than the one restored are dropped, so recording picks
+ *       up from there.
+ *
+ * @pre rewind and cpu cannot be NULL.
+ * @pre frames must be less than the amount of frames held.
+ *
+ * @param[in,out] rewind Rewind buffer to step back in.
+ * @param[in,out] cpu CHIP-8 CPU context to restore.
+ * @param[in] frames Frames to step back, 0 restoring the newest frame.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_rewind_back(chip8_rewind *rewind, chip8_cpu *cpu,
+		              uint64_t frames);
+
+/**
+ * @brief Step CHIP-8 machine back in real time.
+ *
+ * @note Steps back one frame for every 60Hz frame of wall-clock time passed
+ *       since the last call, the same way #chip8_cpu_cycle() moves forward,
+ *       and stops at the oldest frame held. Wall-clock time of the CPU is
+ *       kept up to date, so #chip8_cpu_cycle() picks up without catching up
+ *       on the time spent rewinding.
+ *
+ * @pre rewind and cpu cannot be NULL.
+ *
+ * @param[in,out] rewind Rewind buffer to step back in.
+ * @param[in,out] cpu CHIP-8 CPU context to restore.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_rewind_cycle(chip8_rewind *rewind, chip8_cpu *cpu);
+
+/**
+ * @brief Get memory use of rewind buffer.
+ *
+ * @pre rewind and stats cannot be NULL.
+ *
+ * @param[in] rewind Rewind buffer to measure.
+ * @param[out] stats Memory use of rewind buffer.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_rewind_stat(const chip8_rewind *rewind,
+		              chip8_rewind_stats *stats);
+
+/**
+ * @brief Free rewind buffer and every frame it holds.
+ *
+ * @param[in,out] rewind Rewind buffer to free, may be NULL.
+ */
+void chip8_rewind_free(chip8_rewind *rewind);
+
+#endif /* CHIP8_CORE_REWIND_H */
@@ -0,0 +1,322 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/state.h"
+#include "core/video.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_STATE_MAGIC "C8ST" /**< First bytes of every save state. */
+#define CHIP8_STATE_BLOCK 64     /**< Bytes of RAM compared at once. */
+
+#define CHIP8_FNV_BASIS 2166136261u /**< FNV-1a offset basis. */
+#define CHIP8_FNV_PRIME 16777619u   /**< FNV-1a prime. */
+
+/**
+ * @brief Calculate FNV-1a checksum of encoded save state.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static uint32_t chip8_state_checksum(const uint8_t *buffer, size_t len)
+{
+	uint32_t hash = CHIP8_FNV_BASIS;
+
+	for (size_t n = 0; n < len; n++)
+		hash = (hash ^ buffer[n]) * CHIP8_FNV_PRIME;
+	return hash;
+}
+
+/**
+ * @brief Copy RAM into CPU, invalidating only blocks that differ.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_state_ram(chip8_cpu *cpu, const uint8_t *memory)
+{
+	/* Restoring a nearby snapshot usually leaves RAM as is... */
+	if (memcmp(cpu->memory, memory, CHIP8_RAM_SIZE) == 0)
+		return;
+
+	for (unsigned int at = 0; at < CHIP8_RAM_SIZE; at += CHIP8_STATE_BLOCK) {
+		if (memcmp(cpu->memory + at, memory + at,
+			   CHIP8_STATE_BLOCK) == 0)
+			continue;
+
+		memcpy(cpu->memory + at, memory + at, CHIP8_STATE_BLOCK);
+		chip8_cpu_invalidate(cpu, at, CHIP8_STATE_BLOCK);
+	}
+}
+
+/**
+ * @brief Copy screen into video, marking only rows that differ dirty.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_state_video(chip8_video *video, const chip8_state *state)
+{
+	unsigned int pitch = 0;
+	unsigned int words = 0;
+
+	if (video->hires != state->hires) {
+		video->hires = state->hires;
+		video->dirty = CHIP8_VIDEO_DIRTY;
+	}
+
+	/* Words past the current resolution are never shown, but keep them
+	 * anyway so snapshots restore exactly... */
+	pitch = chip8_video_pitch(video);
+	words = chip8_video_height(video) * pitch;
+	for (unsigned int n = 0; n < CHIP8_VIDEO_WORDS; n++) {
+		if (n < words && video->rows[n] != state->rows[n])
+			video->dirty |= (uint64_t)1 << (n / pitch);
+		video->rows[n] = state->rows[n];
+	}
+}
+
+chip8_error chip8_state_snap(const chip8_cpu *cpu, chip8_state *state)
+{
+	const uint8_t *wait = NULL;
+
+	if (cpu == NULL || state == NULL)
+		return CHIP8_EINVAL;
+
+	memcpy(state->memory, cpu->memory, sizeof state->memory);
+	memcpy(state->rows, cpu->video->rows, sizeof state->rows);
+	state->hires = cpu->video->hires;
+	memcpy(state->keys, cpu->keypad->keys, sizeof state->keys);
+	memcpy(state->v, cpu->v, sizeof state->v);
+	memcpy(state->rpl, cpu->rpl, sizeof state->rpl);
+	memcpy(state->stack, cpu->stack, sizeof state->stack);
+	state->sp = cpu->sp;
+	state->i = cpu->i;
+	state->pc = cpu->pc;
+	state->opcode = cpu->opcode;
+	state->dt = cpu->dt;
+	state->st = cpu->st;
+	state->opnum = cpu->opnum;
+	state->cycle_ticks = cpu->cycle_ticks;
+	state->cycles = cpu->cycles;
+	state->timer_count = cpu->timer_count;
+	state->rng = cpu->rng;
+
+	/* FX0A waits on a register of this CPU, so store which one... */
+	wait = cpu->keypad->states;
+	state->wait = CHIP8_STATE_NOWAIT;
+	if (wait >= cpu->v && wait < cpu->v + CHIP8_VREGS)
+		state->wait = wait - cpu->v;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_state_restore(chip8_cpu *cpu, const chip8_state *state)
+{
+	if (cpu == NULL || state == NULL)
+		return CHIP8_EINVAL;
+
+	if (state->opnum == 0 || state->sp > CHIP8_STACK_SIZE ||
+	    (state->wait >= CHIP8_VREGS && state->wait != CHIP8_STATE_NOWAIT))
+		return CHIP8_EINVAL;
+
+	chip8_state_ram(cpu, state->memory);
+	chip8_state_video(cpu->video, state);
+	memcpy(cpu->keypad->keys, state->keys, sizeof state->keys);
+	memcpy(cpu->v, state->v, sizeof state->v);
+	memcpy(cpu->rpl, state->rpl, sizeof state->rpl);
+	memcpy(cpu->stack, state->stack, sizeof state->stack);
+	cpu->sp = state->sp;
+	cpu->i = state->i;
+	cpu->pc = state->pc;
+	cpu->opcode = state->opcode;
+	cpu->dt = state->dt;
+	cpu->st = state->st;
+	cpu->opnum = state->opnum;
+	cpu->cycle_freq = (float)(1.0f / state->opnum);
+	cpu->cycle_ticks = state->cycle_ticks;
+	cpu->cycles = state->cycles;
+	cpu->timer_count = state->timer_count;
+	cpu->rng = state->rng;
+	cpu->keypad->states = (state->wait == CHIP8_STATE_NOWAIT) ?
+			      NULL : &cpu->v[state->wait];
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_state_encode(const chip8_state *state, uint8_t *buffer,
+		               size_t len)
+{
+	uint8_t *at = buffer;
+	uint16_t keys = 0;
+	uint32_t ticks = 0;
+
+	if (state == NULL || buffer == NULL || len < CHIP8_STATE_SIZE)
+		return CHIP8_EINVAL;
+
+	memcpy(at, CHIP8_STATE_MAGIC, 4);
+	at += 4;
+	chip8_putle(&at, CHIP8_STATE_VERSION, 2);
+	chip8_putle(&at, 0, 2);
+
+	memcpy(at, state->memory, CHIP8_RAM_SIZE);
+	at += CHIP8_RAM_SIZE;
+
+	/* Rows are already packed, so store them leftmost pixel first... */
+	for (int n = 0; n < CHIP8_VIDEO_WORDS; n++) {
+		for (int shift = 64 - 8; shift >= 0; shift -= 8)
+			*at++ = state->rows[n] >> shift;
+	}
+	chip8_putle(&at, state->hires, 1);
+
+	for (int key = 0; key < CHIP8_KEYPAD_SIZE; key++)
+		keys |= (state->keys[key] == CHIP8_KEY_DOWN) << key;
+	chip8_putle(&at, keys, 2);
+
+	memcpy(at, state->v, CHIP8_VREGS);
+	at += CHIP8_VREGS;
+	memcpy(at, state->rpl, CHIP8_RPL_SIZE);
+	at += CHIP8_RPL_SIZE;
+	for (int slot = 0; slot < CHIP8_STACK_SIZE; slot++)
+		chip8_putle(&at, state->stack[slot], 2);
+	chip8_putle(&at, state->sp, 2);
+	chip8_putle(&at, state->i, 2);
+	chip8_putle(&at, state->pc, 2);
+	chip8_putle(&at, state->opcode, 2);
+	chip8_putle(&at, state->dt, 1);
+	chip8_putle(&at, state->st, 1);
+	chip8_putle(&at, state->wait, 1);
+	chip8_putle(&at, state->opnum, 4);
+	memcpy(&ticks, &state->cycle_ticks, sizeof ticks);
+	chip8_putle(&at, ticks, 4);
+	chip8_putle(&at, state->cycles, 8);
+	chip8_putle(&at, state->timer_count, 8);
+	chip8_putle(&at, state->rng, 8);
+	chip8_putle(&at, chip8_state_checksum(buffer, at - buffer), 4);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_state_decode(chip8_state *state, const uint8_t *buffer,
+		               size_t len)
+{
+	const uint8_t *at = buffer;
+	uint16_t keys = 0;
+	uint32_t ticks = 0;
+
+	if (state == NULL || buffer == NULL)
+		return CHIP8_EINVAL;
+
+	if (len != CHIP8_STATE_SIZE ||
+	    memcmp(buffer, CHIP8_STATE_MAGIC, 4) != 0)
+		return CHIP8_EBADSTATE;
+
+	at += 4;
+	if (chip8_getle(&at, 2) != CHIP8_STATE_VERSION)
+		return CHIP8_EBADSTATE;
+	at += 2;
+
+	if (chip8_state_checksum(buffer, len - 4) !=
+	    (buffer[len - 4] | buffer[len - 3] << 8 |
+	     (uint32_t)buffer[len - 2] << 16 | (uint32_t)buffer[len - 1] << 24))
+		return CHIP8_EBADSTATE;
+
+	memcpy(state->memory, at, CHIP8_RAM_SIZE);
+	at += CHIP8_RAM_SIZE;
+
+	for (int n = 0; n < CHIP8_VIDEO_WORDS; n++) {
+		state->rows[n] = 0;
+		for (int col = 0; col < 64; col += 8)
+			state->rows[n] = state->rows[n] << 8 | *at++;
+	}
+	state->hires = chip8_getle(&at, 1) != 0;
+
+	keys = chip8_getle(&at, 2);
+	for (int key = 0; key < CHIP8_KEYPAD_SIZE; key++)
+		state->keys[key] = ((keys >> key) & 1) ?
+				   CHIP8_KEY_DOWN : CHIP8_KEY_UP;
+
+	memcpy(state->v, at, CHIP8_VREGS);
+	at += CHIP8_VREGS;
+	memcpy(state->rpl, at, CHIP8_RPL_SIZE);
+	at += CHIP8_RPL_SIZE;
+	for (int slot = 0; slot < CHIP8_STACK_SIZE; slot++)
+		state->stack[slot] = chip8_getle(&at, 2);
+	state->sp = chip8_getle(&at, 2);
+	state->i = chip8_getle(&at, 2);
+	state->pc = chip8_getle(&at, 2);
+	state->opcode = chip8_getle(&at, 2);
+	state->dt = chip8_getle(&at, 1);
+	state->st = chip8_getle(&at, 1);
+	state->wait = chip8_getle(&at, 1);
+	state->opnum = chip8_getle(&at, 4);
+	ticks = chip8_getle(&at, 4);
+	memcpy(&state->cycle_ticks, &ticks, sizeof ticks);
+	state->cycles = chip8_getle(&at, 8);
+	state->timer_count = chip8_getle(&at, 8);
+	state->rng = chip8_getle(&at, 8);
+
+	if (state->opnum == 0 || state->sp > CHIP8_STACK_SIZE ||
+	    (state->wait >= CHIP8_VREGS && state->wait != CHIP8_STATE_NOWAIT))
+		return CHIP8_EBADSTATE;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_state_save(const chip8_cpu *cpu, const char *path)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_state state;
+	uint8_t buffer[CHIP8_STATE_SIZE];
+	FILE *file = NULL;
+
+	if (cpu == NULL || path == NULL)
+		return CHIP8_EINVAL;
+
+	chip8_state_snap(cpu, &state);
+	chip8_state_encode(&state, buffer, sizeof buffer);
+
+	file = fopen(path, "wb");
+	if (file == NULL)
+		return CHIP8_ENOFILE;
+
+	if (fwrite(buffer, 1, sizeof buffer, file) != sizeof buffer)
+		flag = CHIP8_EIO;
+	if (fclose(file) != 0)
+		flag = CHIP8_EIO;
+	return flag;
+}
+
+chip8_error chip8_state_load(chip8_cpu *cpu, const char *path)
+{
+	chip8_error flag = CHIP8_EOK;
+	chip8_state state;
+	uint8_t *buffer = NULL;
+	size_t len = 0;
+
+	if (cpu == NULL || path == NULL)
+		return CHIP8_EINVAL;
+
+	flag = chip8_readrom(path, &buffer, &len);
+	if (flag != CHIP8_EOK)
+		goto out_buffer;
+
+	flag = chip8_state_decode(&state, buffer, len);
+	if (flag != CHIP8_EOK)
+		goto out_buffer;
+
+	flag = chip8_state_restore(cpu, &state);
+	if (flag != CHIP8_EOK)
+		goto out_buffer;
+
+	chip8_debugx("loaded state %s at cycle %lu\n", path,
+		     (unsigned long)state.cycles);
+
+out_buffer:
+	free(buffer);
+	buffer = NULL;
+	return flag;
+}
@@ -0,0 +1,145 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_STATE_H
+#define CHIP8_CORE_STATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/video.h"
+#include "utils/error.h"
+
+#define CHIP8_STATE_VERSION 2    /**< Version of encoded save states. */
+#define CHIP8_STATE_NOWAIT  0xFF /**< No register is waiting on a key. */
+
+/**
+ * @brief Size of an encoded save state in bytes.
+ *
+ * @note Header, RAM, pixel words and resolution, keys packed into a bit
+ *       mask, registers, RPL flags, clocks, and a trailing checksum.
+ */
+#define CHIP8_STATE_SIZE \
+	(8 + CHIP8_RAM_SIZE + CHIP8_VIDEO_WORDS * 8 + 1 + 2 + CHIP8_VREGS + \
+	 CHIP8_RPL_SIZE + 2 * CHIP8_STACK_SIZE + 8 + 3 + 4 + 4 + 24 + 4)
+
+/**
+ * @brief Snapshot of a CHIP-8 machine.
+ *
+ * @note Plain memory only, so snapshots can be copied around freely.
+ *       Wall-clock time is not part of a snapshot, so restored machines keep
+ *       pacing from wherever they were.
+ */
+typedef struct {
+	uint8_t memory[CHIP8_RAM_SIZE];    /**< RAM. */
+	uint64_t rows[CHIP8_VIDEO_WORDS];  /**< Screen, one bit per pixel. */
+	bool hires;                        /**< Screen is in high resolution. */
+	uint8_t keys[CHIP8_KEYPAD_SIZE];   /**< Keypad keys. */
+	uint8_t v[CHIP8_VREGS];            /**< Data registers. */
+	uint8_t rpl[CHIP8_RPL_SIZE];       /**< RPL flags. */
+	uint16_t stack[CHIP8_STACK_SIZE];  /**< Stack. */
+	uint16_t sp;                       /**< Stack pointer. */
+	uint16_t i;                        /**< Index register. */
+	uint16_t pc;                       /**< Program counter. */
+	uint16_t opcode;                   /**< Current opcode. */
+	uint8_t dt;                        /**< Delay timer. */
+	uint8_t st;                        /**< Sound timer. */
+	uint8_t wait;                      /**< Register FX0A waits on. */
+	unsigned int opnum;                /**< Instructions per second. */
+	float cycle_ticks;                 /**< Pacing accumulator. */
+	uint64_t cycles;                   /**< Virtual clock. */
+	uint64_t timer_count;              /**< 60Hz timer ticks elapsed. */
+	uint64_t rng;                      /**< PRNG state used by CXNN. */
+} chip8_state;
+
+/**
+ * @brief Take snapshot of CHIP-8 machine.
+ *
+ * @note Covers the CPU, its video pixels, and its keypad, and is only a few
+ *       plain copies, so it is cheap enough to take every frame.
+ *
+ * @pre cpu and state must not be NULL.
+ * @post state will hold the current state of the machine of cpu.
+ *
+ * @param[in] cpu CHIP-8 CPU context to take snapshot of.
+ * @param[out] state Snapshot to fill.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_state_snap(const chip8_cpu *cpu, chip8_state *state);
+
+/**
+ * @brief Restore CHIP-8 machine from snapshot.
+ *
+ * @note Only predecoded instructions covering RAM that differs from the
+ *       snapshot are invalidated, so restoring close snapshots stays cheap.
+ *
+ * @pre cpu and state must not be NULL.
+ * @post Machine of cpu will continue exactly where the snapshot was taken.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to restore.
+ * @param[in] state Snapshot to restore from.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_state_restore(chip8_cpu *cpu, const chip8_state *state);
+
+/**
+ * @brief Encode snapshot into versioned binary format.
+ *
+ * @note Every field is stored little-endian, so encoded states can move
+ *       between hosts.
+ *
+ * @pre state and buffer must not be NULL.
+ * @pre len must be at least #CHIP8_STATE_SIZE.
+ *
+ * @param[in] state Snapshot to encode.
+ * @param[out] buffer Buffer to encode into.
+ * @param[in] len Size of buffer.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_state_encode(const chip8_state *state, uint8_t *buffer,
+		               size_t len);
+
+/**
+ * @brief Decode snapshot from versioned binary format.
+ *
+ * @pre state and buffer must not be NULL.
+ *
+ * @param[out] state Snapshot to decode into.
+ * @param[in] buffer Encoded save state.
+ * @param[in] len Size of encoded save state.
+ * @return 0 (#CHIP8_EOK) for success, #CHIP8_EBADSTATE if buffer is not a
+ *         valid save state of this version, or #chip8_error code for
+ *         failure.
+ */
+chip8_error chip8_state_decode(chip8_state *state, const uint8_t *buffer,
+		               size_t len);
+
+/**
+ * @brief Save CHIP-8 machine to file.
+ *
+ * @pre cpu and path must not be NULL.
+ *
+ * @param[in] cpu CHIP-8 CPU context to save.
+ * @param[in] path File to write save state to.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_state_save(const chip8_cpu *cpu, const char *path);
+
+/**
+ * @brief Load CHIP-8 machine from file.
+ *
+ * @note Machine is left untouched if the file is not a valid save state.
+ *
+ * @pre cpu and path must not be NULL.
+ *
+ * @param[in,out] cpu CHIP-8 CPU context to load into.
+ * @param[in] path File to read save state from.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_state_load(chip8_cpu *cpu, const char *path);
+
+#endif /* CHIP8_CORE_STATE_H */
@@ -0,0 +1,327 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/cpu.h"
+#include "core/decode.h"
+#include "core/prof.h"
+#include "core/trace.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_TRACE_MAGIC  "C8TR" /**< First bytes of every trace file. */
+#define CHIP8_TRACE_HEADER 8      /**< Bytes of trace file header. */
+#define CHIP8_TRACE_CHUNK  1024   /**< Records encoded per fwrite(). */
+#define CHIP8_TRACE_IDLE   200000 /**< Nanoseconds drain thread naps. */
+
+/**
+ * @brief Non-zero if records in memory are laid out exactly like the file.
+ *
+ * @note Holds on little-endian hosts, where the drain thread writes straight
+ *       out of the ring instead of encoding every record first.
+ */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CHIP8_TRACE_RAW (sizeof(chip8_trace_rec) == CHIP8_TRACE_RECORD)
+#else
+#define CHIP8_TRACE_RAW 0
+#endif
+
+struct chip8_trace {
+	chip8_trace_rec *ring; /**< Ring of records. */
+	size_t mask;           /**< Capacity of ring minus one. */
+	uint64_t head;         /**< Records pushed, written by CPU only. */
+	uint64_t tail;         /**< Records drained, written by thread only. */
+	uint64_t stalls;       /**< Pushes that waited on a full ring. */
+	bool quit;             /**< Tells drain thread to finish. */
+	chip8_error status;    /**< Result of writing records. */
+	FILE *file;            /**< Trace file. */
+	pthread_t thread;      /**< Drain thread. */
+};
+
+/**
+ * @brief Encode record as little-endian bytes.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_trace_encode(const chip8_trace_rec *rec, uint8_t *at)
+{
+	chip8_putle(&at, rec->cycle, 8);
+	chip8_putle(&at, rec->pc, 2);
+	chip8_putle(&at, rec->opcode, 2);
+	chip8_putle(&at, rec->i, 2);
+	chip8_putle(&at, rec->vx, 1);
+	chip8_putle(&at, rec->vf, 1);
+}
+
+/**
+ * @brief Write records from tail up to head into trace file.
+ *
+ * @note INTERNAL USE ONLY!
+ *
+ * @return Amount of records written.
+ */
+static uint64_t chip8_trace_drain(chip8_trace *trace, uint64_t head)
+{
+	uint8_t buffer[CHIP8_TRACE_CHUNK * CHIP8_TRACE_RECORD];
+	uint64_t tail = trace->tail;
+	uint64_t start = tail;
+	size_t slot = 0;
+	size_t len = 0;
+	size_t wrote = 0;
+
+	while (tail != head) {
+		slot = tail & trace->mask;
+		len = head - tail;
+		if (CHIP8_TRACE_RAW) {
+			/* Records already look like the file, write in place... */
+			if (len > trace->mask + 1 - slot)
+				len = trace->mask + 1 - slot;
+			wrote = fwrite(&trace->ring[slot], CHIP8_TRACE_RECORD, len,
+				       trace->file);
+		} else {
+			if (len > CHIP8_TRACE_CHUNK)
+				len = CHIP8_TRACE_CHUNK;
+			for (size_t n = 0; n < len; n++)
+				chip8_trace_encode(&trace->ring[(slot + n) &
+						   trace->mask],
+						   buffer + n * CHIP8_TRACE_RECORD);
+			wrote = fwrite(buffer, CHIP8_TRACE_RECORD, len,
+				       trace->file);
+		}
+
+		if (wrote != len)
+			trace->status = CHIP8_EIO;
+		tail += len;
+		__atomic_store_n(&trace->tail, tail, __ATOMIC_RELEASE);
+	}
+	return tail - start;
+}
+
+/**
+ * @brief Drain thread, writes records until told to quit.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void *chip8_trace_thread(void *arg)
+{
+	chip8_trace *trace = arg;
+	struct timespec idle = { 0, CHIP8_TRACE_IDLE };
+	uint64_t head = 0;
+	bool quit = false;
+
+	do {
+		quit = __atomic_load_n(&trace->quit, __ATOMIC_ACQUIRE);
+		head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+		if (chip8_trace_drain(trace, head) == 0 && !quit)
+			nanosleep(&idle, NULL);
+	} while (!quit);
+	return NULL;
+}
+
+chip8_error chip8_trace_init(chip8_trace **trace, const char *path,
+		             size_t capacity)
+{
+	chip8_trace *newtrace = NULL;
+	uint8_t header[CHIP8_TRACE_HEADER];
+	uint8_t *at = header;
+	size_t cap = 1;
+
+	if (trace == NULL || path == NULL)
+		return CHIP8_EINVAL;
+
+	if (capacity == 0)
+		capacity = CHIP8_TRACE_CAPACITY;
+	while (cap < capacity)
+		cap <<= 1;
+
+	newtrace = calloc(1, sizeof *newtrace);
+	if (newtrace == NULL)
+		return CHIP8_ENOMEM;
+
+	newtrace->ring = malloc(cap * sizeof *newtrace->ring);
+	if (newtrace->ring == NULL)
+		goto out_trace;
+	newtrace->mask = cap - 1;
+
+	newtrace->file = fopen(path, "wb");
+	if (newtrace->file == NULL) {
+		free(newtrace->ring);
+		free(newtrace);
+		return CHIP8_ENOFILE;
+	}
+
+	memcpy(at, CHIP8_TRACE_MAGIC, 4);
+	at += 4;
+	chip8_putle(&at, CHIP8_TRACE_VERSION, 2);
+	chip8_putle(&at, CHIP8_TRACE_RECORD, 2);
+	if (fwrite(header, 1, sizeof header, newtrace->file) != sizeof header)
+		newtrace->status = CHIP8_EIO;
+
+	if (pthread_create(&newtrace->thread, NULL, chip8_trace_thread,
+			   newtrace) != 0)
+		goto out_file;
+
+	chip8_debugx("setup new trace %p writing to %s\n", (void *)newtrace,
+		     path);
+	*trace = newtrace;
+	return CHIP8_EOK;
+
+out_file:
+	fclose(newtrace->file);
+	remove(path);
+out_trace:
+	free(newtrace->ring);
+	free(newtrace);
+	return CHIP8_ENOMEM;
+}
+
+void chip8_trace_push(chip8_trace *trace, const chip8_cpu *cpu,
+		      uint64_t cycle, uint16_t pc, uint16_t opcode)
+{
+	chip8_trace_rec *rec = NULL;
+	uint64_t head = trace->head;
+
+	/* Wait for drain thread to free a slot, never drop records... */
+	if (head - __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE) >
+	    trace->mask) {
+		trace->stalls++;
+		while (head - __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE) >
+		       trace->mask)
+			sched_yield();
+	}
+
+	rec = &trace->ring[head & trace->mask];
+	rec->cycle = cycle;
+	rec->pc = pc;
+	rec->opcode = opcode;
+	rec->i = cpu->i;
+	rec->vx = cpu->v[(opcode >> 8) & 0xF];
+	rec->vf = cpu->v[0xF];
+	__atomic_store_n(&trace->head, head + 1, __ATOMIC_RELEASE);
+}
+
+chip8_error chip8_trace_exec(chip8_trace *trace, chip8_cpu *cpu,
+		             unsigned long budget, unsigned long *ran)
+{
+	chip8_error flag = CHIP8_EOK;
+	const chip8_instr *ins = NULL;
+	chip8_instr slow;
+	unsigned long done = 0;
+	uint16_t opcode = 0;
+	uint16_t pc = 0;
+	uint8_t id = 0;
+
+	if (trace == NULL || cpu == NULL || ran == NULL)
+		return CHIP8_EINVAL;
+
+	while (done < budget && flag == CHIP8_EOK) {
+		ins = chip8_decode_fetch(cpu, &slow);
+		id = ins->id;
+		opcode = ins->opcode;
+		pc = cpu->pc;
+		cpu->opcode = opcode;
+		cpu->pc += 2;
+
+		/* Handler may drop ins from the predecode cache... */
+		flag = ins->handler(cpu, ins);
+		chip8_trace_push(trace, cpu, cpu->cycles + done, pc, opcode);
+		done++;
+		if (id == CHIP8_OP_FX0A)
+			break;
+	}
+
+	*ran = done;
+	return flag;
+}
+
+chip8_error chip8_trace_stat(const chip8_trace *trace,
+		             chip8_trace_stats *stats)
+{
+	if (trace == NULL || stats == NULL)
+		return CHIP8_EINVAL;
+
+	stats->records = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+	stats->written = __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE);
+	stats->stalls = trace->stalls;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_trace_decode(const char *path, FILE *out)
+{
+	chip8_error flag = CHIP8_EOK;
+	uint8_t *buffer = NULL;
+	const uint8_t *at = NULL;
+	size_t size = 0;
+	uint64_t cycle = 0;
+	uint16_t pc = 0;
+	uint16_t opcode = 0;
+	uint16_t i = 0;
+	uint8_t vx = 0;
+	uint8_t vf = 0;
+
+	if (path == NULL || out == NULL)
+		return CHIP8_EINVAL;
+
+	flag = chip8_readrom(path, &buffer, &size);
+	if (flag != CHIP8_EOK)
+		return flag;
+
+	at = buffer + 4;
+	if (size < CHIP8_TRACE_HEADER ||
+	    memcmp(buffer, CHIP8_TRACE_MAGIC, 4) != 0 ||
+	    chip8_getle(&at, 2) != CHIP8_TRACE_VERSION ||
+	    chip8_getle(&at, 2) != CHIP8_TRACE_RECORD ||
+	    (size - CHIP8_TRACE_HEADER) % CHIP8_TRACE_RECORD != 0) {
+		flag = CHIP8_EBADTRACE;
+		goto out;
+	}
+
+	chip8_decode_init();
+	fprintf(out, "%-12s %-5s %-6s %-4s %-5s %-4s %s\n", "cycle", "pc",
+		"opcode", "op", "i", "vx", "vf");
+	while (at < buffer + size) {
+		cycle = chip8_getle(&at, 8);
+		pc = chip8_getle(&at, 2);
+		opcode = chip8_getle(&at, 2);
+		i = chip8_getle(&at, 2);
+		vx = chip8_getle(&at, 1);
+		vf = chip8_getle(&at, 1);
+		fprintf(out, "%-12llu 0x%03X %04X   %-4s 0x%03X 0x%02X 0x%02X\n",
+			(unsigned long long)cycle, pc, opcode,
+			chip8_prof_opname(chip8_decode(opcode)), i, vx, vf);
+	}
+	if (ferror(out))
+		flag = CHIP8_EIO;
+out:
+	free(buffer);
+	return flag;
+}
+
+chip8_error chip8_trace_free(chip8_trace *trace)
+{
+	chip8_error flag = CHIP8_EOK;
+
+	if (trace == NULL)
+		return CHIP8_EOK;
+
+	__atomic_store_n(&trace->quit, true, __ATOMIC_RELEASE);
+	pthread_join(trace->thread, NULL);
+
+	flag = trace->status;
+	if (fclose(trace->file) != 0)
+		flag = CHIP8_EIO;
+	free(trace->ring);
+	free(trace);
+	chip8_debug("free CHIP-8 trace");
+	return flag;
+}
@@ -0,0 +1,137 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_TRACE_H
+#define CHIP8_CORE_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "core/cpu.h"
+#include "utils/error.h"
+
+#define CHIP8_TRACE_VERSION  1         /**< Version of trace files. */
+#define CHIP8_TRACE_CAPACITY (1u << 16) /**< Default records in ring. */
+#define CHIP8_TRACE_RECORD   16        /**< Bytes of a record in a file. */
+
+/**
+ * @brief Trace record of a single instruction.
+ *
+ * @note Registers are captured after the instruction ran, so a record shows
+ *       what the instruction did to the registers it touched.
+ */
+typedef struct {
+	uint64_t cycle;  /**< Virtual clock cycle instruction ran at. */
+	uint16_t pc;     /**< Address instruction ran from. */
+	uint16_t opcode; /**< Raw 16-bit opcode. */
+	uint16_t i;      /**< Index register. */
+	uint8_t vx;      /**< Register X of opcode. */
+	uint8_t vf;      /**< Flag register VF. */
+} chip8_trace_rec;
+
+/**
+ * @brief Statistics of a trace.
+ */
+typedef struct {
+	uint64_t records; /**< Records pushed so far. */
+	uint64_t written; /**< Records written to file so far. */
+	uint64_t stalls;  /**< Pushes that waited on a full ring. */
+} chip8_trace_stats;
+
+/**
+ * @brief Binary instruction trace of a CHIP-8 CPU.
+ *
+ * @note Attach with #chip8_cpu_settrace(). Records go into a single producer,
+ *       single consumer lock-free ring that a background thread drains into
+ *       the trace file, so the CPU never touches stdio. A full ring makes the
+ *       CPU wait for the drain thread rather than drop records.
+ */
+typedef struct chip8_trace chip8_trace;
+
+/**
+ * @brief Create trace writing to file, and start its drain thread.
+ *
+ * @note Set capacity to 0 to use #CHIP8_TRACE_CAPACITY. Capacity is rounded
+ *       up to a power of two.
+ *
+ * @pre trace and path cannot be NULL.
+ *
+ * @param[in,out] trace Trace to initialize.
+ * @param[in] path File to write trace to.
+ * @param[in] capacity Records the ring holds.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_trace_init(chip8_trace **trace, const char *path,
+		             size_t capacity);
+
+/**
+ * @brief Record instruction that just ran.
+ *
+ * @pre trace and cpu cannot be NULL.
+ *
+ * @param[in,out] trace Trace to record into.
+ * @param[in] cpu CHIP-8 CPU context instruction ran on.
+ * @param[in] cycle Virtual clock cycle instruction ran at.
+ * @param[in] pc Address instruction ran from.
+ * @param[in] opcode Opcode of instruction.
+ */
+void chip8_trace_push(chip8_trace *trace, const chip8_cpu *cpu,
+		      uint64_t cycle, uint16_t pc, uint16_t opcode);
+
+/**
+ * @brief Interpret a batch of instructions, recording each one.
+ *
+ * @note Tracing variant of #chip8_interp_exec(), with the same rules for
+ *       ending a batch early.
+ *
+ * @pre trace, cpu and ran cannot be NULL.
+ * @pre Keypad of cpu must not be locked.
+ * @post cpu state will be updated by every instruction executed.
+ *
+ * @param[in,out] trace Trace to record into.
+ * @param[in,out] cpu CHIP-8 CPU context to execute.
+ * @param[in] budget Maximum amount of instructions to execute.
+ * @param[out] ran Amount of instructions executed.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_trace_exec(chip8_trace *trace, chip8_cpu *cpu,
+		             unsigned long budget, unsigned long *ran);
+
+/**
+ * @brief Get statistics of trace.
+ *
+ * @pre trace and stats cannot be NULL.
+ *
+ * @param[in] trace Trace to get statistics of.
+ * @param[out] stats Statistics of trace.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_trace_stat(const chip8_trace *trace,
+		             chip8_trace_stats *stats);
+
+/**
+ * @brief Print trace file as text, one instruction per line.
+ *
+ * @pre path and out cannot be NULL.
+ *
+ * @param[in] path Trace file to decode.
+ * @param[in,out] out File to print to.
+ * @return 0 (#CHIP8_EOK) for success, #CHIP8_EBADTRACE if file is not a
+ *         valid trace of this version, or #chip8_error code for failure.
+ */
+chip8_error chip8_trace_decode(const char *path, FILE *out);
+
+/**
+ * @brief Drain every record, stop drain thread, and free trace.
+ *
+ * @pre Trace must not be attached to any CPU.
+ *
+ * @param[in,out] trace Trace to free, may be NULL.
+ * @return 0 (#CHIP8_EOK) for success, or #CHIP8_EIO if any record could not
+ *         be written.
+ */
+chip8_error chip8_trace_free(chip8_trace *trace);
+
+#endif /* CHIP8_CORE_TRACE_H */
@@ -0,0 +1,89 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "core/triple.h"
+#include "core/video.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_TRIPLE_INDEX 0x3 /**< Bits of shared state holding index. */
+#define CHIP8_TRIPLE_FRESH 0x4 /**< Middle frame has not been taken yet. */
+
+/**
+ * @brief Lock-free triple buffer handing video frames from one thread to
+ *        another.
+ */
+struct chip8_triple {
+	chip8_video frames[3]; /**< Back, middle, and front frames. */
+	uint8_t back;          /**< Index of back frame, producer only. */
+	uint8_t front;         /**< Index of front frame, consumer only. */
+
+	/** Index of middle frame, plus #CHIP8_TRIPLE_FRESH while it is newer
+	 *  than the front frame. Only ever swapped atomically. */
+	uint8_t middle;
+};
+
+chip8_error chip8_triple_init(chip8_triple **triple)
+{
+	chip8_triple *newtriple = NULL;
+
+	if (triple == NULL)
+		return CHIP8_EINVAL;
+
+	newtriple = calloc(1, sizeof *newtriple);
+	if (newtriple == NULL)
+		return CHIP8_ENOMEM;
+
+	for (int n = 0; n < 3; n++)
+		chip8_video_palette(&newtriple->frames[n], CHIP8_VIDEO_OFF,
+				    CHIP8_VIDEO_ON);
+	newtriple->back = 0;
+	newtriple->middle = 1;
+	newtriple->front = 2;
+	*triple = newtriple;
+	chip8_debugx("setup new triple buffer %p\n", (void *)(*triple));
+	return CHIP8_EOK;
+}
+
+chip8_video *chip8_triple_back(chip8_triple *triple)
+{
+	return &triple->frames[triple->back];
+}
+
+bool chip8_triple_publish(chip8_triple *triple)
+{
+	uint8_t old = 0;
+
+	/* Release makes the back frame visible before its index is handed
+	 * over to the consumer... */
+	old = __atomic_exchange_n(&triple->middle,
+				  triple->back | CHIP8_TRIPLE_FRESH,
+				  __ATOMIC_ACQ_REL);
+	triple->back = old & CHIP8_TRIPLE_INDEX;
+	return (old & CHIP8_TRIPLE_FRESH) != 0;
+}
+
+chip8_video *chip8_triple_take(chip8_triple *triple, bool *fresh)
+{
+	uint8_t old = 0;
+
+	*fresh = (__atomic_load_n(&triple->middle, __ATOMIC_ACQUIRE) &
+		  CHIP8_TRIPLE_FRESH) != 0;
+	if (*fresh) {
+		old = __atomic_exchange_n(&triple->middle, triple->front,
+					  __ATOMIC_ACQ_REL);
+		triple->front = old & CHIP8_TRIPLE_INDEX;
+	}
+	return &triple->frames[triple->front];
+}
+
+void chip8_triple_free(chip8_triple *triple)
+{
+	chip8_debug("free triple buffer");
+	free(triple);
+}
@@ -0,0 +1,82 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_CORE_TRIPLE_H
+#define CHIP8_CORE_TRIPLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/video.h"
+#include "utils/error.h"
+
+/**
+ * @brief Lock-free triple buffer handing video frames from one thread to
+ *        another.
+ *
+ * @note Three frames are cycled between a single producer and a single
+ *       consumer. The producer fills the back frame and publishes it, which
+ *       swaps it with the middle frame. The consumer swaps the middle frame
+ *       with its front frame whenever a newer one was published. Neither
+ *       side ever waits on the other, and the consumer always gets the
+ *       newest complete frame, skipping any it was too slow to take.
+ */
+typedef struct chip8_triple chip8_triple;
+
+/**
+ * @brief Create a new triple buffer of cleared frames.
+ *
+ * @pre triple cannot be NULL.
+ *
+ * @param[in,out] triple Triple buffer to initialize.
+ * @return 0 (#CHIP8_EOK) for success or #chip8_error code for failure.
+ */
+chip8_error chip8_triple_init(chip8_triple **triple);
+
+/**
+ * @brief Get back frame for producer to fill.
+ *
+ * @note Only call from the producer thread.
+ *
+ * @pre triple cannot be NULL.
+ *
+ * @param[in,out] triple Triple buffer to get back frame of.
+ * @return Back frame, owned by the producer until it is published.
+ */
+chip8_video *chip8_triple_back(chip8_triple *triple);
+
+/**
+ * @brief Publish back frame as newest complete frame.
+ *
+ * @note Only call from the producer thread.
+ *
+ * @pre triple cannot be NULL.
+ * @post #chip8_triple_back() will return a different frame.
+ *
+ * @param[in,out] triple Triple buffer to publish back frame of.
+ * @return true if the frame published before was never taken.
+ */
+bool chip8_triple_publish(chip8_triple *triple);
+
+/**
+ * @brief Take newest complete frame.
+ *
+ * @note Only call from the consumer thread.
+ *
+ * @pre triple and fresh cannot be NULL.
+ *
+ * @param[in,out] triple Triple buffer to take frame of.
+ * @param[out] fresh Set to true if a frame was published since last take.
+ * @return Front frame, owned by the consumer until the next take.
+ */
+chip8_video *chip8_triple_take(chip8_triple *triple, bool *fresh);
+
+/**
+ * @brief Free triple buffer.
+ *
+ * @param[in,out] triple Triple buffer to free, may be NULL.
+ */
+void chip8_triple_free(chip8_triple *triple);
+
+#endif /* CHIP8_CORE_TRIPLE_H */
@@ -6,64 +6,142 @@
 #include <stdint.h>
 #include <string.h>
 
-#include "SDL.h"
 #include "core/video.h"
 #include "utils/auxfun.h"
 #include "utils/error.h"
 
-#define CHIP8_DEFAULT_SCALE 10
+/*
+ * Rows are expanded by broadcasting a group of pixel bits to every lane,
+ * turning each lane whose bit is set into an all ones mask, and selecting
+ * between the two palette colors with it. Builds without SSE2 look colors up
+ * one pixel at a time.
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CHIP8_VIDEO_ISA "avx2"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CHIP8_VIDEO_ISA "sse2"
+#else
+#define CHIP8_VIDEO_ISA "scalar"
+#endif
+
+#define CHIP8_VIDEO_P1 0x9E3779B185EBCA87ULL /**< XXH64 prime 1. */
+#define CHIP8_VIDEO_P2 0xC2B2AE3D27D4EB4FULL /**< XXH64 prime 2. */
+#define CHIP8_VIDEO_P3 0x165667B19E3779F9ULL /**< XXH64 prime 3. */
+#define CHIP8_VIDEO_P4 0x85EBCA77C2B2AE63ULL /**< XXH64 prime 4. */
 
-chip8_error chip8_video_init(chip8_video **video, unsigned int scale)
+/**
+ * @brief Rotate word left.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static inline uint64_t chip8_video_rotl(uint64_t word, int bits)
 {
-	chip8_video *newvid = NULL;
-	chip8_error flag = CHIP8_EOK;
+	return (word << bits) | (word >> (64 - bits));
+}
 
-	if (video == NULL)
-		return CHIP8_EINVAL;
+/**
+ * @brief Mix word into XXH64 accumulator.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static inline uint64_t chip8_video_round(uint64_t acc, uint64_t word)
+{
+	acc += word * CHIP8_VIDEO_P2;
+	return chip8_video_rotl(acc, 31) * CHIP8_VIDEO_P1;
+}
 
-	if (scale == 0)
-		scale = CHIP8_DEFAULT_SCALE;
+/**
+ * @brief Merge XXH64 lane into hash.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static inline uint64_t chip8_video_merge(uint64_t hash, uint64_t lane)
+{
+	hash ^= chip8_video_round(0, lane);
+	return hash * CHIP8_VIDEO_P1 + CHIP8_VIDEO_P4;
+}
 
-	if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
-		return CHIP8_ESDL;
+/**
+ * @brief Get mask of rows with any pixel lit, bit y for row y.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static uint64_t chip8_video_lit(const chip8_video *video)
+{
+	const unsigned int pitch = chip8_video_pitch(video);
+	const unsigned int height = chip8_video_height(video);
+	uint64_t lit = 0;
 
-	newvid = malloc(sizeof *newvid);
-	if (newvid == NULL) {
-		flag = CHIP8_ESDL;
-		goto error;
+	for (unsigned int y = 0; y < height; y++) {
+		if (video->rows[pitch * y] != 0 ||
+		    video->rows[pitch * y + pitch - 1] != 0)
+			lit |= (uint64_t)1 << y;
 	}
+	return lit;
+}
 
-	newvid->window = SDL_CreateWindow("CHIP-8",
-			                  SDL_WINDOWPOS_UNDEFINED,
-					  SDL_WINDOWPOS_UNDEFINED,
-					  CHIP8_VIDEO_WIDTH * scale,
-					  CHIP8_VIDEO_HEIGHT * scale,
-					  SDL_WINDOW_SHOWN);
-	if (newvid->window == NULL) {
-		flag = CHIP8_ESDL;
-		goto error;
-	}
+/**
+ * @brief Expand a single word of a row into palette colors.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_video_expand(uint64_t word, const uint32_t *palette,
+		               uint32_t *buffer)
+{
+#if defined(__AVX2__)
+	const __m256i bits = _mm256_set_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m256i off = _mm256_set1_epi32(palette[0]);
+	const __m256i diff = _mm256_set1_epi32(palette[0] ^ palette[1]);
+	__m256i lit;
 
-	newvid->renderer = SDL_CreateRenderer(newvid->window, -1,
-			                      SDL_RENDERER_ACCELERATED);
-	if (newvid->renderer == NULL) {
-		flag = CHIP8_ESDL;
-		goto error;
+	for (int shift = 64 - 8; shift >= 0; shift -= 8) {
+		lit = _mm256_and_si256(_mm256_set1_epi32((word >> shift) & 0xFF),
+				       bits);
+		lit = _mm256_cmpeq_epi32(lit, bits);
+		_mm256_storeu_si256((__m256i *)buffer,
+				    _mm256_xor_si256(off,
+					             _mm256_and_si256(diff, lit)));
+		buffer += 8;
 	}
+#elif defined(__SSE2__)
+	const __m128i bits = _mm_set_epi32(1, 2, 4, 8);
+	const __m128i off = _mm_set1_epi32(palette[0]);
+	const __m128i diff = _mm_set1_epi32(palette[0] ^ palette[1]);
+	__m128i lit;
 
-	newvid->texture = SDL_CreateTexture(newvid->renderer,
-			                    SDL_PIXELFORMAT_RGBA8888,
-					    SDL_TEXTUREACCESS_TARGET,
-					    CHIP8_VIDEO_WIDTH,
-					    CHIP8_VIDEO_HEIGHT);
-	if (newvid->texture == NULL) {
-		flag = CHIP8_ESDL;
-		goto error;
+	for (int shift = 64 - 4; shift >= 0; shift -= 4) {
+		lit = _mm_and_si128(_mm_set1_epi32((word >> shift) & 0xF), bits);
+		lit = _mm_cmpeq_epi32(lit, bits);
+		_mm_storeu_si128((__m128i *)buffer,
+				 _mm_xor_si128(off, _mm_and_si128(diff, lit)));
+		buffer += 4;
 	}
+#else
+	for (int bit = 63; bit >= 0; bit--)
+		*buffer++ = palette[(word >> bit) & 1];
+#endif
+}
+
+chip8_error chip8_video_init(chip8_video **video)
+{
+	chip8_video *newvid = NULL;
+	chip8_error flag = CHIP8_EOK;
+
+	if (video == NULL)
+		return CHIP8_EINVAL;
+
+	newvid = calloc(1, sizeof *newvid);
+	if (newvid == NULL)
+		return CHIP8_ENOMEM;
 
 	flag = chip8_video_clear(newvid);
 	if (flag != CHIP8_EOK)
 		goto error;
+	newvid->dirty = CHIP8_VIDEO_DIRTY;
+	newvid->palette[0] = CHIP8_VIDEO_OFF;
+	newvid->palette[1] = CHIP8_VIDEO_ON;
 
 	*video = newvid;
 	chip8_debugx("setup new video %p\n", (void *)(*video));
@@ -75,44 +153,187 @@ done:
 	return flag;
 }
 
-chip8_error chip8_video_render(chip8_video *video)
+chip8_error chip8_video_clear(chip8_video *video)
+{
+	if (video == NULL)
+		return CHIP8_EINVAL;
+
+	/* Plenty of ROMs clear a screen that is already blank... */
+	video->dirty |= chip8_video_lit(video);
+	memset(video->rows, 0, sizeof video->rows);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_video_resolution(chip8_video *video, bool hires)
+{
+	if (video == NULL)
+		return CHIP8_EINVAL;
+
+	memset(video->rows, 0, sizeof video->rows);
+	video->hires = hires;
+	video->dirty = CHIP8_VIDEO_DIRTY;
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_video_scroll_down(chip8_video *video, unsigned int count)
 {
+	unsigned int pitch = 0;
+	unsigned int height = 0;
+	uint64_t lit = 0;
+
 	if (video == NULL)
 		return CHIP8_EINVAL;
 
-	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++) {
-		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++) {
-			uint8_t pixel = video->pixels[y][x];
-			video->buffer[(y * CHIP8_VIDEO_WIDTH) + x] =
-				(0x8FF58600 * pixel) | 0x142838FF;
+	pitch = chip8_video_pitch(video);
+	height = chip8_video_height(video);
+	if (count > height)
+		count = height;
+	if (count == 0)
+		return CHIP8_EOK;
+
+	/* Only rows lit before or after the move can change... */
+	lit = chip8_video_lit(video);
+	video->dirty |= lit;
+	if (count < height)
+		video->dirty |= lit << count;
+
+	memmove(video->rows + pitch * count, video->rows,
+		(height - count) * pitch * sizeof *video->rows);
+	memset(video->rows, 0, pitch * count * sizeof *video->rows);
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_video_scroll_left(chip8_video *video, unsigned int count)
+{
+	uint64_t *row = NULL;
+
+	if (video == NULL || count >= 64)
+		return CHIP8_EINVAL;
+	if (count == 0)
+		return CHIP8_EOK;
+
+	video->dirty |= chip8_video_lit(video);
+	for (unsigned int y = 0; y < chip8_video_height(video); y++) {
+		if (!video->hires) {
+			video->rows[y] <<= count;
+			continue;
 		}
+
+		/* Pixels leaving the right word enter the left one... */
+		row = &video->rows[2 * y];
+		row[0] = row[0] << count | row[1] >> (64 - count);
+		row[1] <<= count;
 	}
+	return CHIP8_EOK;
+}
 
-	SDL_UpdateTexture(video->texture, NULL, video->buffer,
-			  CHIP8_VIDEO_WIDTH * sizeof(uint32_t));
-	SDL_RenderClear(video->renderer);
-	SDL_RenderCopy(video->renderer, video->texture, NULL, NULL);
-	SDL_RenderPresent(video->renderer);
+chip8_error chip8_video_scroll_right(chip8_video *video, unsigned int count)
+{
+	uint64_t *row = NULL;
+
+	if (video == NULL || count >= 64)
+		return CHIP8_EINVAL;
+	if (count == 0)
+		return CHIP8_EOK;
+
+	video->dirty |= chip8_video_lit(video);
+	for (unsigned int y = 0; y < chip8_video_height(video); y++) {
+		if (!video->hires) {
+			video->rows[y] >>= count;
+			continue;
+		}
+
+		/* Pixels leaving the left word enter the right one... */
+		row = &video->rows[2 * y];
+		row[1] = row[1] >> count | row[0] << (64 - count);
+		row[0] >>= count;
+	}
 	return CHIP8_EOK;
 }
 
-chip8_error chip8_video_clear(chip8_video *video)
+chip8_error chip8_video_palette(chip8_video *video, uint32_t off, uint32_t on)
 {
 	if (video == NULL)
 		return CHIP8_EINVAL;
 
-	memset(video->pixels, 0, sizeof video->pixels);
+	video->palette[0] = off;
+	video->palette[1] = on;
+	video->dirty = CHIP8_VIDEO_DIRTY;
 	return CHIP8_EOK;
 }
 
-void chip8_video_free(chip8_video *video)
+chip8_error chip8_video_rgba(const chip8_video *video, uint32_t *buffer)
+{
+	if (video == NULL)
+		return CHIP8_EINVAL;
+
+	return chip8_video_rgba_rows(video, buffer, 0,
+				     chip8_video_height(video));
+}
+
+chip8_error chip8_video_rgba_rows(const chip8_video *video, uint32_t *buffer,
+		                  unsigned int first, unsigned int count)
+{
+	unsigned int pitch = 0;
+
+	if (video == NULL || buffer == NULL ||
+	    first + count > chip8_video_height(video))
+		return CHIP8_EINVAL;
+
+	/* Words of a row are laid out left to right, so expand them in
+	 * order... */
+	pitch = chip8_video_pitch(video);
+	for (unsigned int n = first * pitch; n < (first + count) * pitch; n++) {
+		chip8_video_expand(video->rows[n], video->palette, buffer);
+		buffer += 64;
+	}
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_video_hash(const chip8_video *video, uint64_t *hash)
+{
+	uint64_t lane[4] = {
+		CHIP8_VIDEO_P1 + CHIP8_VIDEO_P2, CHIP8_VIDEO_P2, 0,
+		-CHIP8_VIDEO_P1
+	};
+	unsigned int words = 0;
+	uint64_t h = 0;
+
+	if (video == NULL || hash == NULL)
+		return CHIP8_EINVAL;
+
+	/* Four independent lanes of every fourth word, so the multiplies of
+	 * every lane overlap... */
+	words = chip8_video_height(video) * chip8_video_pitch(video);
+	for (unsigned int n = 0; n < words; n += 4) {
+		lane[0] = chip8_video_round(lane[0], video->rows[n]);
+		lane[1] = chip8_video_round(lane[1], video->rows[n + 1]);
+		lane[2] = chip8_video_round(lane[2], video->rows[n + 2]);
+		lane[3] = chip8_video_round(lane[3], video->rows[n + 3]);
+	}
+
+	h = chip8_video_rotl(lane[0], 1) + chip8_video_rotl(lane[1], 7) +
+	    chip8_video_rotl(lane[2], 12) + chip8_video_rotl(lane[3], 18);
+	for (int n = 0; n < 4; n++)
+		h = chip8_video_merge(h, lane[n]);
+	h += words * sizeof *video->rows;
+
+	h ^= h >> 33;
+	h *= CHIP8_VIDEO_P2;
+	h ^= h >> 29;
+	h *= CHIP8_VIDEO_P3;
+	h ^= h >> 32;
+	*hash = h;
+	return CHIP8_EOK;
+}
+
+const char *chip8_video_isa(void)
 {
-	chip8_debug("shutdown SDL2 video sub-system");
-	SDL_DestroyTexture(video->texture);
-	SDL_DestroyRenderer(video->renderer);
-	SDL_DestroyWindow(video->window);
-	SDL_QuitSubSystem(SDL_INIT_VIDEO);
+	return CHIP8_VIDEO_ISA;
+}
 
+void chip8_video_free(chip8_video *video)
+{
 	chip8_debug("free CHIP-8 video");
 	free(video);
 }
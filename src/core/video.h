@@ -5,43 +5,63 @@
 #ifndef CHIP8_CORE_VIDEO_H
 #define CHIP8_CORE_VIDEO_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "utils/error.h"
-#include "SDL.h"
 
-#define CHIP8_VIDEO_WIDTH 64
-#define CHIP8_VIDEO_HEIGHT 32
+#define CHIP8_VIDEO_WIDTH 64  /**< Width of low resolution screen. */
+#define CHIP8_VIDEO_HEIGHT 32 /**< Height of low resolution screen. */
+
+#define CHIP8_VIDEO_HIRES_WIDTH 128 /**< Width of SUPER-CHIP screen. */
+#define CHIP8_VIDEO_HIRES_HEIGHT 64 /**< Height of SUPER-CHIP screen. */
+
+/** Words of pixel data, enough for the high resolution screen. */
+#define CHIP8_VIDEO_WORDS \
+	(CHIP8_VIDEO_HIRES_WIDTH * CHIP8_VIDEO_HIRES_HEIGHT / 64)
+
+#define CHIP8_VIDEO_OFF 0x142838FF /**< RGBA8888 color of unlit pixels. */
+#define CHIP8_VIDEO_ON  0x9FFDBEFF /**< RGBA8888 color of lit pixels. */
+#define CHIP8_VIDEO_DIRTY UINT64_MAX /**< Dirty mask covering every row. */
 
 /**
  * @brief CHIP-8 video information.
+ *
+ * @note Plain memory only, presenting pixels is up to the frontend. Every
+ *       row is packed into words with the leftmost pixel in the most
+ *       significant bit, so a sprite row is drawn with one shift and one XOR.
+ *       A low resolution row is a single word, rows[y], and a high resolution
+ *       row is the two words rows[2 * y] and rows[2 * y + 1], so scrolling
+ *       moves whole words either way. Go through #chip8_video_get() and
+ *       #chip8_video_set() to touch single pixels.
  */
 typedef struct {
-	SDL_Window *window;     /**< SDL window pointer. */
-	SDL_Renderer *renderer; /**< SDL renderer pointer. */
-	SDL_Texture *texture;   /**< SDL texture pointer. */
-	
-	/** Screen pixel data. */
-	uint8_t pixels[CHIP8_VIDEO_HEIGHT][CHIP8_VIDEO_WIDTH];
-
-	/** Texture buffer data. */
-	uint32_t buffer[CHIP8_VIDEO_WIDTH * CHIP8_VIDEO_HEIGHT];
+	/** Screen pixel data, one bit per pixel, row after row. */
+	uint64_t rows[CHIP8_VIDEO_WORDS];
+
+	/** Rows that may have changed since the frontend last looked, bit y
+	 *  for row y. Cleared by the frontend, never by the core. */
+	uint64_t dirty;
+
+	/** RGBA8888 colors of unlit and lit pixels, in that order. */
+	uint32_t palette[2];
+
+	/** Screen is in SUPER-CHIP 128x64 high resolution mode. */
+	bool hires;
 } chip8_video;
 
 /**
  * @brief Create a new CHIP-8 video context.
  *
- * @note Set scale to 0 for default window size.
- *
  * @pre video cannot be NULL.
- * @post Will create a new video context with a fully rendered window.
+ * @post Will create a new video context with cleared pixel data, and the
+ *       #CHIP8_VIDEO_OFF and #CHIP8_VIDEO_ON palette.
  *
  * @param[in,out] video Video pointer to initialize.
- * @param[in] scale Scale of window to create.
  *
  * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
  */
-chip8_error chip8_video_init(chip8_video **video, unsigned int scale);
+chip8_error chip8_video_init(chip8_video **video);
 
 /**
  * @brief Destroy CHIP-8 video context.
@@ -54,24 +74,237 @@ chip8_error chip8_video_init(chip8_video **video, unsigned int scale);
 void chip8_video_free(chip8_video *video);
 
 /**
- * @brief Buffer and render pixel data to window.
+ * @brief Clear pixel data.
  *
  * @pre video must not be NULL.
+ * @post video->rows contents will be memset to zero, and rows that were lit
+ *       will be marked dirty. Resolution is left as is.
  *
- * @param[in] video Video context to render pixel data from.
+ * @param[in] video Video pixel data to clear.
  * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
  */
-chip8_error chip8_video_render(chip8_video *video);
+chip8_error chip8_video_clear(chip8_video *video);
 
 /**
- * @brief Clear pixel data.
+ * @brief Switch between low and high resolution.
+ *
+ * @note Rows of the two resolutions are packed differently, so the screen is
+ *       always cleared, the same as 00FE and 00FF do on modern SUPER-CHIP
+ *       interpreters.
  *
  * @pre video must not be NULL.
- * @post video->pixels contents will be memset to zero.
+ * @post Screen will be cleared in new resolution, and every row will be
+ *       marked dirty.
  *
- * @param[in] video Video pixel data to clear.
+ * @param[in,out] video Video context to switch resolution of.
+ * @param[in] hires True for 128x64, false for 64x32.
  * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
  */
-chip8_error chip8_video_clear(chip8_video *video);
+chip8_error chip8_video_resolution(chip8_video *video, bool hires);
+
+/**
+ * @brief Scroll screen down, leaving blank rows at the top.
+ *
+ * @note Moves every row with a single memmove().
+ *
+ * @pre video must not be NULL.
+ * @post Rows that changed will be marked dirty.
+ *
+ * @param[in,out] video Video context to scroll.
+ * @param[in] count Rows to scroll by, in pixels of current resolution.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_video_scroll_down(chip8_video *video, unsigned int count);
+
+/**
+ * @brief Scroll screen left, leaving blank columns at the right.
+ *
+ * @note Shifts every row as a whole, carrying pixels from the right word of
+ *       a high resolution row into the left one.
+ *
+ * @pre video must not be NULL.
+ * @pre count must be less than 64.
+ * @post Rows that changed will be marked dirty.
+ *
+ * @param[in,out] video Video context to scroll.
+ * @param[in] count Columns to scroll by, in pixels of current resolution.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_video_scroll_left(chip8_video *video, unsigned int count);
+
+/**
+ * @brief Scroll screen right, leaving blank columns at the left.
+ *
+ * @pre video must not be NULL.
+ * @pre count must be less than 64.
+ * @post Rows that changed will be marked dirty.
+ *
+ * @param[in,out] video Video context to scroll.
+ * @param[in] count Columns to scroll by, in pixels of current resolution.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_video_scroll_right(chip8_video *video, unsigned int count);
+
+/**
+ * @brief Set colors pixels are expanded into.
+ *
+ * @pre video must not be NULL.
+ * @post Every row will be marked dirty.
+ *
+ * @param[in,out] video Video context to set palette of.
+ * @param[in] off RGBA8888 color of unlit pixels.
+ * @param[in] on RGBA8888 color of lit pixels.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_video_palette(chip8_video *video, uint32_t off, uint32_t on);
+
+/**
+ * @brief Expand pixel data into RGBA8888 colors.
+ *
+ * @note Frontends upload buffer as is, so this is the whole cost of turning
+ *       a frame into an image. Builds for SSE2 or AVX2 expand several pixels
+ *       per instruction, see #chip8_video_isa().
+ *
+ * @pre video and buffer must not be NULL.
+ * @post buffer will hold the palette color of every pixel, row by row.
+ *
+ * @param[in] video Video pixel data to expand.
+ * @param[out] buffer Buffer of #chip8_video_width() *
+ *                    #chip8_video_height() colors.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_video_rgba(const chip8_video *video, uint32_t *buffer);
+
+/**
+ * @brief Expand some rows of pixel data into RGBA8888 colors.
+ *
+ * @pre video and buffer must not be NULL.
+ * @pre first + count must not exceed #chip8_video_height().
+ * @post buffer will hold the palette color of every pixel of rows first to
+ *       first + count - 1, row by row.
+ *
+ * @param[in] video Video pixel data to expand.
+ * @param[out] buffer Buffer of #chip8_video_width() * count colors.
+ * @param[in] first First row to expand.
+ * @param[in] count Amount of rows to expand.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_video_rgba_rows(const chip8_video *video, uint32_t *buffer,
+		                  unsigned int first, unsigned int count);
+
+/**
+ * @brief Hash pixel data into 64 bits.
+ *
+ * @note The hash is XXH64 with seed 0 of the rows of the current resolution
+ *       laid out as little-endian words, the same on every host. It covers
+ *       pixels only, not palette or dirty rows, so frames compare equal
+ *       however they are colored, and a whole frame is hashed in a few dozen
+ *       multiplies.
+ *
+ * @pre video and hash must not be NULL.
+ *
+ * @param[in] video Video pixel data to hash.
+ * @param[out] hash Hash of pixel data.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_video_hash(const chip8_video *video, uint64_t *hash);
+
+/**
+ * @brief Get name of instruction set pixels are expanded with.
+ *
+ * @return "avx2", "sse2", or "scalar".
+ */
+const char *chip8_video_isa(void);
+
+/**
+ * @brief Get width of screen in current resolution.
+ *
+ * @pre video must not be NULL.
+ *
+ * @param[in] video Video context to get width of.
+ * @return #CHIP8_VIDEO_HIRES_WIDTH or #CHIP8_VIDEO_WIDTH.
+ */
+static inline unsigned int chip8_video_width(const chip8_video *video)
+{
+	return video->hires ? CHIP8_VIDEO_HIRES_WIDTH : CHIP8_VIDEO_WIDTH;
+}
+
+/**
+ * @brief Get height of screen in current resolution.
+ *
+ * @pre video must not be NULL.
+ *
+ * @param[in] video Video context to get height of.
+ * @return #CHIP8_VIDEO_HIRES_HEIGHT or #CHIP8_VIDEO_HEIGHT.
+ */
+static inline unsigned int chip8_video_height(const chip8_video *video)
+{
+	return video->hires ? CHIP8_VIDEO_HIRES_HEIGHT : CHIP8_VIDEO_HEIGHT;
+}
+
+/**
+ * @brief Get words every row of current resolution is packed into.
+ *
+ * @pre video must not be NULL.
+ *
+ * @param[in] video Video context to get pitch of.
+ * @return 2 in high resolution, 1 otherwise.
+ */
+static inline unsigned int chip8_video_pitch(const chip8_video *video)
+{
+	return video->hires ? 2 : 1;
+}
+
+/**
+ * @brief Get index of word holding a single pixel.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static inline unsigned int chip8_video_word(const chip8_video *video,
+		                            unsigned int x, unsigned int y)
+{
+	return chip8_video_pitch(video) * y + x / 64;
+}
+
+/**
+ * @brief Get a single pixel.
+ *
+ * @pre video must not be NULL.
+ * @pre x and y must be on screen.
+ *
+ * @param[in] video Video pixel data to read.
+ * @param[in] x Column of pixel.
+ * @param[in] y Row of pixel.
+ * @return 1 if pixel is lit, 0 otherwise.
+ */
+static inline int chip8_video_get(const chip8_video *video, unsigned int x,
+		                  unsigned int y)
+{
+	return (video->rows[chip8_video_word(video, x, y)] >> (63 - x % 64)) &
+	       1;
+}
+
+/**
+ * @brief Light or unlight a single pixel.
+ *
+ * @post Row of pixel will be marked dirty.
+ *
+ * @pre video must not be NULL.
+ * @pre x and y must be on screen.
+ *
+ * @param[in,out] video Video pixel data to write.
+ * @param[in] x Column of pixel.
+ * @param[in] y Row of pixel.
+ * @param[in] on Non-zero to light pixel, 0 to unlight it.
+ */
+static inline void chip8_video_set(chip8_video *video, unsigned int x,
+		                   unsigned int y, int on)
+{
+	uint64_t *word = &video->rows[chip8_video_word(video, x, y)];
+	uint64_t bit = (uint64_t)1 << (63 - x % 64);
+
+	*word = on ? (*word | bit) : (*word & ~bit);
+	video->dirty |= (uint64_t)1 << y;
+}
 
 #endif /* CHIP8_CORE_VIDEO_H */
@@ -0,0 +1,97 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "SDL.h"
+#include "frontend/input.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+chip8_error chip8_input_init(void)
+{
+	if (SDL_InitSubSystem(SDL_INIT_EVENTS) < 0)
+		return CHIP8_ESDL;
+	chip8_debug("setup SDL2 event sub-system");
+	return CHIP8_EOK;
+}
+
+void chip8_input_free(void)
+{
+	chip8_debug("shutdown SDL2 event sub-system");
+	SDL_QuitSubSystem(SDL_INIT_EVENTS);
+}
+
+chip8_error chip8_input_poll(bool *status)
+{
+	if (status == NULL)
+		return CHIP8_EINVAL;
+
+	SDL_Event event;
+	while (SDL_PollEvent(&event) != 0) {
+		if (event.type == SDL_QUIT) {
+			*status = true;
+		}
+	}
+
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_input_keys(uint16_t *keys)
+{
+	if (keys == NULL)
+		return CHIP8_EINVAL;
+	
+	const Uint8 *keystates = SDL_GetKeyboardState(NULL);
+	const int keymap[] = {
+		SDL_SCANCODE_X, /* 0 */
+		SDL_SCANCODE_1, /* 1 */
+		SDL_SCANCODE_2, /* 2 */
+		SDL_SCANCODE_3, /* 3 */
+		SDL_SCANCODE_Q, /* 4 */
+		SDL_SCANCODE_W, /* 5 */
+		SDL_SCANCODE_E, /* 6 */
+		SDL_SCANCODE_A, /* 7 */
+		SDL_SCANCODE_S, /* 8 */
+		SDL_SCANCODE_D, /* 9 */
+		SDL_SCANCODE_Z, /* A */
+		SDL_SCANCODE_C, /* B */
+		SDL_SCANCODE_4, /* C */
+		SDL_SCANCODE_R, /* D */
+		SDL_SCANCODE_F, /* E */
+		SDL_SCANCODE_V  /* F */
+	};
+
+	*keys = 0;
+	for (uint8_t i = 0; i < chip8_arrsize(keymap); ++i) {
+		if (keystates[keymap[i]])
+			*keys |= 1u << i;
+	}
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_input_process(chip8_keypad *keypad)
+{
+	uint16_t keys = 0;
+
+	if (keypad == NULL)
+		return CHIP8_EINVAL;
+
+	chip8_input_keys(&keys);
+	for (uint8_t i = 0; i < CHIP8_KEYPAD_SIZE; ++i) {
+		chip8_keypad_setkey(keypad, i, ((keys >> i) & 1) ?
+				    CHIP8_KEY_DOWN : CHIP8_KEY_UP);
+	}
+	return CHIP8_EOK;
+}
+
+chip8_error chip8_input_rewind(bool *status)
+{
+	if (status == NULL)
+		return CHIP8_EINVAL;
+
+	*status = SDL_GetKeyboardState(NULL)[SDL_SCANCODE_BACKSPACE] != 0;
+	return CHIP8_EOK;
+}
@@ -0,0 +1,76 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_FRONTEND_INPUT_H
+#define CHIP8_FRONTEND_INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/keypad.h"
+#include "utils/error.h"
+
+/**
+ * @brief Initialize SDL2 event sub-system for keyboard input.
+ *
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_input_init(void);
+
+/**
+ * @brief Shutdown SDL2 event sub-system.
+ */
+void chip8_input_free(void);
+
+/**
+ * @brief Poll for keyboard input.
+ *
+ * @pre #status cannot be NULL.
+ * @post Return true if poll wants to exit main loop, false otherwise.
+ *
+ * @param[out] status Status of poll.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_input_poll(bool *status);
+
+/**
+ * @brief Get keyboard input as keypad key mask.
+ *
+ * @note This should be called after #chip8_input_poll(). We are using SDL2
+ *       scan codes to determine what key is pressed.
+ * @pre #keys cannot be NULL.
+ * @post Bit n of #keys is set if keypad key n is pressed.
+ *
+ * @param[out] keys Mask of keypad keys pressed.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_input_keys(uint16_t *keys);
+
+/**
+ * @brief Process keyboard input into keypad.
+ *
+ * @note This should be called after #chip8_input_poll(). We are using SDL2
+ *       scan codes to determine what key is pressed.
+ * @pre #keypad cannot be NULL.
+ * @post Process input into keypad.
+ *
+ * @param[in,out] keypad Keypad to process input into.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_input_process(chip8_keypad *keypad);
+
+/**
+ * @brief Check if rewind hotkey is held down.
+ *
+ * @note This should be called after #chip8_input_poll(). Rewind is bound to
+ *       the backspace key.
+ * @pre #status cannot be NULL.
+ * @post Return true if rewind hotkey is held down, false otherwise.
+ *
+ * @param[out] status Status of rewind hotkey.
+ * @return 0 (#CHIP8_EOK) for success, or #chip8_error code for failure.
+ */
+chip8_error chip8_input_rewind(bool *status);
+
+#endif /* CHIP8_FRONTEND_INPUT_H */
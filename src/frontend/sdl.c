@@ -0,0 +1,16 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+
+#include "SDL.h"
+#include "frontend/sdl.h"
+#include "utils/error.h"
+
+void chip8_sdl_die(chip8_error code)
+{
+	if (code == CHIP8_ESDL)
+		fprintf(stderr, "chip-8: SDL: %s\n", SDL_GetError());
+	chip8_die(code);
+}
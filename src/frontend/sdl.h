@@ -0,0 +1,20 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_FRONTEND_SDL_H
+#define CHIP8_FRONTEND_SDL_H
+
+#include "utils/error.h"
+
+/**
+ * @brief Print error message from error code and exit with status.
+ *
+ * @note Like #chip8_die(), but also prints what SDL2 reported for
+ *       #CHIP8_ESDL, which the SDL-free core knows nothing about.
+ *
+ * @param[in] code Error code to obtain error message from.
+ */
+void chip8_sdl_die(chip8_error code);
+
+#endif /* CHIP8_FRONTEND_SDL_H */
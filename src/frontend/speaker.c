@@ -2,10 +2,11 @@
  * SPDX-License-Identifier: MIT
  */
 #include <stdint.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "SDL.h"
-#include "core/audio.h"
+#include "frontend/speaker.h"
 #include "utils/error.h"
 
 #define CHIP8_AMPLITUDE 28000
@@ -24,11 +25,11 @@ static void chip8_beep(void *data, uint8_t *stream, int slen)
 	}
 }
 
-chip8_error chip8_audio_init(chip8_audio **audio)
+chip8_error chip8_speaker_init(chip8_speaker **speaker)
 {
-	chip8_audio *new = NULL;
+	chip8_speaker *new = NULL;
 	chip8_error flag = CHIP8_EOK;
-	if (audio == NULL)
+	if (speaker == NULL)
 		return CHIP8_EINVAL;
 
 	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
@@ -47,28 +48,26 @@ chip8_error chip8_audio_init(chip8_audio **audio)
 	new->want.samples = 2048;
 	new->want.callback = chip8_beep;
 	new->want.userdata = &new->sample_nr;
-	if (SDL_OpenAudio(&new->want, &new->have) < 0)
-		return CHIP8_ESDL;
+	if (SDL_OpenAudio(&new->want, &new->have) < 0) {
+		flag = CHIP8_ESDL;
+		goto error;
+	}
+	*speaker = new;
 	goto done;
 error:
-	chip8_audio_free(new);
+	chip8_speaker_free(new);
 	new = NULL;
 done:
 	return flag;
 }
 
-void chip8_audio_play(void)
-{
-	SDL_PauseAudio(0);
-}
-
-void chip8_audio_pause(void)
+void chip8_speaker_beep(bool beep)
 {
-	SDL_PauseAudio(1);
+	SDL_PauseAudio(beep ? 0 : 1);
 }
 
-void chip8_audio_free(chip8_audio *audio)
+void chip8_speaker_free(chip8_speaker *speaker)
 {
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
-	free(audio);
+	free(speaker);
 }
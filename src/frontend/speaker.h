@@ -0,0 +1,47 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_FRONTEND_SPEAKER_H
+#define CHIP8_FRONTEND_SPEAKER_H
+
+#include <stdbool.h>
+
+#include "SDL.h"
+#include "utils/error.h"
+
+/**
+ * @brief SDL2 speaker beeping while the CHIP-8 sound timer runs.
+ */
+typedef struct {
+	SDL_AudioSpec want; /**< Audio specs we want. */
+	SDL_AudioSpec have; /**< Audio specs we got. */
+	int sample_nr;      /**< Current sample count. */
+} chip8_speaker;
+
+/**
+ * @brief Initialize SDL2 audio sub-system and speaker.
+ *
+ * @pre speaker cannot be NULL.
+ * @post speaker will be opened and paused.
+ *
+ * @param[in,out] speaker Pointer to speaker context.
+ * @return CHIP8_EOK on success or chip8_error on failure.
+ */
+chip8_error chip8_speaker_init(chip8_speaker **speaker);
+
+/**
+ * @brief Play or pause speaker.
+ *
+ * @param[in] beep True to play, false to pause.
+ */
+void chip8_speaker_beep(bool beep);
+
+/**
+ * @brief Deallocate speaker and SDL2 audio sub-system.
+ *
+ * @param[in,out] speaker Pointer to speaker context to free.
+ */
+void chip8_speaker_free(chip8_speaker *speaker);
+
+#endif /* CHIP8_FRONTEND_SPEAKER_H */
@@ -0,0 +1,419 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "SDL.h"
+#include "core/frame.h"
+#include "core/triple.h"
+#include "frontend/window.h"
+#include "utils/auxfun.h"
+#include "utils/error.h"
+
+#define CHIP8_DEFAULT_SCALE 10
+
+/**
+ * @brief Mark window damaged whenever SDL2 may have thrown its contents away.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static int chip8_window_watch(void *data, SDL_Event *event)
+{
+	chip8_window *window = data;
+
+	if (event->type == SDL_WINDOWEVENT &&
+	    (event->window.event == SDL_WINDOWEVENT_EXPOSED ||
+	     event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED))
+		__atomic_store_n(&window->damaged, true, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/**
+ * @brief Add to a statistics counter, which other threads may be reading.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_window_count(uint64_t *counter, uint64_t amount)
+{
+	__atomic_fetch_add(counter, amount, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Create renderer of window, falling back to software rendering.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static SDL_Renderer *chip8_window_renderer(SDL_Window *window,
+		                           unsigned int flags)
+{
+	SDL_Renderer *renderer = NULL;
+	Uint32 vsync = (flags & CHIP8_WINDOW_VSYNC) ?
+		       SDL_RENDERER_PRESENTVSYNC : 0;
+
+	if ((flags & CHIP8_WINDOW_SOFTWARE) == 0) {
+		renderer = SDL_CreateRenderer(window, -1,
+				              SDL_RENDERER_ACCELERATED | vsync);
+		if (renderer != NULL)
+			return renderer;
+		chip8_debug("no accelerated renderer, using software");
+	}
+	return SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE | vsync);
+}
+
+/**
+ * @brief Upload rows of video to texture, count rows starting at row first.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_window_upload(chip8_window *window,
+		                       const chip8_video *video,
+				       unsigned int first, unsigned int count)
+{
+	const int width = chip8_video_width(video) * sizeof(uint32_t);
+	SDL_Rect rect = { 0, first, chip8_video_width(video), count };
+	uint32_t *rows = NULL;
+	void *pixels = NULL;
+	int pitch = 0;
+
+	if (window->flags & CHIP8_WINDOW_UPDATE) {
+		rows = window->buffer + first * chip8_video_width(video);
+		chip8_video_rgba_rows(video, rows, first, count);
+		if (SDL_UpdateTexture(window->texture, &rect, rows, width) < 0)
+			return CHIP8_ESDL;
+		return CHIP8_EOK;
+	}
+
+	/* Texture rows may be padded, so expand one row at a time... */
+	if (SDL_LockTexture(window->texture, &rect, &pixels, &pitch) < 0)
+		return CHIP8_ESDL;
+	for (unsigned int y = 0; y < count; y++)
+		chip8_video_rgba_rows(video,
+				      (uint32_t *)((uint8_t *)pixels + y * pitch),
+				      first + y, 1);
+	SDL_UnlockTexture(window->texture);
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Create renderer and texture of window.
+ *
+ * @note INTERNAL USE ONLY! Runs on whichever thread presents frames.
+ */
+static chip8_error chip8_window_setup(chip8_window *window)
+{
+	window->renderer = chip8_window_renderer(window->window, window->flags);
+	if (window->renderer == NULL)
+		return CHIP8_ESDL;
+
+	window->texture = SDL_CreateTexture(window->renderer,
+			                    SDL_PIXELFORMAT_RGBA8888,
+					    (window->flags & CHIP8_WINDOW_UPDATE) ?
+					    SDL_TEXTUREACCESS_STATIC :
+					    SDL_TEXTUREACCESS_STREAMING,
+					    CHIP8_VIDEO_HIRES_WIDTH,
+					    CHIP8_VIDEO_HIRES_HEIGHT);
+	if (window->texture == NULL)
+		return CHIP8_ESDL;
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Destroy renderer and texture of window.
+ *
+ * @note INTERNAL USE ONLY! Runs on whichever thread presents frames.
+ */
+static void chip8_window_teardown(chip8_window *window)
+{
+	if (window->texture != NULL)
+		SDL_DestroyTexture(window->texture);
+	if (window->renderer != NULL)
+		SDL_DestroyRenderer(window->renderer);
+	window->texture = NULL;
+	window->renderer = NULL;
+}
+
+/**
+ * @brief Upload dirty rows of video, and present them.
+ *
+ * @note INTERNAL USE ONLY! Runs on whichever thread presents frames.
+ */
+static chip8_error chip8_window_present(chip8_window *window,
+		                        chip8_video *video)
+{
+	const int height = chip8_video_height(video);
+	const int pitch = chip8_video_width(video) * sizeof(uint32_t);
+	SDL_Rect area = { 0, 0, chip8_video_width(video), height };
+	chip8_error flag = CHIP8_EOK;
+	uint64_t dirty = 0;
+	uint64_t start = 0;
+	int rows = 0;
+
+	chip8_window_count(&window->stats.frames, 1);
+	dirty = video->dirty;
+	if (__atomic_exchange_n(&window->damaged, false, __ATOMIC_RELAXED))
+		dirty = CHIP8_VIDEO_DIRTY;
+	video->dirty = 0;
+	if (dirty == 0) {
+		chip8_window_count(&window->stats.skipped, 1);
+		return CHIP8_EOK;
+	}
+
+	/* Upload every run of dirty rows as a single rectangle... */
+	start = chip8_now();
+	for (int y = 0; y < height; y += rows) {
+		rows = 1;
+		if (((dirty >> y) & 1) == 0)
+			continue;
+		while (y + rows < height &&
+		       ((dirty >> (y + rows)) & 1) != 0)
+			rows++;
+
+		flag = chip8_window_upload(window, video, y, rows);
+		if (flag != CHIP8_EOK)
+			return flag;
+		chip8_window_count(&window->stats.bytes, rows * pitch);
+	}
+	chip8_window_count(&window->stats.upload_ns,
+			   chip8_now() - start);
+
+	SDL_RenderClear(window->renderer);
+	SDL_RenderCopy(window->renderer, window->texture, &area, NULL);
+	SDL_RenderPresent(window->renderer);
+	return CHIP8_EOK;
+}
+
+/**
+ * @brief Render thread, presenting the newest published frame at 60Hz.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static int chip8_window_thread(void *data)
+{
+	chip8_window *window = data;
+	chip8_video *shown = &window->shown;
+	chip8_frame *frame = NULL;
+	chip8_video *video = NULL;
+	chip8_error flag = CHIP8_EOK;
+	unsigned int pitch = 0;
+	unsigned int words = 0;
+	bool fresh = false;
+
+	flag = chip8_window_setup(window);
+	if (flag == CHIP8_EOK)
+		flag = chip8_frame_init(&frame, 0);
+	__atomic_store_n(&window->status, flag, __ATOMIC_RELAXED);
+	__atomic_store_n(&window->ready, true, __ATOMIC_RELEASE);
+
+	while (flag == CHIP8_EOK &&
+	       !__atomic_load_n(&window->quit, __ATOMIC_ACQUIRE)) {
+		/* Frames skipped on the way may have touched other rows, so
+		 * compare against what was presented last... */
+		video = chip8_triple_take(window->triple, &fresh);
+		if (fresh && video->hires != shown->hires) {
+			shown->hires = video->hires;
+			shown->dirty = CHIP8_VIDEO_DIRTY;
+		}
+		pitch = chip8_video_pitch(shown);
+		words = chip8_video_height(shown) * pitch;
+		for (unsigned int n = 0; fresh && n < words; n++) {
+			if (video->rows[n] != shown->rows[n])
+				shown->dirty |= (uint64_t)1 << (n / pitch);
+			shown->rows[n] = video->rows[n];
+		}
+		if (fresh && (video->palette[0] != shown->palette[0] ||
+			      video->palette[1] != shown->palette[1])) {
+			chip8_video_palette(shown, video->palette[0],
+					    video->palette[1]);
+		}
+
+		flag = chip8_window_present(window, shown);
+		if (flag != CHIP8_EOK)
+			__atomic_store_n(&window->status, flag,
+					 __ATOMIC_RELAXED);
+		chip8_frame_wait(frame);
+	}
+
+	chip8_frame_free(frame);
+	chip8_window_teardown(window);
+	return 0;
+}
+
+/**
+ * @brief Start render thread, and wait for it to set up its renderer.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_window_start(chip8_window *window)
+{
+	chip8_error flag = CHIP8_EOK;
+
+	flag = chip8_triple_init(&window->triple);
+	if (flag != CHIP8_EOK)
+		return flag;
+	chip8_video_palette(&window->shown, CHIP8_VIDEO_OFF, CHIP8_VIDEO_ON);
+
+	window->thread = SDL_CreateThread(chip8_window_thread, "chip8-render",
+			                  window);
+	if (window->thread == NULL)
+		return CHIP8_ESDL;
+	while (!__atomic_load_n(&window->ready, __ATOMIC_ACQUIRE))
+		SDL_Delay(1);
+	return __atomic_load_n(&window->status, __ATOMIC_RELAXED);
+}
+
+chip8_error chip8_window_init(chip8_window **window, unsigned int scale,
+		              unsigned int flags)
+{
+	chip8_window *newwin = NULL;
+	chip8_error flag = CHIP8_EOK;
+
+	if (window == NULL)
+		return CHIP8_EINVAL;
+
+	if (scale == 0)
+		scale = CHIP8_DEFAULT_SCALE;
+
+	if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
+		return CHIP8_ESDL;
+
+	newwin = calloc(1, sizeof *newwin);
+	if (newwin == NULL) {
+		flag = CHIP8_ENOMEM;
+		goto error;
+	}
+
+	newwin->window = SDL_CreateWindow("CHIP-8",
+			                  SDL_WINDOWPOS_UNDEFINED,
+					  SDL_WINDOWPOS_UNDEFINED,
+					  CHIP8_VIDEO_WIDTH * scale,
+					  CHIP8_VIDEO_HEIGHT * scale,
+					  SDL_WINDOW_SHOWN);
+	if (newwin->window == NULL) {
+		flag = CHIP8_ESDL;
+		goto error;
+	}
+
+	newwin->flags = flags;
+	newwin->damaged = true;
+	if (flags & CHIP8_WINDOW_THREAD)
+		flag = chip8_window_start(newwin);
+	else
+		flag = chip8_window_setup(newwin);
+	if (flag != CHIP8_EOK)
+		goto error;
+
+	SDL_AddEventWatch(chip8_window_watch, newwin);
+	*window = newwin;
+	chip8_debugx("setup new window %p\n", (void *)(*window));
+	goto done;
+error:
+	chip8_window_free(newwin);
+	newwin = NULL;
+done:
+	return flag;
+}
+
+chip8_error chip8_window_render(chip8_window *window, chip8_video *video)
+{
+	chip8_video *back = NULL;
+
+	if (window == NULL || video == NULL)
+		return CHIP8_EINVAL;
+
+	if (window->thread == NULL)
+		return chip8_window_present(window, video);
+
+	/* Hand a copy to the render thread, which works out dirty rows on its
+	 * own... */
+	back = chip8_triple_back(window->triple);
+	*back = *video;
+	video->dirty = 0;
+	chip8_triple_publish(window->triple);
+	return __atomic_load_n(&window->status, __ATOMIC_RELAXED);
+}
+
+chip8_error chip8_window_stat(const chip8_window *window,
+		              chip8_window_stats *stats)
+{
+	if (window == NULL || stats == NULL)
+		return CHIP8_EINVAL;
+
+	stats->frames = __atomic_load_n(&window->stats.frames,
+					__ATOMIC_RELAXED);
+	stats->skipped = __atomic_load_n(&window->stats.skipped,
+					 __ATOMIC_RELAXED);
+	stats->bytes = __atomic_load_n(&window->stats.bytes, __ATOMIC_RELAXED);
+	stats->upload_ns = __atomic_load_n(&window->stats.upload_ns,
+					   __ATOMIC_RELAXED);
+	return CHIP8_EOK;
+}
+
+void chip8_window_free(chip8_window *window)
+{
+	chip8_debug("shutdown SDL2 video sub-system");
+	if (window != NULL) {
+		chip8_debugx("rendered %llu frames, skipped %llu, uploaded "
+			     "%llu bytes in %llu ns\n",
+			     (unsigned long long)window->stats.frames,
+			     (unsigned long long)window->stats.skipped,
+			     (unsigned long long)window->stats.bytes,
+			     (unsigned long long)window->stats.upload_ns);
+		SDL_DelEventWatch(chip8_window_watch, window);
+		if (window->thread != NULL) {
+			__atomic_store_n(&window->quit, true, __ATOMIC_RELEASE);
+			SDL_WaitThread(window->thread, NULL);
+		}
+		chip8_triple_free(window->triple);
+		chip8_window_teardown(window);
+		if (window->window != NULL)
+			SDL_DestroyWindow(window->window);
+	}
+	SDL_QuitSubSystem(SDL_INIT_VIDEO);
+
+	chip8_debug("free CHIP-8 window");
+	free(window);
+}
+
+/**
+ * @brief Open window of display.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_window_open(chip8_display *display)
+{
+	chip8_window *window = NULL;
+	chip8_error flag = CHIP8_EOK;
+
+	flag = chip8_window_init(&window, display->config.scale,
+				 display->config.flags);
+	display->data = window;
+	return flag;
+}
+
+/**
+ * @brief Render frame in window of display.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static chip8_error chip8_window_show(chip8_display *display,
+		                     chip8_video *video)
+{
+	return chip8_window_render(display->data, video);
+}
+
+/**
+ * @brief Close window of display.
+ *
+ * @note INTERNAL USE ONLY!
+ */
+static void chip8_window_close(chip8_display *display)
+{
+	if (display->data != NULL)
+		chip8_window_free(display->data);
+}
+
+const chip8_display_backend chip8_window_display = {
+	"sdl", chip8_window_open, chip8_window_show, chip8_window_close
+};
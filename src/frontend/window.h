@@ -0,0 +1,127 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef CHIP8_FRONTEND_WINDOW_H
+#define CHIP8_FRONTEND_WINDOW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "SDL.h"
+#include "core/display.h"
+#include "core/triple.h"
+#include "core/video.h"
+#include "utils/error.h"
+
+#define CHIP8_WINDOW_VSYNC    0x1 /**< Sync presents to display refresh. */
+#define CHIP8_WINDOW_SOFTWARE 0x2 /**< Render without acceleration. */
+#define CHIP8_WINDOW_UPDATE   0x4 /**< Copy rows in with SDL_UpdateTexture(). */
+#define CHIP8_WINDOW_THREAD   0x8 /**< Present from a render thread. */
+
+/**
+ * @brief Rendering statistics of a window.
+ */
+typedef struct {
+	uint64_t frames;    /**< Calls to chip8_window_render(). */
+	uint64_t skipped;   /**< Frames left unpresented since nothing changed. */
+	uint64_t bytes;     /**< Bytes uploaded to texture. */
+	uint64_t upload_ns; /**< Nanoseconds spent uploading to texture. */
+} chip8_window_stats;
+
+/**
+ * @brief SDL2 window presenting CHIP-8 video.
+ *
+ * @note Only rows marked dirty in the video are converted and uploaded, and
+ *       frames without any dirty row are not presented at all. By default
+ *       rows are expanded straight into locked streaming texture memory,
+ *       #CHIP8_WINDOW_UPDATE expands them into buffer first and copies them
+ *       in with SDL_UpdateTexture() instead.
+ *
+ *       The texture is created once at the high resolution size, and low
+ *       resolution frames use only its top left corner, so switching
+ *       resolution never recreates it.
+ *
+ *       With #CHIP8_WINDOW_THREAD, a render thread owns the renderer and
+ *       texture, and presents the newest frame handed over through a
+ *       lock-free triple buffer at 60Hz, so emulation never waits on
+ *       presenting a frame.
+ */
+typedef struct {
+	SDL_Window *window;       /**< SDL window pointer. */
+	SDL_Renderer *renderer;   /**< SDL renderer pointer. */
+	SDL_Texture *texture;     /**< SDL texture pointer. */
+	chip8_window_stats stats; /**< Rendering statistics. */
+	unsigned int flags;       /**< CHIP8_WINDOW_* flags of window. */
+	bool damaged;             /**< Window contents must be redrawn. */
+	SDL_Thread *thread;       /**< Render thread, if any. */
+	chip8_triple *triple;     /**< Frames handed to render thread. */
+	chip8_video shown;        /**< Frame render thread presented last. */
+	chip8_error status;       /**< First failure of render thread. */
+	bool ready;               /**< Render thread finished setting up. */
+	bool quit;                /**< Render thread must stop. */
+
+	/** Texture buffer data, only used with #CHIP8_WINDOW_UPDATE. */
+	uint32_t buffer[CHIP8_VIDEO_HIRES_WIDTH * CHIP8_VIDEO_HIRES_HEIGHT];
+} chip8_window;
+
+/**
+ * @brief Create a new window.
+ *
+ * @note Set scale to 0 for default window size. Flags are any combination
+ *       of #CHIP8_WINDOW_VSYNC, #CHIP8_WINDOW_SOFTWARE,
+ *       #CHIP8_WINDOW_UPDATE, and #CHIP8_WINDOW_THREAD. Without
+ *       #CHIP8_WINDOW_SOFTWARE, an accelerated renderer is tried first, and
+ *       the software renderer is used if there is none.
+ *
+ * @pre window cannot be NULL.
+ * @post Will create a new window with a renderer and texture.
+ *
+ * @param[in,out] window Window pointer to initialize.
+ * @param[in] scale Scale of window to create.
+ * @param[in] flags CHIP8_WINDOW_* flags of window.
+ *
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_window_init(chip8_window **window, unsigned int scale,
+		              unsigned int flags);
+
+/**
+ * @brief Destroy window.
+ *
+ * @pre You must have called chip8_window_init() beforehand.
+ * @post Window will be freed.
+ *
+ * @param[in] window Window to destroy.
+ */
+void chip8_window_free(chip8_window *window);
+
+/**
+ * @brief Buffer and render dirty pixel data to window.
+ *
+ * @pre window and video must not be NULL.
+ * @post Dirty rows of video will be cleared.
+ *
+ * @param[in] window Window to render pixel data into.
+ * @param[in,out] video Video context to render pixel data from.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_window_render(chip8_window *window, chip8_video *video);
+
+/**
+ * @brief Get rendering statistics of window.
+ *
+ * @pre window and stats must not be NULL.
+ *
+ * @param[in] window Window to get statistics of.
+ * @param[out] stats Rendering statistics of window.
+ * @return 0 (CHIP8_EOK) for success or chip8_error for failure.
+ */
+chip8_error chip8_window_stat(const chip8_window *window,
+		              chip8_window_stats *stats);
+
+/** Display backend presenting frames in a window, with scale and flags of
+ *  #chip8_display_config. Backend state is the #chip8_window. */
+extern const chip8_display_backend chip8_window_display;
+
+#endif /* CHIP8_FRONTEND_WINDOW_H */
@@ -7,24 +7,101 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <signal.h>
 
-#include "SDL.h"
+#include "utils/auxfun.h"
 #include "utils/error.h"
 #include "core/keypad.h"
 #include "core/video.h"
-#include "core/audio.h"
 #include "core/cpu.h"
+#include "core/movie.h"
+#include "core/prof.h"
+#include "core/rewind.h"
+#include "core/trace.h"
+#include "core/frame.h"
+#include "core/display.h"
+#include "core/capture.h"
+#include "frontend/input.h"
+#include "frontend/sdl.h"
+#include "frontend/speaker.h"
+#include "frontend/window.h"
+
+#define CHIP8_MAIN_PROF_TOP 32 /**< Addresses listed by profile reports. */
+
+/**
+ * @brief Display backends selectable with -b.
+ */
+static const chip8_display_backend *const chip8_main_backends[] = {
+	&chip8_window_display,
+	&chip8_display_null,
+	&chip8_display_ppm,
+	&chip8_display_pgm,
+	&chip8_display_pbm
+};
+
+/**
+ * @brief Set on SIGINT or SIGTERM to end a headless run cleanly.
+ */
+static volatile sig_atomic_t chip8_main_stop = 0;
+
+/**
+ * @brief Stop headless loop on signal, so outputs are still written.
+ */
+static void chip8_main_signal(int sig)
+{
+	(void)sig;
+	chip8_main_stop = 1;
+}
 
 static void usage(void)
 {
-	printf("Usage: chip-8 [-l <rom>] [-f <ins/sec>] [-s <scale>] [-v] [-h]\n"
+	printf("Usage: chip-8 [-l <rom>] [-f <ins/sec>] [-s <scale>] [-e <engine>]"
+	       " [-r <seed>] [-m <movie>] [-p <file>]\n"
+	       "              [-t <trace>] [-d <trace>] [-c <off>:<on>] [-V] [-S]"
+	       " [-U] [-T] [-i]\n"
+	       "              [-b <backend>[:<file>]] [-n <frames>] [-H <file>]"
+	       " [-C <file>]\n"
+	       "              [-v] [-h]\n"
 	       "Simple CHIP-8 emulator.\n\n"
 	       "Options:\n"
 	       "  -l <rom>     CHIP-8 ROM to load and process.\n"
 	       "  -f <ins/sec> CPU speed (instructions per second).\n"
 	       "  -s <scale>   Scale factor for window.\n"
+	       "  -e <engine>  Execution engine, interp (default) or jit.\n"
+	       "  -r <seed>    Random number seed (default: current time).\n"
+	       "  -m <movie>   Record input movie to file, disables rewind.\n"
+	       "               Every backend but sdl records no keys.\n"
+	       "  -p <file>    Profile instructions, writing report to file on\n"
+	       "               exit. Written as JSON if file ends in .json.\n"
+	       "  -t <trace>   Record binary instruction trace to file.\n"
+	       "  -d <trace>   Print instruction trace as text and exit.\n"
+	       "  -c <off>:<on> RGBA8888 colors of unlit and lit pixels, such as\n"
+	       "               0x000000FF:0xFFFFFFFF.\n"
+	       "  -V           Sync frames to display refresh (vsync).\n"
+	       "  -S           Render in software, without acceleration.\n"
+	       "  -U           Copy pixels into texture with SDL_UpdateTexture\n"
+	       "               instead of writing them into it directly.\n"
+	       "  -T           Render on the emulation thread instead of a\n"
+	       "               render thread.\n"
+	       "  -i           Print rendering statistics on exit.\n"
+	       "  -b <backend> Present frames with sdl (default), null, or\n"
+	       "               write them to file (default: stdout) with ppm,\n"
+	       "               pgm, or pbm, such as pbm:frames.pbm. Every\n"
+	       "               backend but sdl runs frames back to back,\n"
+	       "               without a window, input, or sound.\n"
+	       "  -n <frames>  Quit after presenting this many frames. Every\n"
+	       "               backend but sdl otherwise runs until\n"
+	       "               SIGINT or SIGTERM.\n"
+	       "  -H <file>    Log 64-bit hash of every presented frame to file,\n"
+	       "               - for stdout.\n"
+	       "  -C <file>    Capture frames to file, - for stdout, scaled by\n"
+	       "               -s. Written as Y4M if file ends in .y4m, or as\n"
+	       "               raw RGBA otherwise.\n"
 	       "  -v           Print version info.\n"
-	       "  -h           Print this help info.\n");
+	       "  -h           Print this help info.\n\n"
+	       "Hold backspace to rewind.\n");
 }
 
 static void version(void)
@@ -33,6 +110,101 @@ static void version(void)
 	       "Written by Jason Pena, Nate Le, and John Cully\n");
 }
 
+/**
+ * @brief Write profile to path, as JSON if path ends in ".json".
+ */
+static chip8_error chip8_main_profile(const chip8_prof *prof, const char *path)
+{
+	chip8_error flag = CHIP8_EOK;
+	size_t len = strlen(path);
+	FILE *file = fopen(path, "w");
+
+	if (file == NULL)
+		return CHIP8_ENOFILE;
+
+	if (len >= 5 && strcmp(path + len - 5, ".json") == 0)
+		flag = chip8_prof_json(prof, file);
+	else
+		flag = chip8_prof_report(prof, file, CHIP8_MAIN_PROF_TOP);
+	if (fclose(file) != 0 && flag == CHIP8_EOK)
+		flag = CHIP8_EIO;
+	return flag;
+}
+
+/**
+ * @brief Find display backend named by arg, which may be followed by ':' and
+ *        the file to write frames to.
+ */
+static const chip8_display_backend *chip8_main_backend(const char *arg,
+		                                       const char **path)
+{
+	const char *colon = strchr(arg, ':');
+	size_t len = (colon != NULL) ? (size_t)(colon - arg) : strlen(arg);
+	const char *name = NULL;
+
+	*path = (colon != NULL) ? colon + 1 : NULL;
+	for (size_t n = 0; n < chip8_arrsize(chip8_main_backends); n++) {
+		name = chip8_main_backends[n]->name;
+		if (strlen(name) == len && strncmp(name, arg, len) == 0)
+			return chip8_main_backends[n];
+	}
+	return NULL;
+}
+
+/**
+ * @brief Print rendering statistics of display.
+ */
+static void chip8_main_info(const chip8_display *display)
+{
+	const chip8_window *window = display->data;
+	chip8_window_stats stats;
+	uint64_t drawn = 0;
+
+	if (display->backend != &chip8_window_display) {
+		printf("frames: %llu, repeated: %llu (%s)\n",
+		       (unsigned long long)display->frames,
+		       (unsigned long long)display->repeats,
+		       display->backend->name);
+		return;
+	}
+
+	chip8_window_stat(window, &stats);
+	drawn = stats.frames - stats.skipped;
+	printf("frames: %llu, presented: %llu, skipped: %llu\n"
+	       "uploaded: %llu bytes, %.0f ns per presented frame (%s)\n",
+	       (unsigned long long)stats.frames, (unsigned long long)drawn,
+	       (unsigned long long)stats.skipped,
+	       (unsigned long long)stats.bytes,
+	       drawn ? (double)stats.upload_ns / drawn : 0.0,
+	       (window->flags & CHIP8_WINDOW_UPDATE) ? "update" : "stream");
+}
+
+/**
+ * @brief Print statistics of capture.
+ */
+static void chip8_main_capinfo(const chip8_capture *capture)
+{
+	chip8_capture_stats stats;
+
+	chip8_capture_stat(capture, &stats);
+	printf("captured: %llu frames, queued: %llu, repeated: %llu, "
+	       "dropped: %llu\n", (unsigned long long)stats.frames,
+	       (unsigned long long)stats.queued,
+	       (unsigned long long)stats.repeats,
+	       (unsigned long long)stats.dropped);
+}
+
+/**
+ * @brief Log hash of frame display presented last.
+ */
+static void chip8_main_hash(FILE *file, const chip8_display *display)
+{
+	if (file != NULL)
+		fprintf(file, "%llu %016llx\n",
+			(unsigned long long)display->frames,
+			(unsigned long long)display->hash);
+}
+
 /**
  * @brief Starting point of CHIP-8 emulator.
  *
@@ -42,16 +214,43 @@ int main(int argc, char **argv)
 {
 	int opt = 0;
 	int freq = 0;
-	int scale = 0;
 	char *rom = NULL;
+	char *record = NULL;
+	char *profile = NULL;
+	char *tracing = NULL;
+	char *capturing = NULL;
+	uint64_t seed = time(NULL);
+	chip8_engine engine = CHIP8_ENGINE_INTERP;
 	chip8_video *video = NULL;
 	chip8_keypad *keypad = NULL;
-	chip8_audio *audio = NULL;
+	chip8_display *display = NULL;
+	const chip8_display_backend *backend = &chip8_window_display;
+	chip8_display_config config = { NULL, 0, CHIP8_WINDOW_THREAD };
+	chip8_speaker *speaker = NULL;
 	chip8_cpu *cpu = NULL;
+	chip8_rewind *rewind = NULL;
+	chip8_movie *movie = NULL;
+	chip8_prof *prof = NULL;
+	chip8_trace *trace = NULL;
+	chip8_frame *frame = NULL;
+	chip8_capture *capture = NULL;
+	chip8_capture_format format = CHIP8_CAPTURE_RGBA;
 	chip8_error flag = CHIP8_EOK;
+	struct sigaction action;
+	uint32_t off = CHIP8_VIDEO_OFF;
+	uint32_t on = CHIP8_VIDEO_ON;
+	char *end = NULL;
+	unsigned long frames = 0;
+	size_t len = 0;
+	FILE *hashes = NULL;
+	bool headless = false;
+	bool info = false;
 	bool quit = false;
+	bool back = false;
+	uint16_t keys = 0;
 
-	while ((opt = getopt(argc, argv, "l:f:s:vh")) != -1) {
+	while ((opt = getopt(argc, argv,
+			     "l:f:s:e:r:m:p:t:d:c:b:n:H:C:VSUTivh")) != -1) {
 		switch (opt) {
 		case 'l':
 			rom = strdup(optarg);
@@ -60,7 +259,77 @@ int main(int argc, char **argv)
 			freq = atoi(optarg);
 			break;
 		case 's':
-			scale = atoi(optarg);
+			config.scale = atoi(optarg);
+			break;
+		case 'e':
+			if (strcmp(optarg, "interp") == 0) {
+				engine = CHIP8_ENGINE_INTERP;
+			} else if (strcmp(optarg, "jit") == 0) {
+				engine = CHIP8_ENGINE_JIT;
+			} else {
+				usage();
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'r':
+			seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'm':
+			record = strdup(optarg);
+			break;
+		case 'p':
+			profile = strdup(optarg);
+			break;
+		case 't':
+			tracing = strdup(optarg);
+			break;
+		case 'd':
+			flag = chip8_trace_decode(optarg, stdout);
+			if (flag != CHIP8_EOK)
+				chip8_die(flag);
+			exit(EXIT_SUCCESS);
+			break;
+		case 'c':
+			off = strtoul(optarg, &end, 0);
+			if (*end != ':') {
+				usage();
+				exit(EXIT_FAILURE);
+			}
+			on = strtoul(end + 1, NULL, 0);
+			break;
+		case 'V':
+			config.flags |= CHIP8_WINDOW_VSYNC;
+			break;
+		case 'S':
+			config.flags |= CHIP8_WINDOW_SOFTWARE;
+			break;
+		case 'U':
+			config.flags |= CHIP8_WINDOW_UPDATE;
+			break;
+		case 'T':
+			config.flags &= ~CHIP8_WINDOW_THREAD;
+			break;
+		case 'i':
+			info = true;
+			break;
+		case 'b':
+			backend = chip8_main_backend(optarg, &config.path);
+			if (backend == NULL) {
+				usage();
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'n':
+			frames = strtoul(optarg, NULL, 0);
+			break;
+		case 'H':
+			hashes = (strcmp(optarg, "-") == 0) ?
+				 stdout : fopen(optarg, "w");
+			if (hashes == NULL)
+				chip8_die(CHIP8_ENOFILE);
+			break;
+		case 'C':
+			capturing = strdup(optarg);
 			break;
 		case 'h':
 			usage();
@@ -77,7 +346,34 @@ int main(int argc, char **argv)
 		}
 	}
 
-	flag = chip8_video_init(&video, scale);
+	flag = chip8_display_init(&display, backend, &config);
+	if (flag != CHIP8_EOK)
+		chip8_sdl_die(flag);
+
+	/* Only a window gets input and sound... */
+	headless = backend != &chip8_window_display;
+	if (headless) {
+		/* Without -n nothing else ends a headless run... */
+		memset(&action, 0, sizeof action);
+		action.sa_handler = chip8_main_signal;
+		action.sa_flags = SA_RESTART;
+		sigaction(SIGINT, &action, NULL);
+		sigaction(SIGTERM, &action, NULL);
+	} else {
+		flag = chip8_input_init();
+		if (flag != CHIP8_EOK)
+			chip8_sdl_die(flag);
+
+		flag = chip8_speaker_init(&speaker);
+		if (flag != CHIP8_EOK)
+			chip8_sdl_die(flag);
+	}
+
+	flag = chip8_video_init(&video);
+	if (flag != CHIP8_EOK)
+		chip8_die(flag);
+
+	flag = chip8_video_palette(video, off, on);
 	if (flag != CHIP8_EOK)
 		chip8_die(flag);
 
@@ -85,11 +381,15 @@ int main(int argc, char **argv)
 	if (flag != CHIP8_EOK)
 		chip8_die(flag);
 
-	flag = chip8_audio_init(&audio);
+	flag = chip8_cpu_init(&cpu, video, keypad, freq);
+	if (flag != CHIP8_EOK)
+		chip8_die(flag);
+
+	flag = chip8_cpu_seed(cpu, seed);
 	if (flag != CHIP8_EOK)
 		chip8_die(flag);
 
-	flag = chip8_cpu_init(&cpu, video, keypad, audio, freq);
+	flag = chip8_cpu_setengine(cpu, engine);
 	if (flag != CHIP8_EOK)
 		chip8_die(flag);
 
@@ -97,21 +397,140 @@ int main(int argc, char **argv)
 	if (flag != CHIP8_EOK)
 		chip8_die(flag);
 
+	flag = chip8_rewind_init(&rewind, 0, 0);
+	if (flag != CHIP8_EOK)
+		chip8_die(flag);
+
+	if (record != NULL) {
+		flag = chip8_movie_init(&movie, seed, cpu->opnum);
+		if (flag != CHIP8_EOK)
+			chip8_die(flag);
+	}
+
+	if (profile != NULL) {
+		flag = chip8_prof_init(&prof);
+		if (flag != CHIP8_EOK)
+			chip8_die(flag);
+		chip8_cpu_setprof(cpu, prof);
+	}
+
+	if (tracing != NULL) {
+		flag = chip8_trace_init(&trace, tracing, 0);
+		if (flag != CHIP8_EOK)
+			chip8_die(flag);
+		chip8_cpu_settrace(cpu, trace);
+	}
+
+	if (capturing != NULL) {
+		len = strlen(capturing);
+		if (len >= 4 && strcmp(capturing + len - 4, ".y4m") == 0)
+			format = CHIP8_CAPTURE_Y4M;
+		flag = chip8_capture_init(&capture, capturing, format,
+					  config.scale, 0);
+		if (flag != CHIP8_EOK)
+			chip8_die(flag);
+	}
+
+	flag = chip8_frame_init(&frame, 0);
+	if (flag != CHIP8_EOK)
+		chip8_die(flag);
+
+	/* Nothing waits on a window, so run frames back to back on the
+	 * virtual clock... */
+	while (headless && !quit) {
+		if (movie != NULL)
+			flag = chip8_movie_record(movie, cpu, 0);
+		else
+			flag = chip8_cpu_frame(cpu);
+		if (flag != CHIP8_EOK)
+			chip8_die(flag);
+		flag = chip8_display_present(display, video);
+		if (flag != CHIP8_EOK)
+			chip8_die(flag);
+		chip8_main_hash(hashes, display);
+		if (capture != NULL) {
+			chip8_capture_sync(capture);
+			chip8_capture_push(capture, video);
+		}
+		quit = chip8_main_stop ||
+		       (frames != 0 && display->frames >= frames);
+	}
+
+	/* CPU catches up on whatever wall-clock time passed since the last
+	 * frame, so only present, and sleep, once per frame... */
 	while (!quit) {
-		chip8_keypad_poll(&quit);
-		chip8_keypad_process(keypad);
-		flag = chip8_cpu_cycle(cpu);
+		chip8_input_poll(&quit);
+		chip8_input_rewind(&back);
+		if (movie != NULL) {
+			/* Keys only change between frames of a movie... */
+			chip8_input_keys(&keys);
+			flag = chip8_movie_cycle(movie, cpu, keys);
+		} else if (back) {
+			flag = chip8_rewind_cycle(rewind, cpu);
+		} else {
+			chip8_input_process(keypad);
+			flag = chip8_cpu_cycle(cpu);
+			if (flag == CHIP8_EOK)
+				flag = chip8_rewind_push(rewind, cpu);
+		}
 		if (flag != CHIP8_EOK)
 			chip8_die(flag);
-		flag = chip8_video_render(video);
+		chip8_speaker_beep(cpu->st != 0);
+		flag = chip8_display_present(display, video);
+		if (flag != CHIP8_EOK)
+			chip8_sdl_die(flag);
+		chip8_main_hash(hashes, display);
+		if (capture != NULL)
+			chip8_capture_push(capture, video);
+		chip8_frame_wait(frame);
+		quit |= frames != 0 && display->frames >= frames;
+	}
+
+	if (movie != NULL) {
+		flag = chip8_movie_save(movie, record);
+		if (flag != CHIP8_EOK)
+			chip8_die(flag);
+	}
+
+	if (prof != NULL) {
+		flag = chip8_main_profile(prof, profile);
 		if (flag != CHIP8_EOK)
 			chip8_die(flag);
 	}
 
+	if (info)
+		chip8_main_info(display);
+	if (info && capture != NULL)
+		chip8_main_capinfo(capture);
+
+	flag = chip8_capture_free(capture);
+	if (flag != CHIP8_EOK)
+		chip8_die(flag);
+
+	chip8_cpu_settrace(cpu, NULL);
+	flag = chip8_trace_free(trace);
+	if (flag != CHIP8_EOK)
+		chip8_die(flag);
+
+	if (hashes != NULL && hashes != stdout)
+		fclose(hashes);
 	free(rom);
+	free(record);
+	free(profile);
+	free(tracing);
+	free(capturing);
+	chip8_cpu_setprof(cpu, NULL);
+	chip8_prof_free(prof);
+	chip8_frame_free(frame);
+	chip8_movie_free(movie);
+	chip8_rewind_free(rewind);
 	chip8_keypad_free(keypad);
 	chip8_video_free(video);
-	chip8_audio_free(audio);
 	chip8_cpu_free(cpu);
+	if (!headless) {
+		chip8_speaker_free(speaker);
+		chip8_input_free();
+	}
+	chip8_display_free(display);
 	return 0;
 }
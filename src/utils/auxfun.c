@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "utils/error.h"
 #include "utils/auxfun.h"
@@ -40,3 +41,47 @@ chip8_error chip8_readrom(const char *path, uint8_t **buffer, size_t *size)
 	*buffer = newbuf;
 	return CHIP8_EOK;
 }
+
+uint64_t chip8_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+void chip8_putle(uint8_t **at, uint64_t value, unsigned int bytes)
+{
+	for (unsigned int n = 0; n < bytes; n++)
+		*(*at)++ = value >> (8 * n);
+}
+
+uint64_t chip8_getle(const uint8_t **at, unsigned int bytes)
+{
+	uint64_t value = 0;
+
+	for (unsigned int n = 0; n < bytes; n++)
+		value |= (uint64_t)*(*at)++ << (8 * n);
+	return value;
+}
+
+void chip8_putvar(uint8_t **at, uint64_t value)
+{
+	while (value >= 0x80) {
+		*(*at)++ = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	*(*at)++ = value;
+}
+
+uint64_t chip8_getvar(const uint8_t **at, const uint8_t *end)
+{
+	uint64_t value = 0;
+
+	for (unsigned int shift = 0; *at < end && shift < 64; shift += 7) {
+		value |= (uint64_t)(**at & 0x7F) << shift;
+		if ((*(*at)++ & 0x80) == 0)
+			break;
+	}
+	return value;
+}
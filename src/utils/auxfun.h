@@ -67,4 +67,60 @@
  */
 chip8_error chip8_readrom(const char *path, uint8_t **buffer, size_t *size);
 
+/**
+ * @brief Get monotonic wall-clock time.
+ *
+ * @return Nanoseconds since some unspecified starting point.
+ */
+uint64_t chip8_now(void);
+
+/**
+ * @brief Store little-endian value of some bytes and advance cursor.
+ *
+ * @pre @p at MUST point to a cursor with room for @p bytes bytes.
+ * @post @p at WILL point past the stored bytes.
+ *
+ * @param[in,out] at Cursor to store value at.
+ * @param[in] value Value to store, only its low @p bytes bytes are kept.
+ * @param[in] bytes Bytes to store, at most 8.
+ */
+void chip8_putle(uint8_t **at, uint64_t value, unsigned int bytes);
+
+/**
+ * @brief Load little-endian value of some bytes and advance cursor.
+ *
+ * @pre @p at MUST point to a cursor with @p bytes bytes left.
+ * @post @p at WILL point past the loaded bytes.
+ *
+ * @param[in,out] at Cursor to load value from.
+ * @param[in] bytes Bytes to load, at most 8.
+ * @return Value loaded.
+ */
+uint64_t chip8_getle(const uint8_t **at, unsigned int bytes);
+
+/**
+ * @brief Store value as varint, 7 bits per byte with low bits first, and
+ *        advance cursor.
+ *
+ * @pre @p at MUST point to a cursor with room for 10 bytes.
+ * @post @p at WILL point past the stored bytes.
+ *
+ * @param[in,out] at Cursor to store value at.
+ * @param[in] value Value to store.
+ */
+void chip8_putvar(uint8_t **at, uint64_t value);
+
+/**
+ * @brief Load varint stored by #chip8_putvar() and advance cursor.
+ *
+ * @pre @p at MUST point to a cursor before @p end.
+ * @post @p at WILL point past the loaded bytes. The last of them still has
+ *       its top bit set if @p end or the 10 byte limit cut the value short.
+ *
+ * @param[in,out] at Cursor to load value from.
+ * @param[in] end End of bytes that may be loaded.
+ * @return Value loaded.
+ */
+uint64_t chip8_getvar(const uint8_t **at, const uint8_t *end);
+
 #endif /* CHIP8_UTILS_H */
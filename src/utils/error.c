@@ -5,10 +5,9 @@
  * @file error.c
  */
 
-#include <err.h>
+#include <stdio.h>
 #include <stdlib.h>
 
-#include "SDL.h"
 #include "utils/error.h"
 
 static const char *const ERROR_MESSAGE[] = {
@@ -18,7 +17,12 @@ static const char *const ERROR_MESSAGE[] = {
 	[CHIP8_ENOFILE] = "no such file exists",
 	[CHIP8_EBIGFILE] = "file is too big to load",
 	[CHIP8_ESDL] = "SDL library failure",
-	[CHIP8_EBADOP] = "encountered bad opcode during cpu cycle"
+	[CHIP8_EBADOP] = "encountered bad opcode during cpu cycle",
+	[CHIP8_ENOSYS] = "feature not supported on this host",
+	[CHIP8_EBADSTATE] = "bad or incompatible save state",
+	[CHIP8_EIO] = "input/output failure",
+	[CHIP8_EBADMOVIE] = "bad or incompatible input movie",
+	[CHIP8_EBADTRACE] = "bad or incompatible trace file"
 };
 
 void chip8_die(chip8_error code)
@@ -29,9 +33,6 @@ void chip8_die(chip8_error code)
 		exit(CHIP8_EINVAL);
 	}
 
-	if (code == CHIP8_ESDL)
-		fprintf(stderr, "%s, %s\n", ERROR_MESSAGE[code], SDL_GetError());
-	else
-		fprintf(stderr, "%s\n", ERROR_MESSAGE[code]);
+	fprintf(stderr, "%s\n", ERROR_MESSAGE[code]);
 	exit(code);
 }
@@ -12,13 +12,18 @@
  * @brief Enumeration representing standard application error codes.
  */
 typedef enum {
-	CHIP8_EOK = 0,  /**< No errors. */
-	CHIP8_EINVAL,   /**< Invalid argument. */
-	CHIP8_ENOMEM,   /**< No memory. */
-	CHIP8_ENOFILE,  /**< No such file exists. */
-	CHIP8_EBIGFILE, /**< File is to big to load. */
-	CHIP8_EBADOP,   /**< CPU encounted bad opcode. */
-	CHIP8_ESDL,     /**< SDL library failure. */
+	CHIP8_EOK = 0,   /**< No errors. */
+	CHIP8_EINVAL,    /**< Invalid argument. */
+	CHIP8_ENOMEM,    /**< No memory. */
+	CHIP8_ENOFILE,   /**< No such file exists. */
+	CHIP8_EBIGFILE,  /**< File is to big to load. */
+	CHIP8_EBADOP,    /**< CPU encounted bad opcode. */
+	CHIP8_ESDL,      /**< SDL library failure. */
+	CHIP8_ENOSYS,    /**< Feature not supported on this host. */
+	CHIP8_EBADSTATE, /**< Save state is corrupt or incompatible. */
+	CHIP8_EIO,       /**< Input/output failure. */
+	CHIP8_EBADMOVIE, /**< Input movie is corrupt or incompatible. */
+	CHIP8_EBADTRACE, /**< Trace file is corrupt or incompatible. */
 	CHIP8_ECOUNT	/**< Error code count INTERAL USE ONLY!. */
 } chip8_error;
 
@@ -0,0 +1,52 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/state.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+chip8_cpu *test_cpu_new(const char *rom, uint64_t seed, unsigned int opnum)
+{
+	chip8_video *video = NULL;
+	chip8_keypad *keys = NULL;
+	chip8_cpu *cpu = NULL;
+
+	if (chip8_video_init(&video) != CHIP8_EOK ||
+	    chip8_keypad_init(&keys) != CHIP8_EOK ||
+	    chip8_cpu_init(&cpu, video, keys, opnum) != CHIP8_EOK ||
+	    chip8_cpu_seed(cpu, seed) != CHIP8_EOK)
+		BAIL_OUT("failed to create cpu system");
+	if (rom != NULL && chip8_cpu_romload(cpu, rom) != CHIP8_EOK)
+		BAIL_OUT("test rom %s could not be found", rom);
+	return cpu;
+}
+
+void test_cpu_free(chip8_cpu *cpu)
+{
+	chip8_video_free(cpu->video);
+	chip8_keypad_free(cpu->keypad);
+	chip8_cpu_free(cpu);
+}
+
+bool test_cpu_same(const chip8_cpu *a, const chip8_cpu *b)
+{
+	chip8_state state;
+	uint8_t abuf[CHIP8_STATE_SIZE];
+	uint8_t bbuf[CHIP8_STATE_SIZE];
+
+	chip8_state_snap(a, &state);
+	chip8_state_encode(&state, abuf, sizeof abuf);
+	chip8_state_snap(b, &state);
+	chip8_state_encode(&state, bbuf, sizeof bbuf);
+	return memcmp(abuf, bbuf, sizeof abuf) == 0;
+}
@@ -0,0 +1,31 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TEST_FIXTURE_H
+#define TEST_FIXTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/cpu.h"
+
+/*
+ * Create CPU with its own video and keypad, running opnum instructions per
+ * second (0 for the default) from random number seed. Loads rom too, unless
+ * rom is NULL. Bails out of the test suite on failure.
+ */
+chip8_cpu *test_cpu_new(const char *rom, uint64_t seed, unsigned int opnum);
+
+/*
+ * Free CPU created by test_cpu_new(), along with its video and keypad.
+ */
+void test_cpu_free(chip8_cpu *cpu);
+
+/*
+ * Check if two CPUs ended up in the exact same state, comparing their
+ * encoded save states.
+ */
+bool test_cpu_same(const chip8_cpu *a, const chip8_cpu *b);
+
+#endif /* TEST_FIXTURE_H */
@@ -5,6 +5,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "tap.h"
 #include "utils/error.h"
@@ -79,13 +80,100 @@ static void test_chip8_readrom(void)
 	buffer = NULL;
 }
 
+/*
+ * Test chip8_now().
+ *
+ * TEST TYPES:
+ *   1. chip8_now() never goes backwards.
+ */
+static void test_chip8_now(void)
+{
+	uint64_t start = chip8_now();
+
+	ok(chip8_now() >= start, "chip8_now() never goes backwards");
+}
+
+/*
+ * Test chip8_putle() and chip8_getle().
+ *
+ * TEST TYPES:
+ *   1. chip8_putle() stores values little-endian and advances cursor.
+ *   2. chip8_getle() loads what chip8_putle() stored and advances cursor.
+ */
+static void test_chip8_le(void)
+{
+	static const uint8_t expect[] = {
+		0x34, 0x12, 0xEF, 0xCD, 0xAB, 0x89, 0x67, 0x45, 0x23, 0x01
+	};
+	uint8_t buffer[sizeof expect] = { 0 };
+	const uint8_t *in = buffer;
+	uint8_t *out = buffer;
+	uint64_t small = 0;
+	uint64_t large = 0;
+
+	chip8_putle(&out, 0x1234, 2);
+	chip8_putle(&out, 0x0123456789ABCDEFu, 8);
+	ok(out == buffer + sizeof buffer &&
+	   memcmp(buffer, expect, sizeof expect) == 0,
+	   "chip8_putle() stores values little-endian");
+
+	small = chip8_getle(&in, 2);
+	large = chip8_getle(&in, 8);
+	ok(in == buffer + sizeof buffer && small == 0x1234 &&
+	   large == 0x0123456789ABCDEFu,
+	   "chip8_getle() loads values chip8_putle() stored");
+}
+
+/*
+ * Test chip8_putvar() and chip8_getvar().
+ *
+ * TEST TYPES:
+ *   1. chip8_putvar() stores 7 bits per byte, low bits first.
+ *   2. chip8_getvar() loads what chip8_putvar() stored.
+ *   3. chip8_getvar() stops at end of bytes.
+ */
+static void test_chip8_var(void)
+{
+	static const uint8_t expect[] = {
+		0x7F, 0xAC, 0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F
+	};
+	uint8_t buffer[sizeof expect] = { 0 };
+	const uint8_t *in = buffer;
+	uint8_t *out = buffer;
+	uint64_t small = 0;
+	uint64_t medium = 0;
+	uint64_t large = 0;
+
+	chip8_putvar(&out, 0x7F);
+	chip8_putvar(&out, 300);
+	chip8_putvar(&out, 0xFFFFFFFFu);
+	ok(out == buffer + sizeof buffer &&
+	   memcmp(buffer, expect, sizeof expect) == 0,
+	   "chip8_putvar() stores 7 bits per byte, low bits first");
+
+	small = chip8_getvar(&in, buffer + sizeof buffer);
+	medium = chip8_getvar(&in, buffer + sizeof buffer);
+	large = chip8_getvar(&in, buffer + sizeof buffer);
+	ok(in == buffer + sizeof buffer && small == 0x7F && medium == 300 &&
+	   large == 0xFFFFFFFFu,
+	   "chip8_getvar() loads values chip8_putvar() stored");
+
+	in = buffer + 3;
+	chip8_getvar(&in, buffer + 5);
+	ok(in == buffer + 5 && (in[-1] & 0x80) != 0,
+	   "chip8_getvar() stops at end of bytes");
+}
+
 /*
  * Starting point of test suite.
  */
 int main(void)
 {
-	plan(8);
+	plan(14);
 	test_chip8_arrsize();
 	test_chip8_readrom();
+	test_chip8_now();
+	test_chip8_le();
+	test_chip8_var();
 	done_testing();
 }
@@ -0,0 +1,203 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/auxfun.h"
+#include "utils/error.h"
+#include "core/capture.h"
+#include "core/video.h"
+#include "tap.h"
+
+#define TEST_CAPTURE "test/test_capture.out" /* Capture to write. */
+#define TEST_SCALE   2                       /* Scale of frames. */
+#define TEST_WIDTH   (CHIP8_VIDEO_WIDTH * TEST_SCALE)
+#define TEST_HEIGHT  (CHIP8_VIDEO_HEIGHT * TEST_SCALE)
+#define TEST_FRAMES  1000 /* Frames pushed into a tiny queue. */
+
+/*
+ * Create video with a single lit pixel.
+ */
+static void test_video_new(chip8_video *video, int x, int y)
+{
+	memset(video, 0, sizeof *video);
+	chip8_video_palette(video, 0x000000FF, 0xFFFFFFFF);
+	chip8_video_set(video, x, y, 1);
+}
+
+/*
+ * Read capture file back, and remove it.
+ */
+static uint8_t *test_read(size_t *size)
+{
+	uint8_t *buffer = NULL;
+
+	if (chip8_readrom(TEST_CAPTURE, &buffer, size) != CHIP8_EOK)
+		BAIL_OUT("failed to read capture");
+	remove(TEST_CAPTURE);
+	return buffer;
+}
+
+/*
+ * Test NULL arguments and bad paths.
+ *
+ * TEST TYPES:
+ *   1. chip8_capture_init() catches NULL arguments.
+ *   2. chip8_capture_init() catches path that cannot be written.
+ *   3. chip8_capture_push() and chip8_capture_stat() catch NULL arguments.
+ */
+static void test_chip8_capture_null(void)
+{
+	chip8_capture *capture = NULL;
+	chip8_capture_stats stats;
+
+	ok(chip8_capture_init(NULL, TEST_CAPTURE, CHIP8_CAPTURE_RGBA, 0, 0) ==
+	   CHIP8_EINVAL &&
+	   chip8_capture_init(&capture, NULL, CHIP8_CAPTURE_RGBA, 0, 0) ==
+	   CHIP8_EINVAL,
+	   "chip8_capture_init() catches NULL arguments");
+	cmp_ok(chip8_capture_init(&capture, "test/nonexistent/out.rgba",
+				  CHIP8_CAPTURE_RGBA, 0, 0), "==",
+	       CHIP8_ENOFILE,
+	       "chip8_capture_init() catches path that cannot be written");
+	ok(chip8_capture_push(NULL, NULL) == CHIP8_EINVAL &&
+	   chip8_capture_stat(NULL, &stats) == CHIP8_EINVAL,
+	   "chip8_capture_push() and chip8_capture_stat() catch NULL "
+	   "arguments");
+}
+
+/*
+ * Test raw RGBA captures.
+ *
+ * TEST TYPES:
+ *   1. Repeated frame is counted, and not queued.
+ *   2. Every frame is written, repeated ones included.
+ *   3. Pixels are scaled into palette colors.
+ *   4. Full queue never drops a frame from the stream.
+ *   5. chip8_capture_sync() keeps every frame in the queue.
+ */
+static void test_chip8_capture_rgba(void)
+{
+	const size_t bytes = TEST_WIDTH * TEST_HEIGHT * 4;
+	chip8_capture *capture = NULL;
+	chip8_capture_stats stats;
+	chip8_video video;
+	uint8_t *buffer = NULL;
+	const uint8_t *lit = NULL;
+	size_t size = 0;
+
+	if (chip8_capture_init(&capture, TEST_CAPTURE, CHIP8_CAPTURE_RGBA,
+			       TEST_SCALE, 0) != CHIP8_EOK)
+		BAIL_OUT("failed to create capture");
+	test_video_new(&video, 0, 0);
+	chip8_capture_push(capture, &video);
+	chip8_capture_push(capture, &video);
+	test_video_new(&video, 5, 3);
+	chip8_capture_push(capture, &video);
+	chip8_capture_stat(capture, &stats);
+	ok(stats.frames == 3 && stats.queued == 2 && stats.repeats == 1,
+	   "repeated frame is counted, and not queued");
+	if (chip8_capture_free(capture) != CHIP8_EOK)
+		BAIL_OUT("failed to write capture");
+
+	buffer = test_read(&size);
+	ok(size == 3 * bytes && memcmp(buffer, buffer + bytes, bytes) == 0 &&
+	   memcmp(buffer, buffer + 2 * bytes, bytes) != 0,
+	   "every frame is written, repeated ones included");
+
+	/* Pixel (5, 3) covers (10, 6) to (11, 7) when scaled by two... */
+	lit = buffer + 2 * bytes + (7 * TEST_WIDTH + 11) * 4;
+	ok(memcmp(buffer, "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x00\x00\x00\xFF",
+		  12) == 0 && memcmp(lit, "\xFF\xFF\xFF\xFF", 4) == 0 &&
+	   memcmp(lit + 4, "\x00\x00\x00\xFF", 4) == 0,
+	   "pixels are scaled into palette colors");
+	free(buffer);
+
+	if (chip8_capture_init(&capture, TEST_CAPTURE, CHIP8_CAPTURE_RGBA,
+			       TEST_SCALE, 1) != CHIP8_EOK)
+		BAIL_OUT("failed to create capture");
+	for (int n = 0; n < TEST_FRAMES; n++) {
+		test_video_new(&video, n % CHIP8_VIDEO_WIDTH,
+			       n / CHIP8_VIDEO_WIDTH);
+		chip8_capture_push(capture, &video);
+	}
+	chip8_capture_stat(capture, &stats);
+	if (chip8_capture_free(capture) != CHIP8_EOK)
+		BAIL_OUT("failed to write capture");
+	buffer = test_read(&size);
+	ok(size == TEST_FRAMES * bytes,
+	   "full queue never drops a frame from the stream (%llu of %d "
+	   "frames left out)", (unsigned long long)stats.dropped,
+	   TEST_FRAMES);
+	free(buffer);
+
+	if (chip8_capture_init(&capture, TEST_CAPTURE, CHIP8_CAPTURE_RGBA,
+			       TEST_SCALE, 1) != CHIP8_EOK)
+		BAIL_OUT("failed to create capture");
+	for (int n = 0; n < TEST_FRAMES; n++) {
+		test_video_new(&video, n % CHIP8_VIDEO_WIDTH,
+			       n / CHIP8_VIDEO_WIDTH);
+		chip8_capture_sync(capture);
+		chip8_capture_push(capture, &video);
+	}
+	chip8_capture_stat(capture, &stats);
+	if (chip8_capture_free(capture) != CHIP8_EOK)
+		BAIL_OUT("failed to write capture");
+	remove(TEST_CAPTURE);
+	ok(stats.queued == TEST_FRAMES && stats.dropped == 0,
+	   "chip8_capture_sync() keeps every frame in the queue");
+}
+
+/*
+ * Test Y4M captures.
+ *
+ * TEST TYPES:
+ *   1. Stream starts with header, and every frame with a marker.
+ *   2. Luma of unlit and lit pixels is limited range black and white.
+ */
+static void test_chip8_capture_y4m(void)
+{
+	const char *header = "YUV4MPEG2 W128 H64 F60:1 Ip A1:1 C444\n";
+	const size_t bytes = strlen("FRAME\n") + TEST_WIDTH * TEST_HEIGHT * 3;
+	chip8_capture *capture = NULL;
+	chip8_video video;
+	uint8_t *buffer = NULL;
+	uint8_t *luma = NULL;
+	size_t size = 0;
+
+	if (chip8_capture_init(&capture, TEST_CAPTURE, CHIP8_CAPTURE_Y4M,
+			       TEST_SCALE, 0) != CHIP8_EOK)
+		BAIL_OUT("failed to create capture");
+	test_video_new(&video, 1, 0);
+	chip8_capture_push(capture, &video);
+	chip8_capture_push(capture, &video);
+	if (chip8_capture_free(capture) != CHIP8_EOK)
+		BAIL_OUT("failed to write capture");
+
+	buffer = test_read(&size);
+	ok(size == strlen(header) + 2 * bytes &&
+	   memcmp(buffer, header, strlen(header)) == 0 &&
+	   memcmp(buffer + strlen(header), "FRAME\n", 6) == 0 &&
+	   memcmp(buffer + strlen(header) + bytes, "FRAME\n", 6) == 0,
+	   "stream starts with header, and every frame with a marker");
+
+	luma = buffer + strlen(header) + 6;
+	ok(luma[0] == 16 && luma[1] == 16 && luma[2] == 235 && luma[3] == 235,
+	   "luma of unlit and lit pixels is limited range black and white");
+	free(buffer);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(10);
+	test_chip8_capture_null();
+	test_chip8_capture_rgba();
+	test_chip8_capture_y4m();
+	done_testing();
+}
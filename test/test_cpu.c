@@ -2,15 +2,18 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "utils/error.h"
 #include "utils/auxfun.h"
 #include "core/cpu.h"
+#include "core/decode.h"
+#include "core/interp.h"
 #include "core/keypad.h"
 #include "core/video.h"
-#include "core/audio.h"
 #include "tap.h"
 
 #define DEFAULT_TEST_ROM "test/roms/stub.ch8" /* Default ROM for testing. */
@@ -55,13 +58,13 @@ static void test_chip8_cpu_reset(void)
  *   2. chip8_cpu_init() loads fontmap correctly.
  */
 static void test_chip8_cpu_init(chip8_cpu *cpu, chip8_video *video,
-		                chip8_keypad *keys, chip8_audio *audio)
+		                chip8_keypad *keys)
 {
-	cmp_ok(chip8_cpu_init(NULL, NULL, NULL, NULL, 0), "==", CHIP8_EINVAL,
+	cmp_ok(chip8_cpu_init(NULL, NULL, NULL, 0), "==", CHIP8_EINVAL,
 	       "chip8_cpu_init() detects NULL CPU");
-	cmp_ok(chip8_cpu_init(&cpu, video, NULL, NULL, 0), "==", CHIP8_EINVAL,
+	cmp_ok(chip8_cpu_init(&cpu, video, NULL, 0), "==", CHIP8_EINVAL,
 	       "chip8_cpu_init() detects NULL keypad");
-	cmp_ok(chip8_cpu_init(&cpu, NULL, keys, NULL, 0), "==", CHIP8_EINVAL,
+	cmp_ok(chip8_cpu_init(&cpu, NULL, keys, 0), "==", CHIP8_EINVAL,
 	       "chip8_cpu_init() detects NULL video");
 	cmp_mem(cpu->memory, EXPECTED_FONTMAP, chip8_arrsize(EXPECTED_FONTMAP),
 		"chip8_cpu_init() loads fontmap correctly");
@@ -112,6 +115,363 @@ static void test_chip8_cpu_cycle(void)
 	       "chip8_cpu_cycle() detects NULL argument");
 }
 
+/*
+ * Test chip8_cpu_invalidate().
+ *
+ * TEST TYPES:
+ *   1. chip8_cpu_step() executes predecoded instruction.
+ *   2. chip8_cpu_step() executes instruction rewritten by FX55.
+ */
+static void test_chip8_cpu_invalidate(chip8_cpu *cpu)
+{
+	/* LD V0, 0x11 followed by LD [I], V1... */
+	const uint8_t program[] = { 0x60, 0x11, 0xF1, 0x55 };
+
+	chip8_cpu_reset(cpu);
+	cpu->keypad->states = NULL;
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+	chip8_cpu_step(cpu);
+	cmp_ok(cpu->v[0], "==", 0x11,
+	       "chip8_cpu_step() executes predecoded instruction");
+
+	/* Rewrite first instruction into LD V0, 0x22... */
+	cpu->v[0] = 0x60;
+	cpu->v[1] = 0x22;
+	cpu->i = CHIP8_ROM_INIT;
+	chip8_cpu_step(cpu);
+	cpu->pc = CHIP8_ROM_INIT;
+	chip8_cpu_step(cpu);
+	cmp_ok(cpu->v[0], "==", 0x22,
+	       "chip8_cpu_step() executes instruction rewritten by FX55");
+}
+
+/*
+ * Test chip8_cpu_exec().
+ *
+ * TEST TYPES:
+ *   1. chip8_cpu_exec() runs batch up to FX0A.
+ *   2. chip8_cpu_exec() stops batch once FX0A locks keypad.
+ */
+static void test_chip8_cpu_exec(chip8_cpu *cpu)
+{
+	/* LD V0, 0x01 then LD V2, K then LD V1, 0x02... */
+	const uint8_t program[] = { 0x60, 0x01, 0xF2, 0x0A, 0x61, 0x02 };
+
+	chip8_cpu_reset(cpu);
+	cpu->keypad->states = NULL;
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+	chip8_cpu_exec(cpu, 10, NULL);
+	cmp_ok(cpu->v[0], "==", 0x01, "chip8_cpu_exec() runs batch up to FX0A");
+	ok(cpu->v[1] == 0x00 && cpu->pc == CHIP8_ROM_INIT + 4,
+	   "chip8_cpu_exec() stops batch once FX0A locks keypad");
+}
+
+/*
+ * Test chip8_cpu_run().
+ *
+ * TEST TYPES:
+ *   1. chip8_cpu_run() detects NULL argument.
+ *   2. chip8_cpu_run() stops at first timer tick.
+ *   3. chip8_cpu_run() ticks delay timer by virtual clock.
+ *   4. chip8_cpu_frame() runs up to the next timer tick.
+ */
+static void test_chip8_cpu_run(chip8_cpu *cpu)
+{
+	/* LD VF, 0x3C then LD DT, VF then JP 0x204... */
+	const uint8_t program[] = { 0x6F, 0x3C, 0xFF, 0x15, 0x12, 0x04 };
+	unsigned long ran = 0;
+	unsigned long total = 0;
+
+	cmp_ok(chip8_cpu_run(NULL, 1, NULL), "==", CHIP8_EINVAL,
+	       "chip8_cpu_run() detects NULL argument");
+
+	chip8_cpu_reset(cpu);
+	cpu->keypad->states = NULL;
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+
+	/* At 700 instructions per second the first tick is due at cycle 12... */
+	chip8_cpu_run(cpu, 1000, &ran);
+	cmp_ok(ran, "==", 12, "chip8_cpu_run() stops at first timer tick");
+
+	/* 300 cycles cover 25 ticks, none of them before DT was loaded... */
+	for (total = ran; total < 300; total += ran)
+		chip8_cpu_run(cpu, 300 - total, &ran);
+	cmp_ok(cpu->dt, "==", 60 - 25,
+	       "chip8_cpu_run() ticks delay timer by virtual clock");
+
+	/* Tick 26 is due at cycle 304... */
+	chip8_cpu_frame(cpu);
+	ok(cpu->dt == 60 - 26 && cpu->cycles == 304,
+	   "chip8_cpu_frame() runs up to the next timer tick");
+}
+
+/*
+ * Test chip8_cpu_seed().
+ *
+ * TEST TYPES:
+ *   1. chip8_cpu_seed() detects NULL argument.
+ *   2. chip8_cpu_seed() repeats sequence of same seed.
+ *   3. chip8_cpu_seed() gives different sequence for different seed.
+ *   4. CXNN draws from random number generator of CPU.
+ */
+static void test_chip8_cpu_seed(chip8_cpu *cpu)
+{
+	/* RND V0, 0xFF... */
+	const uint8_t program[] = { 0xC0, 0xFF };
+	uint8_t first[16];
+	uint8_t again[16];
+	uint8_t other[16];
+	uint8_t expect = 0;
+
+	cmp_ok(chip8_cpu_seed(NULL, 0), "==", CHIP8_EINVAL,
+	       "chip8_cpu_seed() detects NULL argument");
+
+	chip8_cpu_seed(cpu, 42);
+	for (size_t n = 0; n < chip8_arrsize(first); n++)
+		first[n] = chip8_cpu_rand(cpu);
+	chip8_cpu_seed(cpu, 42);
+	for (size_t n = 0; n < chip8_arrsize(again); n++)
+		again[n] = chip8_cpu_rand(cpu);
+	chip8_cpu_seed(cpu, 43);
+	for (size_t n = 0; n < chip8_arrsize(other); n++)
+		other[n] = chip8_cpu_rand(cpu);
+	cmp_mem(first, again, sizeof first,
+		"chip8_cpu_seed() repeats sequence of same seed");
+	ok(memcmp(first, other, sizeof first) != 0,
+	   "chip8_cpu_seed() gives different sequence for different seed");
+
+	chip8_cpu_seed(cpu, 7);
+	expect = chip8_cpu_rand(cpu);
+	chip8_cpu_seed(cpu, 7);
+	chip8_cpu_reset(cpu);
+	cpu->keypad->states = NULL;
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+	chip8_cpu_step(cpu);
+	cmp_ok(cpu->v[0], "==", expect,
+	       "CXNN draws from random number generator of CPU");
+}
+
+/*
+ * Test DXYN.
+ *
+ * TEST TYPES:
+ *   1. DXYN draws sprite rows at X, Y and clears VF.
+ *   2. DXYN erases lit pixels it draws over and sets VF.
+ *   3. DXYN clips sprites at right and bottom edges.
+ *   4. DXYN wraps starting position around the screen.
+ *   5. DXYN marks rows it draws on dirty.
+ */
+static void test_chip8_cpu_draw(chip8_cpu *cpu)
+{
+	/* LD V0, 8; LD V1, 2; LD I, 0; DRW V0, V1, 5; DRW V0, V1, 5;
+	 * LD V0, 60; LD V1, 30; DRW V0, V1, 5; LD V0, 66; DRW V0, V1, 1... */
+	const uint8_t program[] = {
+		0x60, 0x08, 0x61, 0x02, 0xA0, 0x00, 0xD0, 0x15, 0xD0, 0x15,
+		0x60, 0x3C, 0x61, 0x1E, 0xD0, 0x15, 0x60, 0x42, 0xD0, 0x11
+	};
+	chip8_video *video = cpu->video;
+	bool drawn = true;
+	bool empty = true;
+
+	chip8_cpu_reset(cpu);
+	chip8_video_clear(video);
+	cpu->keypad->states = NULL;
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+
+	cpu->v[0xF] = 1;
+	for (int step = 0; step < 4; step++)
+		chip8_cpu_step(cpu);
+	for (int line = 0; line < 5; line++)
+		drawn = drawn && video->rows[2 + line] ==
+			(uint64_t)EXPECTED_FONTMAP[line] << 48;
+	for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+		empty = empty && chip8_video_get(video, x, 1) == 0 &&
+			chip8_video_get(video, x, 7) == 0;
+	ok(drawn && empty && chip8_video_get(video, 8, 2) == 1 &&
+	   chip8_video_get(video, 12, 2) == 0 && cpu->v[0xF] == 0,
+	   "DXYN draws sprite rows at X, Y and clears VF");
+
+	chip8_cpu_step(cpu);
+	empty = true;
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		empty = empty && video->rows[y] == 0;
+	ok(empty && cpu->v[0xF] == 1,
+	   "DXYN erases lit pixels it draws over and sets VF");
+
+	for (int step = 0; step < 3; step++)
+		chip8_cpu_step(cpu);
+	ok(video->rows[30] == 0xF && video->rows[31] == 0x9 &&
+	   video->rows[0] == 0 && cpu->v[0xF] == 0,
+	   "DXYN clips sprites at right and bottom edges");
+
+	chip8_cpu_step(cpu);
+	video->dirty = 0;
+	chip8_cpu_step(cpu);
+	ok(video->rows[30] == ((uint64_t)0xF0 << 54 | 0xF) &&
+	   cpu->v[0xF] == 0,
+	   "DXYN wraps starting position around the screen");
+	cmp_ok(video->dirty, "==", 1u << 30,
+	       "DXYN marks rows it draws on dirty");
+}
+
+/*
+ * Test SUPER-CHIP instructions.
+ *
+ * TEST TYPES:
+ *   1. 00FF switches to 128x64, and DXY0 draws 16x16 sprite across words.
+ *   2. 00FC and 00FB scroll rows left and right across words.
+ *   3. 00CN scrolls rows down.
+ *   4. FX30 points I at large digit of VX.
+ *   5. FX75 and FX85 store and load RPL flags.
+ *   6. 00FE switches back to 64x32 and clears the screen.
+ */
+static void test_chip8_cpu_schip(chip8_cpu *cpu)
+{
+	/* HIGH; LD V0, 56; LD V1, 2; LD I, 0x300; DRW V0, V1, 0; SCL; SCR;
+	 * SCD 3; LD V2, 7; LD HF, V2; LD V0, 0x11; LD V1, 0x22; LD R, V1;
+	 * LD V0, 0; LD V1, 0; LD V1, R; LOW... */
+	const uint8_t program[] = {
+		0x00, 0xFF, 0x60, 0x38, 0x61, 0x02, 0xA3, 0x00, 0xD0, 0x10,
+		0x00, 0xFC, 0x00, 0xFB, 0x00, 0xC3, 0x62, 0x07, 0xF2, 0x30,
+		0x60, 0x11, 0x61, 0x22, 0xF1, 0x75, 0x60, 0x00, 0x61, 0x00,
+		0xF1, 0x85, 0x00, 0xFE
+	};
+	chip8_video *video = cpu->video;
+	uint64_t *rows = video->rows;
+	bool drawn = true;
+	bool empty = true;
+
+	chip8_cpu_reset(cpu);
+	cpu->keypad->states = NULL;
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+
+	/* Sprite lighting its leftmost and rightmost column on every row... */
+	for (int line = 0; line < 16; line++) {
+		cpu->memory[0x300 + 2 * line] = 0x80;
+		cpu->memory[0x300 + 2 * line + 1] = 0x01;
+	}
+
+	video->dirty = 0;
+	for (int step = 0; step < 5; step++)
+		chip8_cpu_step(cpu);
+	for (int y = 0; y < CHIP8_VIDEO_HIRES_HEIGHT; y++)
+		drawn = drawn && rows[2 * y] == ((y >= 2 && y < 18) ?
+			(uint64_t)1 << 7 : 0) &&
+			rows[2 * y + 1] == ((y >= 2 && y < 18) ?
+			(uint64_t)1 << 56 : 0);
+	ok(video->hires && drawn && cpu->v[0xF] == 0 &&
+	   video->dirty == CHIP8_VIDEO_DIRTY,
+	   "00FF switches to 128x64, and DXY0 draws 16x16 sprite across "
+	   "words");
+
+	chip8_cpu_step(cpu);
+	drawn = rows[4] == (uint64_t)1 << 11 && rows[5] == (uint64_t)1 << 60;
+	chip8_cpu_step(cpu);
+	ok(drawn && rows[4] == (uint64_t)1 << 7 && rows[5] == (uint64_t)1 << 56,
+	   "00FC and 00FB scroll rows left and right across words");
+
+	video->dirty = 0;
+	chip8_cpu_step(cpu);
+	ok(rows[4] == 0 && rows[9] == 0 && rows[10] == (uint64_t)1 << 7 &&
+	   rows[41] == (uint64_t)1 << 56 && rows[42] == 0 &&
+	   video->dirty == (uint64_t)0x7FFFF << 2,
+	   "00CN scrolls rows down");
+
+	chip8_cpu_step(cpu);
+	chip8_cpu_step(cpu);
+	ok(cpu->i == CHIP8_FONT_LARGE + 70 && cpu->memory[cpu->i] == 0xFF &&
+	   cpu->memory[cpu->i + 2] == 0x03,
+	   "FX30 points I at large digit of VX");
+
+	for (int step = 0; step < 6; step++)
+		chip8_cpu_step(cpu);
+	ok(cpu->v[0] == 0x11 && cpu->v[1] == 0x22 && cpu->rpl[0] == 0x11 &&
+	   cpu->rpl[1] == 0x22,
+	   "FX75 and FX85 store and load RPL flags");
+
+	chip8_cpu_step(cpu);
+	for (int n = 0; n < CHIP8_VIDEO_WORDS; n++)
+		empty = empty && rows[n] == 0;
+	ok(!video->hires && empty, "00FE switches back to 64x32 and clears the "
+	   "screen");
+}
+
+/*
+ * Test chip8_decode().
+ *
+ * TEST TYPES:
+ *   1. chip8_decode() maps opcodes to their instructions.
+ *   2. chip8_decode() ignores Y of 8XYN.
+ *   3. chip8_decode() maps unlisted opcodes to CHIP8_OP_BAD.
+ *   4. chip8_cpu_step() fails on unlisted opcodes.
+ */
+static void test_chip8_decode(chip8_cpu *cpu)
+{
+	/* 5XY1, E000, and F0FF are not instructions at all... */
+	const uint16_t bad[] = { 0x5121, 0xE000, 0xF0FF };
+	bool same = true;
+	bool fails = true;
+
+	chip8_decode_init();
+	ok(chip8_decode(0x00E0) == CHIP8_OP_00E0 &&
+	   chip8_decode(0x00EE) == CHIP8_OP_00EE &&
+	   chip8_decode(0x00C3) == CHIP8_OP_00CN &&
+	   chip8_decode(0x00FF) == CHIP8_OP_00FF &&
+	   chip8_decode(0x1ABC) == CHIP8_OP_1NNN &&
+	   chip8_decode(0x5120) == CHIP8_OP_5XY0 &&
+	   chip8_decode(0xD125) == CHIP8_OP_DXYN &&
+	   chip8_decode(0xE3A1) == CHIP8_OP_EXA1 &&
+	   chip8_decode(0xF40A) == CHIP8_OP_FX0A &&
+	   chip8_decode(0xF565) == CHIP8_OP_FX65,
+	   "chip8_decode() maps opcodes to their instructions");
+
+	for (uint16_t y = 0; y <= 0xF; y++)
+		same &= chip8_decode(0x8104 | y << 4) == CHIP8_OP_8XY4 &&
+			chip8_decode(0x810E | y << 4) == CHIP8_OP_8XYE;
+	ok(same, "chip8_decode() ignores Y of 8XYN");
+
+	same = true;
+	cpu->keypad->states = NULL;
+	for (size_t n = 0; n < chip8_arrsize(bad); n++) {
+		same &= chip8_decode(bad[n]) == CHIP8_OP_BAD;
+		cpu->memory[CHIP8_ROM_INIT] = bad[n] >> 8;
+		cpu->memory[CHIP8_ROM_INIT + 1] = bad[n] & 0xFF;
+		chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, 2);
+		cpu->pc = CHIP8_ROM_INIT;
+		fails &= chip8_cpu_step(cpu) == CHIP8_EBADOP;
+	}
+	ok(same, "chip8_decode() maps unlisted opcodes to CHIP8_OP_BAD");
+	ok(fails, "chip8_cpu_step() fails on unlisted opcodes");
+}
+
+/*
+ * Test chip8_interp_exec().
+ *
+ * TEST TYPES:
+ *   1. chip8_interp_exec() stops batch on bad opcode.
+ *   2. chip8_interp_exec() counts bad opcode as ran.
+ */
+static void test_chip8_interp_exec(chip8_cpu *cpu)
+{
+	/* LD V0, 0x01 then LD V1, 0x02 then 5XY1, which is no instruction... */
+	const uint8_t program[] = { 0x60, 0x01, 0x61, 0x02, 0x51, 0x21 };
+	unsigned long ran = 0;
+
+	chip8_cpu_reset(cpu);
+	cpu->keypad->states = NULL;
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+	cmp_ok(chip8_interp_exec(cpu, 10, &ran), "==", CHIP8_EBADOP,
+	       "chip8_interp_exec() stops batch on bad opcode");
+	cmp_ok(ran, "==", 3, "chip8_interp_exec() counts bad opcode as ran");
+}
+
 /*
  * Starting point of test suite.
  */
@@ -119,27 +479,34 @@ int main(void)
 {
 	chip8_video *video = NULL;
 	chip8_keypad *keys = NULL;
-	chip8_audio *audio = NULL;
 	chip8_cpu *cpu = NULL;
 	chip8_error flag = CHIP8_EOK;
 	
-	video = malloc(sizeof *video);
+	video = calloc(1, sizeof *video);
 	if (video == NULL)
 		BAIL_OUT("failed to create video system");
 
-	keys = malloc(sizeof *keys);
+	keys = calloc(1, sizeof *keys);
 	if (keys == NULL)
 		BAIL_OUT("failed to create keypad system");
 
-	flag = chip8_cpu_init(&cpu, video, keys, audio, 0);
+	flag = chip8_cpu_init(&cpu, video, keys, 0);
 	if (flag != CHIP8_EOK)
 		BAIL_OUT("failed to create cpu system");
 
-	plan(10);
+	plan(39);
 	test_chip8_cpu_reset();
-	test_chip8_cpu_init(cpu, video, keys, audio);
+	test_chip8_cpu_init(cpu, video, keys);
 	test_chip8_cpu_romload(cpu);
+	test_chip8_decode(cpu);
 	test_chip8_cpu_cycle();
+	test_chip8_cpu_invalidate(cpu);
+	test_chip8_cpu_exec(cpu);
+	test_chip8_interp_exec(cpu);
+	test_chip8_cpu_run(cpu);
+	test_chip8_cpu_seed(cpu);
+	test_chip8_cpu_draw(cpu);
+	test_chip8_cpu_schip(cpu);
 	done_testing();
 
 	free(video);
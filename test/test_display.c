@@ -0,0 +1,159 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/auxfun.h"
+#include "utils/error.h"
+#include "core/display.h"
+#include "core/video.h"
+#include "tap.h"
+
+#define TEST_DUMP "test/test_display.out" /* Frames to dump. */
+
+/*
+ * Dump two frames of video with backend, and read the file back.
+ */
+static uint8_t *test_dump(const chip8_display_backend *backend,
+		          chip8_video *video, size_t *size)
+{
+	chip8_display_config config = { TEST_DUMP, 0, 0 };
+	chip8_display *display = NULL;
+	uint8_t *buffer = NULL;
+
+	if (chip8_display_init(&display, backend, &config) != CHIP8_EOK)
+		BAIL_OUT("failed to create %s display", backend->name);
+	chip8_display_present(display, video);
+	chip8_display_present(display, video);
+	chip8_display_free(display);
+
+	if (chip8_readrom(TEST_DUMP, &buffer, size) != CHIP8_EOK)
+		BAIL_OUT("failed to read %s frames", backend->name);
+	remove(TEST_DUMP);
+	return buffer;
+}
+
+/*
+ * Test NULL arguments and bad paths.
+ *
+ * TEST TYPES:
+ *   1. chip8_display_init() catches NULL arguments.
+ *   2. chip8_display_present() catches NULL arguments.
+ *   3. chip8_display_init() catches path that cannot be written.
+ */
+static void test_chip8_display_null(void)
+{
+	chip8_display_config config = { "test/nonexistent/out.ppm", 0, 0 };
+	chip8_display *display = NULL;
+
+	ok(chip8_display_init(NULL, &chip8_display_null, &config) ==
+	   CHIP8_EINVAL &&
+	   chip8_display_init(&display, NULL, &config) == CHIP8_EINVAL &&
+	   chip8_display_init(&display, &chip8_display_null, NULL) ==
+	   CHIP8_EINVAL,
+	   "chip8_display_init() catches NULL arguments");
+	cmp_ok(chip8_display_present(NULL, NULL), "==", CHIP8_EINVAL,
+	       "chip8_display_present() catches NULL arguments");
+	cmp_ok(chip8_display_init(&display, &chip8_display_ppm, &config), "==",
+	       CHIP8_ENOFILE,
+	       "chip8_display_init() catches path that cannot be written");
+}
+
+/*
+ * Test display backends.
+ *
+ * TEST TYPES:
+ *   1. Null backend counts frames, and clears dirty rows.
+ *   2. Display hashes frames, and counts repeated ones.
+ *   3. PBM backend writes packed rows, lit pixels white.
+ *   4. PGM backend writes a byte per pixel, lit pixels white.
+ *   5. PPM backend writes palette colors.
+ *   6. PBM backend writes high resolution frames at 128x64.
+ */
+static void test_chip8_display_backends(void)
+{
+	const size_t pixels = CHIP8_VIDEO_WIDTH * CHIP8_VIDEO_HEIGHT;
+	chip8_display_config config = { NULL, 0, 0 };
+	chip8_display *display = NULL;
+	chip8_video video;
+	uint8_t *buffer = NULL;
+	uint8_t *image = NULL;
+	size_t header = 0;
+	size_t size = 0;
+	uint64_t hash = 0;
+
+	memset(&video, 0, sizeof video);
+	chip8_video_palette(&video, 0x102030FF, 0xA0B0C0FF);
+	chip8_video_set(&video, 0, 0, 1);
+	chip8_video_set(&video, 9, 1, 1);
+
+	if (chip8_display_init(&display, &chip8_display_null, &config) !=
+	    CHIP8_EOK)
+		BAIL_OUT("failed to create null display");
+	chip8_display_present(display, &video);
+	ok(display->frames == 1 && video.dirty == 0,
+	   "null backend counts frames, and clears dirty rows");
+
+	chip8_video_hash(&video, &hash);
+	chip8_display_present(display, &video);
+	chip8_video_set(&video, 1, 0, 1);
+	chip8_display_present(display, &video);
+	ok(display->repeats == 1 && display->hash != hash,
+	   "display hashes frames, and counts repeated ones");
+	chip8_video_set(&video, 1, 0, 0);
+	chip8_display_free(display);
+
+	buffer = test_dump(&chip8_display_pbm, &video, &size);
+	header = strlen("P4\n64 32\n");
+	image = buffer + header;
+	ok(size == 2 * (header + pixels / 8) &&
+	   memcmp(buffer, "P4\n64 32\n", header) == 0 &&
+	   image[0] == 0x7F && image[1] == 0xFF && image[8] == 0xFF &&
+	   image[9] == 0xBF,
+	   "PBM backend writes packed rows, lit pixels white");
+	free(buffer);
+
+	buffer = test_dump(&chip8_display_pgm, &video, &size);
+	header = strlen("P5\n64 32\n255\n");
+	image = buffer + header;
+	ok(size == 2 * (header + pixels) &&
+	   memcmp(buffer, "P5\n64 32\n255\n", header) == 0 &&
+	   image[0] == 0xFF && image[1] == 0x00 &&
+	   image[CHIP8_VIDEO_WIDTH + 9] == 0xFF,
+	   "PGM backend writes a byte per pixel, lit pixels white");
+	free(buffer);
+
+	buffer = test_dump(&chip8_display_ppm, &video, &size);
+	header = strlen("P6\n64 32\n255\n");
+	image = buffer + header;
+	ok(size == 2 * (header + 3 * pixels) &&
+	   memcmp(buffer, "P6\n64 32\n255\n", header) == 0 &&
+	   memcmp(image, "\xA0\xB0\xC0\x10\x20\x30", 6) == 0,
+	   "PPM backend writes palette colors");
+	free(buffer);
+
+	chip8_video_resolution(&video, true);
+	chip8_video_set(&video, 127, 0, 1);
+	buffer = test_dump(&chip8_display_pbm, &video, &size);
+	header = strlen("P4\n128 64\n");
+	image = buffer + header;
+	ok(size == 2 * (header + 4 * pixels / 8) &&
+	   memcmp(buffer, "P4\n128 64\n", header) == 0 &&
+	   image[0] == 0xFF && image[15] == 0xFE,
+	   "PBM backend writes high resolution frames at 128x64");
+	free(buffer);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(9);
+	test_chip8_display_null();
+	test_chip8_display_backends();
+	done_testing();
+}
@@ -0,0 +1,90 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/frame.h"
+#include "tap.h"
+
+#define TEST_HZ     100 /* Frame rate to pace at. */
+#define TEST_FRAMES 50  /* Frames to wait for. */
+
+/*
+ * Test NULL arguments.
+ *
+ * TEST TYPES:
+ *   1. chip8_frame_init() catches NULL argument.
+ *   2. chip8_frame_wait() and chip8_frame_stat() catch NULL arguments.
+ */
+static void test_chip8_frame_null(void)
+{
+	chip8_frame_stats stats;
+
+	cmp_ok(chip8_frame_init(NULL, 0), "==", CHIP8_EINVAL,
+	       "chip8_frame_init() catches NULL argument");
+	ok(chip8_frame_wait(NULL) == CHIP8_EINVAL &&
+	   chip8_frame_stat(NULL, &stats) == CHIP8_EINVAL,
+	   "chip8_frame_wait() and chip8_frame_stat() catch NULL arguments");
+}
+
+/*
+ * Test chip8_frame_wait().
+ *
+ * TEST TYPES:
+ *   1. Waits are paced to the frame rate.
+ *   2. Waits sleep through most of every frame instead of spinning.
+ *   3. Loop that falls behind skips ahead instead of racing to catch up.
+ */
+static void test_chip8_frame_wait(void)
+{
+	chip8_frame *frame = NULL;
+	chip8_frame_stats stats;
+	uint64_t period = 1000000000u / TEST_HZ;
+	uint64_t start = 0;
+	uint64_t elapsed = 0;
+	struct timespec stall = { 0, 5 * 1000000000L / TEST_HZ };
+
+	if (chip8_frame_init(&frame, TEST_HZ) != CHIP8_EOK)
+		BAIL_OUT("failed to create frame scheduler");
+
+	start = chip8_now();
+	for (int n = 0; n < TEST_FRAMES; n++)
+		chip8_frame_wait(frame);
+	elapsed = chip8_now() - start;
+	ok(elapsed >= (TEST_FRAMES - 1) * period &&
+	   elapsed < (TEST_FRAMES + 5) * period,
+	   "waits are paced to the frame rate (%llu ms for %d frames)",
+	   (unsigned long long)(elapsed / 1000000), TEST_FRAMES);
+
+	chip8_frame_stat(frame, &stats);
+	ok(stats.frames == TEST_FRAMES && stats.slept_ns > 4 * stats.spun_ns,
+	   "waits sleep through most of every frame instead of spinning "
+	   "(%llu us asleep, %llu us spinning)",
+	   (unsigned long long)(stats.slept_ns / 1000),
+	   (unsigned long long)(stats.spun_ns / 1000));
+
+	nanosleep(&stall, NULL);
+	chip8_frame_wait(frame);
+	start = chip8_now();
+	chip8_frame_wait(frame);
+	elapsed = chip8_now() - start;
+	chip8_frame_stat(frame, &stats);
+	ok(stats.late >= 1 && elapsed >= period / 2,
+	   "loop that falls behind skips ahead instead of racing to catch up");
+	chip8_frame_free(frame);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(5);
+	test_chip8_frame_null();
+	test_chip8_frame_wait();
+	done_testing();
+}
@@ -0,0 +1,84 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "tap.h"
+#include "frontend/input.h"
+#include "frontend/window.h"
+#include "utils/error.h"
+
+/*
+ * Super minimal testing, because we could not find a reliable way to make
+ * SDL fail in a controlled manner for further testing.
+ */
+
+/*
+ * Test chip8_window_render().
+ *
+ * TEST TYPES
+ *   1. chip8_window_render() catches NULL argument.
+ */
+static void test_chip8_window_render(void)
+{
+	cmp_ok(chip8_window_render(NULL, NULL), "==", CHIP8_EINVAL,
+	       "chip8_window_render() catches NULL argument");
+}
+
+/*
+ * Test chip8_window_stat().
+ *
+ * TEST TYPES
+ *   1. chip8_window_stat() catches NULL argument.
+ */
+static void test_chip8_window_stat(void)
+{
+	cmp_ok(chip8_window_stat(NULL, NULL), "==", CHIP8_EINVAL,
+	       "chip8_window_stat() catches NULL argument");
+}
+
+/*
+ * Test chip8_input_poll().
+ *
+ * TEST TYPES:
+ *   1. chip8_input_poll() catches NULL argument.
+ */
+static void test_chip8_input_poll(void)
+{
+	cmp_ok(chip8_input_poll(NULL), "==", CHIP8_EINVAL,
+	       "chip8_input_poll catches NULL argument");
+}
+
+/*
+ * Test chip8_input_process().
+ *
+ * TEST TYPES:
+ *   1. chip8_input_process() catches NULL keypad.
+ */
+static void test_chip8_input_process(void)
+{
+	cmp_ok(chip8_input_process(NULL), "==", CHIP8_EINVAL,
+	       "chip8_input_process catches NULL keypad");
+}
+
+/*
+ * Test chip8_input_rewind().
+ *
+ * TEST TYPES:
+ *   1. chip8_input_rewind() catches NULL argument.
+ */
+static void test_chip8_input_rewind(void)
+{
+	cmp_ok(chip8_input_rewind(NULL), "==", CHIP8_EINVAL,
+	       "chip8_input_rewind catches NULL argument");
+}
+
+int main(void)
+{
+	plan(5);
+	test_chip8_window_render();
+	test_chip8_window_stat();
+	test_chip8_input_poll();
+	test_chip8_input_process();
+	test_chip8_input_rewind();
+	done_testing();
+}
@@ -0,0 +1,127 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "utils/auxfun.h"
+#include "utils/error.h"
+#include "core/cpu.h"
+#include "core/display.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_SEED   1   /* Random number seed of every run. */
+#define TEST_CHECKS 4   /* Frames checked per ROM. */
+
+/* Frames whose hash is checked, counting from 1... */
+static const uint64_t TEST_FRAMES[TEST_CHECKS] = { 1, 30, 120, 600 };
+
+/*
+ * Hashes of checked frames of a ROM, run without input at 700 instructions
+ * per second. Update them only along with a deliberate change to emulation,
+ * after checking the new frames by eye, such as with -b pbm.
+ */
+typedef struct {
+	const char *rom;
+	uint64_t hashes[TEST_CHECKS];
+} test_golden;
+
+static const test_golden TEST_GOLDEN[] = {
+	{ "games/breakout.ch8",
+	  { 0x9EA5086F482A2849ULL, 0xA6824F24440AFF85ULL,
+	    0x37A5A913843F03F2ULL, 0xB002340E0FA5C3A0ULL } },
+	{ "games/space_invaders.ch8",
+	  { 0x6DA1D6C99C5DF8BDULL, 0xA40B8BCA78D21B4CULL,
+	    0xB0B0826C9D4DCA9DULL, 0xBD878C534F68F404ULL } },
+	{ "games/tetris.ch8",
+	  { 0x34C0D99CF5A71A60ULL, 0xD5269502FF70E3C8ULL,
+	    0x555F8A4E2A16EB57ULL, 0xE5813DBC69E1423EULL } },
+	{ "test/roms/ibm_logo.ch8",
+	  { 0x4FBF56C0FFB9B600ULL, 0x13C2E77A6D2A5F98ULL,
+	    0x13C2E77A6D2A5F98ULL, 0x13C2E77A6D2A5F98ULL } }
+};
+
+/*
+ * Run ROM on engine, presenting every frame on a null display, and check
+ * hashes of checked frames against golden ones.
+ */
+static bool test_golden_run(const test_golden *golden, chip8_engine engine,
+		            bool *supported)
+{
+	chip8_display_config config = { NULL, 0, 0 };
+	chip8_display *display = NULL;
+	chip8_cpu *cpu = test_cpu_new(golden->rom, TEST_SEED, 0);
+	chip8_video *video = cpu->video;
+	chip8_error flag = CHIP8_EOK;
+	bool same = true;
+	int check = 0;
+
+	if (chip8_display_init(&display, &chip8_display_null, &config) !=
+	    CHIP8_EOK)
+		BAIL_OUT("failed to create null display");
+
+	flag = chip8_cpu_setengine(cpu, engine);
+	*supported = flag != CHIP8_ENOSYS;
+	while (*supported && check < TEST_CHECKS) {
+		if (chip8_cpu_frame(cpu) != CHIP8_EOK ||
+		    chip8_display_present(display, video) != CHIP8_EOK)
+			BAIL_OUT("failed to run frame of %s", golden->rom);
+		if (display->frames != TEST_FRAMES[check])
+			continue;
+
+		if (display->hash != golden->hashes[check])
+			diag("%s frame %llu: hash %016llx, golden %016llx",
+			     golden->rom, (unsigned long long)display->frames,
+			     (unsigned long long)display->hash,
+			     (unsigned long long)golden->hashes[check]);
+		same &= display->hash == golden->hashes[check];
+		check++;
+	}
+
+	chip8_display_free(display);
+	test_cpu_free(cpu);
+	return same;
+}
+
+/*
+ * Test frame hashes against golden ones.
+ *
+ * TEST TYPES:
+ *   1. Interpreter presents golden frames for every ROM.
+ *   2. JIT presents golden frames for every ROM.
+ */
+static void test_chip8_golden_frames(void)
+{
+	bool supported = true;
+	bool same = true;
+
+	for (size_t n = 0; n < chip8_arrsize(TEST_GOLDEN); n++) {
+		same = test_golden_run(&TEST_GOLDEN[n], CHIP8_ENGINE_INTERP,
+				       &supported);
+		ok(same, "interpreter presents golden frames of %s",
+		   TEST_GOLDEN[n].rom);
+	}
+
+	for (size_t n = 0; n < chip8_arrsize(TEST_GOLDEN); n++) {
+		same = test_golden_run(&TEST_GOLDEN[n], CHIP8_ENGINE_JIT,
+				       &supported);
+		skip(!supported, 1, "JIT is not supported on this host");
+		ok(same, "JIT presents golden frames of %s",
+		   TEST_GOLDEN[n].rom);
+		end_skip;
+	}
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(2 * chip8_arrsize(TEST_GOLDEN));
+	test_chip8_golden_frames();
+	done_testing();
+}
@@ -0,0 +1,135 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/jit.h"
+#include "core/keypad.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_CYCLES 200000 /* Instructions to run per ROM. */
+
+/* ROMs to compare interpreter and JIT with. */
+static const char *const TEST_ROMS[] = {
+	"games/breakout.ch8",
+	"games/space_invaders.ch8",
+	"games/tetris.ch8",
+	"test/roms/BC_test.ch8",
+	"test/roms/ibm_logo.ch8",
+	"test/roms/test_opcode.ch8"
+};
+
+/*
+ * Create CPU with test_cpu_new() running on engine, and note if host
+ * supports engine.
+ */
+static chip8_cpu *test_jit_new(const char *rom, chip8_engine engine,
+			       bool *supported)
+{
+	chip8_cpu *cpu = test_cpu_new(rom, 0, 0);
+	chip8_error flag = chip8_cpu_setengine(cpu, engine);
+
+	*supported = flag != CHIP8_ENOSYS;
+	if (flag != CHIP8_EOK && flag != CHIP8_ENOSYS)
+		BAIL_OUT("failed to select execution engine");
+	return cpu;
+}
+
+/*
+ * Test chip8_jit_init().
+ *
+ * TEST TYPES:
+ *   1. chip8_jit_init() catches NULL argument.
+ */
+static void test_chip8_jit_init(void)
+{
+	cmp_ok(chip8_jit_init(NULL), "==", CHIP8_EINVAL,
+	       "chip8_jit_init() catches NULL argument");
+}
+
+/*
+ * Test chip8_jit_exec() against interpreter.
+ *
+ * TEST TYPES:
+ *   1. JIT and interpreter end in identical state for every test ROM.
+ */
+static void test_chip8_jit_exec(void)
+{
+	bool supported = true;
+
+	for (size_t rom = 0; rom < chip8_arrsize(TEST_ROMS); rom++) {
+		chip8_cpu *interp = test_jit_new(TEST_ROMS[rom],
+				                 CHIP8_ENGINE_INTERP,
+						 &supported);
+		chip8_cpu *jit = test_jit_new(TEST_ROMS[rom], CHIP8_ENGINE_JIT,
+				              &supported);
+
+		skip(!supported, 1, "JIT is not supported on this host");
+		chip8_cpu_exec(interp, TEST_CYCLES, NULL);
+		chip8_cpu_exec(jit, TEST_CYCLES, NULL);
+		ok(test_cpu_same(interp, jit),
+		   "JIT matches interpreter state on %s", TEST_ROMS[rom]);
+		end_skip;
+
+		test_cpu_free(interp);
+		test_cpu_free(jit);
+	}
+}
+
+/*
+ * Test chip8_jit_invalidate().
+ *
+ * TEST TYPES:
+ *   1. JIT executes code rewritten by FX55 after it was translated.
+ *   2. JIT leaves loop that depends on rewritten code.
+ */
+static void test_chip8_jit_invalidate(void)
+{
+	/* Rewrite first instruction from LD V3, 1 to LD V3, 7 once... */
+	const uint8_t program[] = {
+		0x63, 0x01, /* LD V3, 0x01 */
+		0x74, 0x01, /* ADD V4, 0x01 */
+		0x60, 0x63, /* LD V0, 0x63 */
+		0x61, 0x07, /* LD V1, 0x07 */
+		0xA2, 0x00, /* LD I, 0x200 */
+		0xF1, 0x55, /* LD [I], V1 */
+		0x34, 0x02, /* SE V4, 0x02 */
+		0x12, 0x00, /* JP 0x200 */
+		0x12, 0x10  /* JP 0x210 */
+	};
+	bool supported = true;
+	chip8_cpu *cpu = test_jit_new(NULL, CHIP8_ENGINE_JIT, &supported);
+
+	skip(!supported, 2, "JIT is not supported on this host");
+	memcpy(cpu->memory + CHIP8_ROM_INIT, program, chip8_arrsize(program));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(program));
+	chip8_cpu_exec(cpu, 100, NULL);
+	cmp_ok(cpu->v[3], "==", 0x07,
+	       "JIT executes code rewritten by FX55");
+	cmp_ok(cpu->pc, "==", 0x210,
+	       "JIT leaves loop that depends on rewritten code");
+	end_skip;
+
+	test_cpu_free(cpu);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(3 + chip8_arrsize(TEST_ROMS));
+	test_chip8_jit_init();
+	test_chip8_jit_exec();
+	test_chip8_jit_invalidate();
+	done_testing();
+}
@@ -86,30 +86,6 @@ static void test_chip8_keypad_getkey(void)
 	stub = NULL;
 }
 
-/*
- * Test chip8_keypad_poll().
- *
- * TEST TYPES:
- *   1. chip8_keypad_poll() catches NULL argument.
- */
-static void test_chip8_keypad_poll(void)
-{
-	cmp_ok(chip8_keypad_poll(NULL), "==", CHIP8_EINVAL,
-	       "chip8_keypad_poll catches NULL argument");
-}
-
-/**
- * Test chip8_keypad_process().
- *
- * TEST TYPES:
- *   1. chip8_keypad_process() catches NULL keypad.
- */
-static void test_chip8_keypad_process(void)
-{
-	cmp_ok(chip8_keypad_process(NULL), "==", CHIP8_EINVAL,
-	       "chip8_keypad_process catches NULL keypad");	
-}
-
 /*
  * Test chip8_keypad_lock().
  *
@@ -167,13 +143,11 @@ static void test_chip8_keypad_islock(void)
  */
 int main(void)
 {
-	plan(13);
+	plan(11);
 	test_chip8_keypad_init();
 	test_chip8_keypad_clear();
 	test_chip8_keypad_setkey();
 	test_chip8_keypad_getkey();
-	test_chip8_keypad_poll();
-	test_chip8_keypad_process();
 	test_chip8_keypad_lock();
 	test_chip8_keypad_islock();
 	done_testing();
@@ -0,0 +1,212 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/lockstep.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_LANES  8      /* Lanes in test batch. */
+#define TEST_ROUNDS 4      /* Lockstep runs per test. */
+#define TEST_CYCLES 100000 /* Cycles to run every lane for. */
+
+/* ROMs to compare lockstep lanes and lone machines with. */
+static const char *const TEST_ROMS[] = {
+	"games/tetris.ch8",
+	"test/roms/BC_test.ch8",
+	"test/roms/ibm_logo.ch8",
+	"test/roms/test_opcode.ch8"
+};
+
+/*
+ * Lanes skip apart on V2 and meet again at 0x208. Every lane adds its own
+ * V1 to V2, so lanes branch apart differently over time.
+ */
+static const uint8_t TEST_SPLIT[] = {
+	0x82, 0x14, /* ADD V2, V1 */
+	0x32, 0x00, /* SE V2, 0x00 */
+	0x12, 0x08, /* JP 0x208 */
+	0x73, 0x01, /* ADD V3, 0x01 */
+	0xA3, 0x00, /* LD I, 0x300 */
+	0xF3, 0x33, /* LD B, V3 */
+	0x12, 0x00  /* JP 0x200 */
+};
+
+/*
+ * Run lone CPU for cycles on its virtual clock.
+ */
+static void test_cpu_run(chip8_cpu *cpu, unsigned long cycles)
+{
+	unsigned long ran = 0;
+
+	while (cycles != 0) {
+		if (chip8_cpu_run(cpu, cycles, &ran) != CHIP8_EOK)
+			BAIL_OUT("lone cpu failed to run");
+		cycles -= ran;
+	}
+}
+
+/*
+ * Run batch and lone CPUs set up the same way, and check if every lane
+ * matches its lone CPU.
+ */
+static bool test_lockstep_same(chip8_lockstep *ls, chip8_cpu **cpus,
+		               chip8_lockstep_stats *total)
+{
+	chip8_lockstep_stats stats;
+	bool same = true;
+
+	memset(total, 0, sizeof *total);
+	for (int round = 0; round < TEST_ROUNDS; round++) {
+		if (chip8_lockstep_run(ls, TEST_CYCLES / TEST_ROUNDS, &stats) !=
+		    CHIP8_EOK)
+			return false;
+		total->instructions += stats.instructions;
+		total->converged += stats.converged;
+	}
+
+	for (unsigned int lane = 0; lane < TEST_LANES; lane++) {
+		test_cpu_run(cpus[lane], TEST_CYCLES);
+		same &= test_cpu_same(chip8_lockstep_vm(ls, lane)->cpu,
+				      cpus[lane]);
+	}
+	return same;
+}
+
+/*
+ * Test chip8_lockstep_init().
+ *
+ * TEST TYPES:
+ *   1. chip8_lockstep_init() catches NULL argument.
+ *   2. chip8_lockstep_init() catches empty batch.
+ *   3. chip8_lockstep_init() catches too many lanes.
+ */
+static void test_chip8_lockstep_init(void)
+{
+	chip8_lockstep *ls = NULL;
+
+	cmp_ok(chip8_lockstep_init(NULL, 1, 0), "==", CHIP8_EINVAL,
+	       "chip8_lockstep_init() catches NULL argument");
+	cmp_ok(chip8_lockstep_init(&ls, 0, 0), "==", CHIP8_EINVAL,
+	       "chip8_lockstep_init() catches empty batch");
+	cmp_ok(chip8_lockstep_init(&ls, CHIP8_LOCKSTEP_LANES + 1, 0), "==",
+	       CHIP8_EINVAL, "chip8_lockstep_init() catches too many lanes");
+}
+
+/*
+ * Test chip8_lockstep_vm().
+ *
+ * TEST TYPES:
+ *   1. chip8_lockstep_vm() catches lane out of range.
+ */
+static void test_chip8_lockstep_vm(void)
+{
+	chip8_lockstep *ls = NULL;
+
+	if (chip8_lockstep_init(&ls, TEST_LANES, 0) != CHIP8_EOK)
+		BAIL_OUT("failed to create lockstep batch");
+	ok(chip8_lockstep_vm(ls, TEST_LANES) == NULL,
+	   "chip8_lockstep_vm() catches lane out of range");
+	chip8_lockstep_free(ls);
+}
+
+/*
+ * Test chip8_lockstep_run() on ROMs.
+ *
+ * TEST TYPES:
+ *   1. Lanes match lone machines for every test ROM.
+ *   2. Identical lanes never split apart.
+ */
+static void test_chip8_lockstep_run(void)
+{
+	chip8_lockstep_stats stats;
+	chip8_lockstep *ls = NULL;
+	chip8_cpu *cpus[TEST_LANES];
+	bool converged = true;
+
+	for (size_t rom = 0; rom < chip8_arrsize(TEST_ROMS); rom++) {
+		if (chip8_lockstep_init(&ls, TEST_LANES, 0) != CHIP8_EOK)
+			BAIL_OUT("failed to create lockstep batch");
+
+		for (unsigned int lane = 0; lane < TEST_LANES; lane++) {
+			cpus[lane] = test_cpu_new(TEST_ROMS[rom], 0, 0);
+			if (chip8_cpu_romload(chip8_lockstep_vm(ls, lane)->cpu,
+					      TEST_ROMS[rom]) != CHIP8_EOK)
+				BAIL_OUT("test rom could not be found");
+		}
+
+		ok(test_lockstep_same(ls, cpus, &stats),
+		   "lanes match lone machines on %s", TEST_ROMS[rom]);
+		converged &= stats.converged == stats.instructions;
+
+		for (unsigned int lane = 0; lane < TEST_LANES; lane++)
+			test_cpu_free(cpus[lane]);
+		chip8_lockstep_free(ls);
+	}
+	ok(converged, "identical lanes never split apart");
+}
+
+/*
+ * Test chip8_lockstep_run() on lanes that branch apart.
+ *
+ * TEST TYPES:
+ *   1. Lanes that branch apart match lone machines.
+ *   2. Lanes that branch apart run in lockstep again.
+ */
+static void test_chip8_lockstep_split(void)
+{
+	chip8_lockstep_stats stats;
+	chip8_lockstep *ls = NULL;
+	chip8_cpu *cpus[TEST_LANES];
+
+	if (chip8_lockstep_init(&ls, TEST_LANES, 0) != CHIP8_EOK)
+		BAIL_OUT("failed to create lockstep batch");
+
+	for (unsigned int lane = 0; lane < TEST_LANES; lane++) {
+		chip8_cpu *cpu = chip8_lockstep_vm(ls, lane)->cpu;
+
+		cpus[lane] = test_cpu_new(NULL, 0, 0);
+		memcpy(cpu->memory + CHIP8_ROM_INIT, TEST_SPLIT,
+		       chip8_arrsize(TEST_SPLIT));
+		memcpy(cpus[lane]->memory + CHIP8_ROM_INIT, TEST_SPLIT,
+		       chip8_arrsize(TEST_SPLIT));
+		chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT,
+				     chip8_arrsize(TEST_SPLIT));
+		chip8_cpu_invalidate(cpus[lane], CHIP8_ROM_INIT,
+				     chip8_arrsize(TEST_SPLIT));
+		cpu->v[1] = lane;
+		cpus[lane]->v[1] = lane;
+	}
+
+	ok(test_lockstep_same(ls, cpus, &stats),
+	   "lanes that branch apart match lone machines");
+	ok(stats.converged != 0 && stats.converged < stats.instructions,
+	   "lanes that branch apart run in lockstep again");
+
+	for (unsigned int lane = 0; lane < TEST_LANES; lane++)
+		test_cpu_free(cpus[lane]);
+	chip8_lockstep_free(ls);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(7 + chip8_arrsize(TEST_ROMS));
+	test_chip8_lockstep_init();
+	test_chip8_lockstep_vm();
+	test_chip8_lockstep_run();
+	test_chip8_lockstep_split();
+	done_testing();
+}
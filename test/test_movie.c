@@ -0,0 +1,174 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/movie.h"
+#include "core/state.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_ROM    "games/tetris.ch8"       /* ROM movies play on. */
+#define TEST_MOVIE  "test/movies/tetris.c8m" /* Movie recorded on ROM. */
+#define TEST_SAVE   "test/test_movie.c8m"    /* Movie file to write. */
+#define TEST_SEED   42                       /* Seed of recorded machine. */
+#define TEST_FRAMES 600                      /* Frames to record. */
+
+/*
+ * Play every frame of movie on new CPU. Returns CPU at the end of movie.
+ */
+static chip8_cpu *test_movie_play(const char *path)
+{
+	chip8_movie *movie = NULL;
+	chip8_movie_stats stats;
+	chip8_cpu *cpu = NULL;
+	bool done = false;
+
+	if (chip8_movie_load(&movie, path) != CHIP8_EOK)
+		BAIL_OUT("failed to load movie %s", path);
+	chip8_movie_stat(movie, &stats);
+
+	cpu = test_cpu_new(TEST_ROM, stats.seed, stats.opnum);
+	while (!done) {
+		if (chip8_movie_play(movie, cpu, &done) != CHIP8_EOK)
+			BAIL_OUT("failed to play movie %s", path);
+	}
+	chip8_movie_free(movie);
+	return cpu;
+}
+
+/*
+ * Test chip8_movie_init() and chip8_movie_load().
+ *
+ * TEST TYPES:
+ *   1. chip8_movie_init() catches NULL argument.
+ *   2. chip8_movie_init() catches zero speed.
+ *   3. chip8_movie_load() catches non-existent file.
+ *   4. chip8_movie_load() catches file that is not a movie.
+ *   5. chip8_movie_load() catches truncated movie.
+ */
+static void test_chip8_movie_load(void)
+{
+	chip8_movie *movie = NULL;
+	uint8_t *buffer = NULL;
+	size_t len = 0;
+	FILE *file = NULL;
+
+	cmp_ok(chip8_movie_init(NULL, 0, 700), "==", CHIP8_EINVAL,
+	       "chip8_movie_init() catches NULL argument");
+	cmp_ok(chip8_movie_init(&movie, 0, 0), "==", CHIP8_EINVAL,
+	       "chip8_movie_init() catches zero speed");
+	cmp_ok(chip8_movie_load(&movie, "test/nonexistent.c8m"), "==",
+	       CHIP8_ENOFILE, "chip8_movie_load() catches non-existent file");
+	cmp_ok(chip8_movie_load(&movie, TEST_ROM), "==", CHIP8_EBADMOVIE,
+	       "chip8_movie_load() catches file that is not a movie");
+
+	if (chip8_readrom(TEST_MOVIE, &buffer, &len) != CHIP8_EOK)
+		BAIL_OUT("test movie could not be found");
+	file = fopen(TEST_SAVE, "wb");
+	if (file == NULL || fwrite(buffer, 1, len - 1, file) != len - 1)
+		BAIL_OUT("failed to write truncated movie");
+	fclose(file);
+	cmp_ok(chip8_movie_load(&movie, TEST_SAVE), "==", CHIP8_EBADMOVIE,
+	       "chip8_movie_load() catches truncated movie");
+	remove(TEST_SAVE);
+	free(buffer);
+}
+
+/*
+ * Test chip8_movie_record() and chip8_movie_play().
+ *
+ * TEST TYPES:
+ *   1. Saved movie loads with the same seed, speed, and frames.
+ *   2. Movie only grows when keys change.
+ *   3. Played movie matches recorded machine bit for bit.
+ *   4. chip8_movie_play() leaves machine alone once movie ended.
+ */
+static void test_chip8_movie_record(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, TEST_SEED, 0);
+	chip8_cpu *other = NULL;
+	chip8_movie *movie = NULL;
+	chip8_movie_stats stats;
+	chip8_movie_stats loaded;
+	bool done = false;
+	uint64_t cycles = 0;
+
+	if (chip8_movie_init(&movie, TEST_SEED, cpu->opnum) != CHIP8_EOK)
+		BAIL_OUT("failed to create movie");
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		if (chip8_movie_record(movie, cpu, (frame % 40 < 10) ?
+				       1u << ((frame / 40) & 0xF) : 0) !=
+		    CHIP8_EOK)
+			BAIL_OUT("failed to record frame");
+	}
+	if (chip8_movie_save(movie, TEST_SAVE) != CHIP8_EOK)
+		BAIL_OUT("failed to save movie");
+	chip8_movie_stat(movie, &stats);
+	chip8_movie_free(movie);
+
+	if (chip8_movie_load(&movie, TEST_SAVE) != CHIP8_EOK)
+		BAIL_OUT("failed to load movie");
+	chip8_movie_stat(movie, &loaded);
+	ok(loaded.seed == TEST_SEED && loaded.opnum == cpu->opnum &&
+	   loaded.frames == TEST_FRAMES && loaded.runs == stats.runs,
+	   "saved movie loads with the same seed, speed, and frames");
+	ok(loaded.runs == 2 * TEST_FRAMES / 40,
+	   "movie only grows when keys change");
+	chip8_movie_free(movie);
+
+	other = test_movie_play(TEST_SAVE);
+	ok(test_cpu_same(cpu, other),
+	   "played movie matches recorded machine bit for bit");
+	remove(TEST_SAVE);
+
+	if (chip8_movie_init(&movie, TEST_SEED, cpu->opnum) != CHIP8_EOK)
+		BAIL_OUT("failed to create movie");
+	cycles = other->cycles;
+	chip8_movie_play(movie, other, &done);
+	ok(done && other->cycles == cycles,
+	   "chip8_movie_play() leaves machine alone once movie ended");
+	chip8_movie_free(movie);
+
+	test_cpu_free(other);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test chip8_movie_play() on recorded gameplay.
+ *
+ * TEST TYPES:
+ *   1. Recorded gameplay replays bit-identically every time.
+ */
+static void test_chip8_movie_play(void)
+{
+	chip8_cpu *first = test_movie_play(TEST_MOVIE);
+	chip8_cpu *second = test_movie_play(TEST_MOVIE);
+
+	ok(test_cpu_same(first, second),
+	   "recorded gameplay replays bit-identically every time");
+	test_cpu_free(second);
+	test_cpu_free(first);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(10);
+	test_chip8_movie_load();
+	test_chip8_movie_record();
+	test_chip8_movie_play();
+	done_testing();
+}
@@ -0,0 +1,134 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/pool.h"
+#include "core/video.h"
+#include "tap.h"
+
+#define TEST_VMS     8      /* Machines in test pool. */
+#define TEST_THREADS 3      /* Workers in test pool. */
+#define TEST_CYCLES  100000 /* Cycles to run every machine for. */
+
+/* ROMs handed out to machines round robin. */
+static const char *const TEST_ROMS[] = {
+	"test/roms/ibm_logo.ch8",
+	"test/roms/test_opcode.ch8"
+};
+
+/*
+ * Test chip8_pool_init().
+ *
+ * TEST TYPES:
+ *   1. chip8_pool_init() catches NULL argument.
+ *   2. chip8_pool_init() catches empty pool.
+ */
+static void test_chip8_pool_init(void)
+{
+	chip8_pool *pool = NULL;
+
+	cmp_ok(chip8_pool_init(NULL, 1, 1), "==", CHIP8_EINVAL,
+	       "chip8_pool_init() catches NULL argument");
+	cmp_ok(chip8_pool_init(&pool, 0, 1), "==", CHIP8_EINVAL,
+	       "chip8_pool_init() catches empty pool");
+}
+
+/*
+ * Test chip8_pool_vm().
+ *
+ * TEST TYPES:
+ *   1. chip8_pool_vm() catches index out of range.
+ */
+static void test_chip8_pool_vm(chip8_pool *pool)
+{
+	ok(chip8_pool_vm(pool, TEST_VMS) == NULL,
+	   "chip8_pool_vm() catches index out of range");
+}
+
+/*
+ * Test chip8_pool_run().
+ *
+ * TEST TYPES:
+ *   1. chip8_pool_run() runs every machine without error.
+ *   2. chip8_pool_run() counts every cycle of every machine.
+ *   3. chip8_pool_run() matches machines run one at a time.
+ */
+static void test_chip8_pool_run(chip8_pool *pool)
+{
+	chip8_pool_stats stats;
+	chip8_video video;
+	chip8_keypad keys;
+	chip8_cpu *cpu = NULL;
+	unsigned long ran = 0;
+	bool same = true;
+
+	for (size_t vm = 0; vm < TEST_VMS; vm++) {
+		chip8_vm *machine = chip8_pool_vm(pool, vm);
+		const char *rom = TEST_ROMS[vm % chip8_arrsize(TEST_ROMS)];
+
+		if (chip8_cpu_romload(machine->cpu, rom) != CHIP8_EOK)
+			BAIL_OUT("test rom could not be found");
+	}
+
+	cmp_ok(chip8_pool_run(pool, TEST_CYCLES, &stats), "==", CHIP8_EOK,
+	       "chip8_pool_run() runs every machine without error");
+	ok(stats.instructions == (uint64_t)TEST_VMS * TEST_CYCLES,
+	   "chip8_pool_run() counts every cycle of every machine");
+
+	/* Run every ROM alone on this thread and compare... */
+	memset(&video, 0, sizeof video);
+	memset(&keys, 0, sizeof keys);
+	chip8_video_clear(&video);
+	chip8_keypad_clear(&keys);
+	keys.states = NULL;
+	for (size_t rom = 0; rom < chip8_arrsize(TEST_ROMS); rom++) {
+		if (chip8_cpu_init(&cpu, &video, &keys, 0) != CHIP8_EOK ||
+		    chip8_cpu_romload(cpu, TEST_ROMS[rom]) != CHIP8_EOK)
+			BAIL_OUT("failed to create reference cpu");
+
+		for (unsigned long total = 0; total < TEST_CYCLES; total += ran)
+			chip8_cpu_run(cpu, TEST_CYCLES - total, &ran);
+
+		for (size_t vm = rom; vm < TEST_VMS;
+		     vm += chip8_arrsize(TEST_ROMS)) {
+			chip8_vm *machine = chip8_pool_vm(pool, vm);
+
+			same = same && memcmp(machine->video->rows,
+					      video.rows,
+					      sizeof video.rows) == 0 &&
+			       memcmp(machine->cpu->v, cpu->v,
+				      sizeof cpu->v) == 0 &&
+			       machine->cpu->pc == cpu->pc &&
+			       machine->cpu->cycles == cpu->cycles;
+		}
+		chip8_cpu_free(cpu);
+		chip8_video_clear(&video);
+	}
+	ok(same, "chip8_pool_run() matches machines run one at a time");
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	chip8_pool *pool = NULL;
+
+	plan(6);
+	test_chip8_pool_init();
+	if (chip8_pool_init(&pool, TEST_VMS, TEST_THREADS) != CHIP8_EOK)
+		BAIL_OUT("failed to create pool");
+	test_chip8_pool_vm(pool);
+	test_chip8_pool_run(pool);
+	chip8_pool_free(pool);
+	done_testing();
+}
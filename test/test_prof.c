@@ -0,0 +1,210 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/opcode.h"
+#include "core/prof.h"
+#include "core/state.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_ROM    "test/roms/ibm_logo.ch8" /* ROM to profile. */
+#define TEST_CYCLES 5000                     /* Cycles to profile. */
+#define TEST_FILE   "test/test_prof.out"     /* Report file to write. */
+
+/*
+ * Sum every counter in counts.
+ */
+static uint64_t test_sum(const uint64_t *counts, size_t len)
+{
+	uint64_t sum = 0;
+
+	for (size_t n = 0; n < len; n++)
+		sum += counts[n];
+	return sum;
+}
+
+/*
+ * Read whole file as a string, which caller must free.
+ */
+static char *test_file_read(const char *path)
+{
+	uint8_t *buffer = NULL;
+	char *text = NULL;
+	size_t len = 0;
+
+	if (chip8_readrom(path, &buffer, &len) != CHIP8_EOK)
+		BAIL_OUT("failed to read %s", path);
+	text = malloc(len + 1);
+	if (text == NULL)
+		BAIL_OUT("failed to allocate text");
+	memcpy(text, buffer, len);
+	text[len] = '\0';
+	free(buffer);
+	return text;
+}
+
+/*
+ * Test NULL arguments of every function.
+ *
+ * TEST TYPES:
+ *   1. chip8_prof_init() catches NULL argument.
+ *   2. chip8_cpu_setprof() catches NULL CPU.
+ *   3. chip8_prof_report() and chip8_prof_json() catch NULL arguments.
+ */
+static void test_chip8_prof_null(void)
+{
+	chip8_prof *prof = NULL;
+
+	if (chip8_prof_init(&prof) != CHIP8_EOK)
+		BAIL_OUT("failed to create profile");
+
+	cmp_ok(chip8_prof_init(NULL), "==", CHIP8_EINVAL,
+	       "chip8_prof_init() catches NULL argument");
+	cmp_ok(chip8_cpu_setprof(NULL, prof), "==", CHIP8_EINVAL,
+	       "chip8_cpu_setprof() catches NULL CPU");
+	ok(chip8_prof_report(NULL, stdout, 0) == CHIP8_EINVAL &&
+	   chip8_prof_report(prof, NULL, 0) == CHIP8_EINVAL &&
+	   chip8_prof_json(NULL, stdout) == CHIP8_EINVAL &&
+	   chip8_prof_json(prof, NULL) == CHIP8_EINVAL,
+	   "chip8_prof_report() and chip8_prof_json() catch NULL arguments");
+
+	chip8_prof_free(prof);
+}
+
+/*
+ * Test counters of chip8_prof_exec().
+ *
+ * TEST TYPES:
+ *   1. Every instruction is counted once per opcode and once per address.
+ *   2. Instructions are counted at the address they ran from.
+ *   3. Profiled machine ends up exactly like unprofiled one.
+ *   4. Cycles waiting on FX0A are counted as blocked.
+ *   5. Detached profile stops counting.
+ */
+static void test_chip8_prof_exec(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_cpu *other = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_prof *prof = NULL;
+	chip8_state state;
+	uint8_t abuf[CHIP8_STATE_SIZE];
+	uint8_t bbuf[CHIP8_STATE_SIZE];
+	unsigned long ran = 0;
+	uint64_t total = 0;
+
+	if (chip8_prof_init(&prof) != CHIP8_EOK)
+		BAIL_OUT("failed to create profile");
+	chip8_cpu_setprof(cpu, prof);
+
+	chip8_cpu_exec(cpu, TEST_CYCLES, &ran);
+	chip8_cpu_exec(other, TEST_CYCLES, NULL);
+	total = test_sum(prof->ops, CHIP8_OP_COUNT);
+	ok(total == TEST_CYCLES && ran == TEST_CYCLES &&
+	   test_sum(prof->pcs, CHIP8_RAM_SIZE) == TEST_CYCLES,
+	   "every instruction is counted once per opcode and once per address");
+
+	/* IBM logo clears the screen once, then spins on a jump at 0x228... */
+	ok(prof->ops[CHIP8_OP_00E0] == 1 && prof->pcs[CHIP8_ROM_INIT] == 1 &&
+	   prof->pcs[0x228] == prof->ops[CHIP8_OP_1NNN],
+	   "instructions are counted at the address they ran from");
+
+	chip8_state_snap(cpu, &state);
+	chip8_state_encode(&state, abuf, sizeof abuf);
+	chip8_state_snap(other, &state);
+	chip8_state_encode(&state, bbuf, sizeof bbuf);
+	ok(memcmp(abuf, bbuf, sizeof abuf) == 0,
+	   "profiled machine ends up exactly like unprofiled one");
+
+	/* Wait on a key past the end of the ROM... */
+	chip8_prof_clear(prof);
+	cpu->pc = 0x300;
+	cpu->memory[0x300] = 0xF0;
+	cpu->memory[0x301] = 0x0A;
+	chip8_cpu_exec(cpu, TEST_CYCLES, NULL);
+	ok(prof->ops[CHIP8_OP_FX0A] == 1 && prof->blocked == TEST_CYCLES - 1,
+	   "cycles waiting on FX0A are counted as blocked");
+
+	chip8_cpu_setprof(cpu, NULL);
+	chip8_prof_clear(prof);
+	chip8_keypad_clear(cpu->keypad);
+	cpu->pc = CHIP8_ROM_INIT;
+	chip8_cpu_exec(cpu, TEST_CYCLES, NULL);
+	ok(test_sum(prof->ops, CHIP8_OP_COUNT) == 0 && prof->blocked == 0,
+	   "detached profile stops counting");
+
+	chip8_prof_free(prof);
+	test_cpu_free(other);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test chip8_prof_report() and chip8_prof_json().
+ *
+ * TEST TYPES:
+ *   1. Report lists the busiest instruction first.
+ *   2. JSON lists the busiest address first.
+ *   3. chip8_prof_opname() names bad identifiers "bad".
+ */
+static void test_chip8_prof_report(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_prof *prof = NULL;
+	FILE *file = NULL;
+	char *text = NULL;
+
+	if (chip8_prof_init(&prof) != CHIP8_EOK)
+		BAIL_OUT("failed to create profile");
+	chip8_cpu_setprof(cpu, prof);
+	chip8_cpu_exec(cpu, TEST_CYCLES, NULL);
+
+	file = fopen(TEST_FILE, "w");
+	if (file == NULL || chip8_prof_report(prof, file, 4) != CHIP8_EOK)
+		BAIL_OUT("failed to write report");
+	fclose(file);
+	text = test_file_read(TEST_FILE);
+	ok(strstr(text, "share\n1NNN ") != NULL,
+	   "report lists the busiest instruction first");
+	free(text);
+
+	file = fopen(TEST_FILE, "w");
+	if (file == NULL || chip8_prof_json(prof, file) != CHIP8_EOK)
+		BAIL_OUT("failed to write JSON");
+	fclose(file);
+	text = test_file_read(TEST_FILE);
+	ok(strstr(text, "\"pcs\": [\n    {\"pc\": 552, ") != NULL,
+	   "JSON lists the busiest address first");
+	free(text);
+	remove(TEST_FILE);
+
+	ok(strcmp(chip8_prof_opname(CHIP8_OP_COUNT), "bad") == 0 &&
+	   strcmp(chip8_prof_opname(CHIP8_OP_DXYN), "DXYN") == 0,
+	   "chip8_prof_opname() names bad identifiers \"bad\"");
+
+	chip8_cpu_setprof(cpu, NULL);
+	chip8_prof_free(prof);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(11);
+	test_chip8_prof_null();
+	test_chip8_prof_exec();
+	test_chip8_prof_report();
+	done_testing();
+}
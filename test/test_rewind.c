@@ -0,0 +1,253 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/rewind.h"
+#include "core/state.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_ROM      "games/tetris.ch8" /* ROM to record. */
+#define TEST_FRAMES   200                /* Frames to compare one by one. */
+#define TEST_INTERVAL 60                 /* Frames between keyframes. */
+#define TEST_BUDGET   (64u << 10)        /* Budget small enough to fill. */
+#define TEST_MINUTES  10                 /* Play time default budget holds. */
+
+/*
+ * Run CPU up to its next 60Hz frame, pressing some keys on the way so the
+ * game actually plays.
+ */
+static void test_cpu_frame(chip8_cpu *cpu)
+{
+	uint64_t frame = cpu->timer_count;
+
+	chip8_keypad_setkey(cpu->keypad, (frame / 7) & 0xF,
+			    (frame % 3 == 0) ? CHIP8_KEY_DOWN : CHIP8_KEY_UP);
+	if (chip8_cpu_run(cpu, cpu->opnum, NULL) != CHIP8_EOK)
+		BAIL_OUT("cpu failed to run");
+}
+
+/*
+ * Encode machine of CPU, so it can be compared byte for byte.
+ */
+static void test_encode(const chip8_cpu *cpu, uint8_t *buffer)
+{
+	chip8_state state;
+
+	chip8_state_snap(cpu, &state);
+	chip8_state_encode(&state, buffer, CHIP8_STATE_SIZE);
+}
+
+/*
+ * Test NULL arguments of every function.
+ *
+ * TEST TYPES:
+ *   1. chip8_rewind_init() catches NULL argument.
+ *   2. chip8_rewind_push() catches NULL arguments.
+ *   3. chip8_rewind_back() catches NULL arguments.
+ *   4. chip8_rewind_stat() catches NULL arguments.
+ */
+static void test_chip8_rewind_null(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_rewind *rewind = NULL;
+	chip8_rewind_stats stats;
+
+	if (chip8_rewind_init(&rewind, 0, 0) != CHIP8_EOK)
+		BAIL_OUT("failed to create rewind buffer");
+
+	cmp_ok(chip8_rewind_init(NULL, 0, 0), "==", CHIP8_EINVAL,
+	       "chip8_rewind_init() catches NULL argument");
+	ok(chip8_rewind_push(NULL, cpu) == CHIP8_EINVAL &&
+	   chip8_rewind_push(rewind, NULL) == CHIP8_EINVAL,
+	   "chip8_rewind_push() catches NULL arguments");
+	ok(chip8_rewind_back(NULL, cpu, 0) == CHIP8_EINVAL &&
+	   chip8_rewind_back(rewind, NULL, 0) == CHIP8_EINVAL,
+	   "chip8_rewind_back() catches NULL arguments");
+	ok(chip8_rewind_stat(NULL, &stats) == CHIP8_EINVAL &&
+	   chip8_rewind_stat(rewind, NULL) == CHIP8_EINVAL,
+	   "chip8_rewind_stat() catches NULL arguments");
+
+	chip8_rewind_free(rewind);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test chip8_rewind_push() and chip8_rewind_seek().
+ *
+ * TEST TYPES:
+ *   1. chip8_rewind_push() records one frame per timer tick.
+ *   2. chip8_rewind_seek() catches frame out of range.
+ *   3. Every frame seeks back to exactly what was recorded.
+ *   4. Keyframes start every interval frames.
+ */
+static void test_chip8_rewind_seek(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_rewind *rewind = NULL;
+	chip8_rewind_stats stats;
+	chip8_state state;
+	uint8_t *frames = malloc(TEST_FRAMES * CHIP8_STATE_SIZE);
+	uint8_t buffer[CHIP8_STATE_SIZE];
+	bool same = true;
+
+	if (frames == NULL)
+		BAIL_OUT("failed to allocate frames");
+	if (chip8_rewind_init(&rewind, 0, TEST_INTERVAL) != CHIP8_EOK)
+		BAIL_OUT("failed to create rewind buffer");
+
+	chip8_rewind_push(rewind, cpu);
+	chip8_rewind_push(rewind, cpu);
+	chip8_rewind_stat(rewind, &stats);
+	ok(stats.frames == 1, "chip8_rewind_push() records one frame per tick");
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		if (frame != 0)
+			test_cpu_frame(cpu);
+		test_encode(cpu, frames + frame * CHIP8_STATE_SIZE);
+		if (chip8_rewind_push(rewind, cpu) != CHIP8_EOK)
+			BAIL_OUT("failed to record frame");
+	}
+
+	cmp_ok(chip8_rewind_seek(rewind, TEST_FRAMES, &state), "==",
+	       CHIP8_EINVAL, "chip8_rewind_seek() catches frame out of range");
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		same &= chip8_rewind_seek(rewind, frame, &state) == CHIP8_EOK;
+		chip8_state_encode(&state, buffer, sizeof buffer);
+		same &= memcmp(buffer, frames + frame * CHIP8_STATE_SIZE,
+			       sizeof buffer) == 0;
+	}
+	ok(same, "every frame seeks back to exactly what was recorded");
+
+	chip8_rewind_stat(rewind, &stats);
+	ok(stats.frames == TEST_FRAMES &&
+	   stats.keyframes == (TEST_FRAMES + TEST_INTERVAL - 1) / TEST_INTERVAL,
+	   "keyframes start every interval frames");
+
+	chip8_rewind_free(rewind);
+	free(frames);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test chip8_rewind_back().
+ *
+ * TEST TYPES:
+ *   1. chip8_rewind_back() catches stepping back past oldest frame.
+ *   2. Stepping back within segment restores that frame.
+ *   3. Stepping back across segments restores that frame.
+ *   4. Recording picks up again after stepping back.
+ */
+static void test_chip8_rewind_back(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_rewind *rewind = NULL;
+	chip8_rewind_stats stats;
+	uint8_t *frames = malloc(TEST_FRAMES * CHIP8_STATE_SIZE);
+	uint8_t buffer[CHIP8_STATE_SIZE];
+
+	if (frames == NULL)
+		BAIL_OUT("failed to allocate frames");
+	if (chip8_rewind_init(&rewind, 0, TEST_INTERVAL) != CHIP8_EOK)
+		BAIL_OUT("failed to create rewind buffer");
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		if (frame != 0)
+			test_cpu_frame(cpu);
+		test_encode(cpu, frames + frame * CHIP8_STATE_SIZE);
+		chip8_rewind_push(rewind, cpu);
+	}
+
+	cmp_ok(chip8_rewind_back(rewind, cpu, TEST_FRAMES), "==", CHIP8_EINVAL,
+	       "chip8_rewind_back() catches stepping back past oldest frame");
+
+	chip8_rewind_back(rewind, cpu, 5);
+	test_encode(cpu, buffer);
+	ok(memcmp(buffer, frames + (TEST_FRAMES - 6) * CHIP8_STATE_SIZE,
+		  sizeof buffer) == 0,
+	   "stepping back within segment restores that frame");
+
+	chip8_rewind_back(rewind, cpu, TEST_INTERVAL + 10);
+	test_encode(cpu, buffer);
+	ok(memcmp(buffer,
+		  frames + (TEST_FRAMES - 16 - TEST_INTERVAL) *
+		  CHIP8_STATE_SIZE, sizeof buffer) == 0,
+	   "stepping back across segments restores that frame");
+
+	test_cpu_frame(cpu);
+	chip8_rewind_push(rewind, cpu);
+	chip8_rewind_stat(rewind, &stats);
+	ok(stats.frames == TEST_FRAMES - 14 - TEST_INTERVAL,
+	   "recording picks up again after stepping back");
+
+	chip8_rewind_free(rewind);
+	free(frames);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test memory budget of rewind buffer.
+ *
+ * TEST TYPES:
+ *   1. Rewind buffer drops oldest frames to stay in budget.
+ *   2. Oldest frame held is still whole after dropping frames.
+ *   3. Default budget holds ten minutes of play.
+ */
+static void test_chip8_rewind_budget(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_rewind *rewind = NULL;
+	chip8_rewind_stats stats;
+	chip8_state state;
+	uint64_t frames = TEST_MINUTES * 60 * CHIP8_TIMER_HZ;
+
+	if (chip8_rewind_init(&rewind, TEST_BUDGET, 0) != CHIP8_EOK)
+		BAIL_OUT("failed to create rewind buffer");
+	for (int frame = 0; frame < 10 * TEST_FRAMES; frame++) {
+		test_cpu_frame(cpu);
+		chip8_rewind_push(rewind, cpu);
+	}
+	chip8_rewind_stat(rewind, &stats);
+	ok(stats.bytes <= TEST_BUDGET && stats.frames < 10 * TEST_FRAMES,
+	   "rewind buffer drops oldest frames to stay in budget");
+	ok(chip8_rewind_seek(rewind, 0, &state) == CHIP8_EOK,
+	   "oldest frame held is still whole after dropping frames");
+	chip8_rewind_free(rewind);
+	test_cpu_free(cpu);
+
+	cpu = test_cpu_new(TEST_ROM, 0, 0);
+	if (chip8_rewind_init(&rewind, 0, 0) != CHIP8_EOK)
+		BAIL_OUT("failed to create rewind buffer");
+	for (uint64_t frame = 0; frame < frames; frame++) {
+		test_cpu_frame(cpu);
+		chip8_rewind_push(rewind, cpu);
+	}
+	chip8_rewind_stat(rewind, &stats);
+	ok(stats.frames == frames, "default budget holds ten minutes of play "
+	   "(%zu bytes)", stats.bytes);
+	chip8_rewind_free(rewind);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(15);
+	test_chip8_rewind_null();
+	test_chip8_rewind_seek();
+	test_chip8_rewind_back();
+	test_chip8_rewind_budget();
+	done_testing();
+}
@@ -0,0 +1,291 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/state.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_ROM    "games/tetris.ch8"    /* ROM to take snapshots of. */
+#define TEST_SAVE   "test/test_state.sav" /* Save state file to write. */
+#define TEST_CYCLES 50000                 /* Cycles to run between snaps. */
+
+/* Waits on a key in V5, then draws the digit pressed. */
+static const uint8_t TEST_WAIT[] = {
+	0xF5, 0x0A, /* LD V5, K */
+	0xF5, 0x29, /* LD F, V5 */
+	0xD0, 0x05, /* DRW V0, V0, 5 */
+	0x12, 0x06  /* JP 0x206 */
+};
+
+/*
+ * Run CPU for cycles on its virtual clock.
+ */
+static void test_cpu_run(chip8_cpu *cpu, unsigned long cycles)
+{
+	unsigned long ran = 0;
+
+	while (cycles != 0) {
+		if (chip8_cpu_run(cpu, cycles, &ran) != CHIP8_EOK)
+			BAIL_OUT("cpu failed to run");
+		cycles -= ran;
+	}
+}
+
+/*
+ * Check if two snapshots hold the exact same machine.
+ */
+static bool test_state_same(const chip8_state *a, const chip8_state *b)
+{
+	uint8_t abuf[CHIP8_STATE_SIZE];
+	uint8_t bbuf[CHIP8_STATE_SIZE];
+
+	chip8_state_encode(a, abuf, sizeof abuf);
+	chip8_state_encode(b, bbuf, sizeof bbuf);
+	return memcmp(abuf, bbuf, sizeof abuf) == 0;
+}
+
+/*
+ * Test chip8_state_snap() and chip8_state_restore().
+ *
+ * TEST TYPES:
+ *   1. chip8_state_snap() catches NULL arguments.
+ *   2. chip8_state_restore() catches NULL arguments.
+ *   3. Restored machine replays exactly what happened after snapshot.
+ *   4. Restore undoes code rewritten after snapshot.
+ */
+static void test_chip8_state_restore(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_state *state = malloc(sizeof *state);
+	chip8_state *first = malloc(sizeof *first);
+	chip8_state *second = malloc(sizeof *second);
+
+	if (state == NULL || first == NULL || second == NULL)
+		BAIL_OUT("failed to allocate snapshots");
+
+	ok(chip8_state_snap(NULL, state) == CHIP8_EINVAL &&
+	   chip8_state_snap(cpu, NULL) == CHIP8_EINVAL,
+	   "chip8_state_snap() catches NULL arguments");
+	ok(chip8_state_restore(NULL, state) == CHIP8_EINVAL &&
+	   chip8_state_restore(cpu, NULL) == CHIP8_EINVAL,
+	   "chip8_state_restore() catches NULL arguments");
+
+	test_cpu_run(cpu, TEST_CYCLES);
+	chip8_state_snap(cpu, state);
+	test_cpu_run(cpu, TEST_CYCLES);
+	chip8_state_snap(cpu, first);
+	chip8_state_restore(cpu, state);
+	test_cpu_run(cpu, TEST_CYCLES);
+	chip8_state_snap(cpu, second);
+	ok(test_state_same(first, second),
+	   "restored machine replays exactly what happened after snapshot");
+
+	/* Jump in place, so nothing but an invalidated icache gets out... */
+	chip8_state_restore(cpu, state);
+	cpu->memory[cpu->pc] = 0x10 | (cpu->pc >> 8);
+	cpu->memory[cpu->pc + 1] = cpu->pc & 0xFF;
+	chip8_cpu_invalidate(cpu, cpu->pc, 2);
+	test_cpu_run(cpu, 1);
+	chip8_state_restore(cpu, state);
+	test_cpu_run(cpu, TEST_CYCLES);
+	chip8_state_snap(cpu, second);
+	ok(test_state_same(first, second),
+	   "restore undoes code rewritten after snapshot");
+
+	free(second);
+	free(first);
+	free(state);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test chip8_state_restore() on machine waiting for a key.
+ *
+ * TEST TYPES:
+ *   1. Restored machine still waits on the same register.
+ *   2. Restored machine takes key press like the original.
+ */
+static void test_chip8_state_wait(void)
+{
+	chip8_cpu *cpu = test_cpu_new(NULL, 0, 0);
+	chip8_cpu *other = test_cpu_new(NULL, 0, 0);
+	chip8_state state;
+	bool lock = false;
+
+	memcpy(cpu->memory + CHIP8_ROM_INIT, TEST_WAIT,
+	       chip8_arrsize(TEST_WAIT));
+	chip8_cpu_invalidate(cpu, CHIP8_ROM_INIT, chip8_arrsize(TEST_WAIT));
+	test_cpu_run(cpu, 100);
+	chip8_state_snap(cpu, &state);
+	chip8_state_restore(other, &state);
+
+	chip8_keypad_islock(other->keypad, &lock);
+	ok(lock && state.wait == 5 && other->keypad->states == &other->v[5],
+	   "restored machine still waits on the same register");
+
+	chip8_keypad_setkey(cpu->keypad, 0x7, CHIP8_KEY_DOWN);
+	chip8_keypad_setkey(other->keypad, 0x7, CHIP8_KEY_DOWN);
+	test_cpu_run(cpu, 100);
+	test_cpu_run(other, 100);
+	ok(cpu->v[5] == 0x7 && other->v[5] == 0x7 &&
+	   memcmp(cpu->video->rows, other->video->rows,
+		  sizeof cpu->video->rows) == 0,
+	   "restored machine takes key press like the original");
+
+	test_cpu_free(other);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test chip8_state_encode() and chip8_state_decode().
+ *
+ * TEST TYPES:
+ *   1. chip8_state_encode() catches short buffer.
+ *   2. Decoded snapshot matches encoded one.
+ *   3. chip8_state_decode() catches wrong length.
+ *   4. chip8_state_decode() catches corrupt byte.
+ *   5. chip8_state_decode() catches unknown version.
+ */
+static void test_chip8_state_encode(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_state *state = malloc(sizeof *state);
+	chip8_state *decoded = malloc(sizeof *decoded);
+	uint8_t buffer[CHIP8_STATE_SIZE];
+
+	if (state == NULL || decoded == NULL)
+		BAIL_OUT("failed to allocate snapshots");
+	test_cpu_run(cpu, TEST_CYCLES);
+	chip8_keypad_setkey(cpu->keypad, 0x4, CHIP8_KEY_DOWN);
+	chip8_state_snap(cpu, state);
+
+	cmp_ok(chip8_state_encode(state, buffer, sizeof buffer - 1), "==",
+	       CHIP8_EINVAL, "chip8_state_encode() catches short buffer");
+	chip8_state_encode(state, buffer, sizeof buffer);
+	ok(chip8_state_decode(decoded, buffer, sizeof buffer) == CHIP8_EOK &&
+	   memcmp(state->memory, decoded->memory, sizeof state->memory) == 0 &&
+	   memcmp(state->rows, decoded->rows, sizeof state->rows) == 0 &&
+	   memcmp(state->keys, decoded->keys, sizeof state->keys) == 0 &&
+	   test_state_same(state, decoded),
+	   "decoded snapshot matches encoded one");
+	cmp_ok(chip8_state_decode(decoded, buffer, sizeof buffer - 1), "==",
+	       CHIP8_EBADSTATE, "chip8_state_decode() catches wrong length");
+
+	buffer[CHIP8_STATE_SIZE / 2] ^= 0x10;
+	cmp_ok(chip8_state_decode(decoded, buffer, sizeof buffer), "==",
+	       CHIP8_EBADSTATE, "chip8_state_decode() catches corrupt byte");
+	buffer[CHIP8_STATE_SIZE / 2] ^= 0x10;
+
+	buffer[4] = CHIP8_STATE_VERSION + 1;
+	cmp_ok(chip8_state_decode(decoded, buffer, sizeof buffer), "==",
+	       CHIP8_EBADSTATE, "chip8_state_decode() catches unknown version");
+
+	free(decoded);
+	free(state);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test snapshots of SUPER-CHIP state.
+ *
+ * TEST TYPES:
+ *   1. High resolution screen and RPL flags survive encoding and restoring.
+ */
+static void test_chip8_state_hires(void)
+{
+	chip8_cpu *cpu = test_cpu_new(NULL, 0, 0);
+	chip8_cpu *other = test_cpu_new(NULL, 0, 0);
+	chip8_state *state = malloc(sizeof *state);
+	uint8_t buffer[CHIP8_STATE_SIZE];
+
+	if (state == NULL)
+		BAIL_OUT("failed to allocate snapshot");
+
+	chip8_video_resolution(cpu->video, true);
+	chip8_video_set(cpu->video, 127, 63, 1);
+	cpu->rpl[7] = 0x42;
+	chip8_state_snap(cpu, state);
+	chip8_state_encode(state, buffer, sizeof buffer);
+	memset(state, 0, sizeof *state);
+
+	other->video->dirty = 0;
+	ok(chip8_state_decode(state, buffer, sizeof buffer) == CHIP8_EOK &&
+	   chip8_state_restore(other, state) == CHIP8_EOK &&
+	   other->video->hires && chip8_video_get(other->video, 127, 63) &&
+	   other->video->dirty == CHIP8_VIDEO_DIRTY && other->rpl[7] == 0x42,
+	   "high resolution screen and RPL flags survive encoding and "
+	   "restoring");
+
+	free(state);
+	test_cpu_free(other);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Test chip8_state_save() and chip8_state_load().
+ *
+ * TEST TYPES:
+ *   1. chip8_state_load() catches non-existent file.
+ *   2. chip8_state_load() catches file that is not a save state.
+ *   3. chip8_state_load() reads saved state.
+ *   4. Loaded machine continues exactly like the saved one.
+ */
+static void test_chip8_state_load(void)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_cpu *other = test_cpu_new(NULL, 0, 0);
+	chip8_state *first = malloc(sizeof *first);
+	chip8_state *second = malloc(sizeof *second);
+
+	if (first == NULL || second == NULL)
+		BAIL_OUT("failed to allocate snapshots");
+
+	cmp_ok(chip8_state_load(other, "test/nonexistent.sav"), "==",
+	       CHIP8_ENOFILE, "chip8_state_load() catches non-existent file");
+	cmp_ok(chip8_state_load(other, TEST_ROM), "==", CHIP8_EBADSTATE,
+	       "chip8_state_load() catches file that is not a save state");
+
+	test_cpu_run(cpu, TEST_CYCLES);
+	if (chip8_state_save(cpu, TEST_SAVE) != CHIP8_EOK)
+		BAIL_OUT("failed to write save state");
+	ok(chip8_state_load(other, TEST_SAVE) == CHIP8_EOK,
+	   "chip8_state_load() reads saved state");
+	test_cpu_run(cpu, TEST_CYCLES);
+	test_cpu_run(other, TEST_CYCLES);
+	chip8_state_snap(cpu, first);
+	chip8_state_snap(other, second);
+	ok(test_state_same(first, second),
+	   "loaded machine continues exactly like the saved one");
+	remove(TEST_SAVE);
+
+	free(second);
+	free(first);
+	test_cpu_free(other);
+	test_cpu_free(cpu);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(16);
+	test_chip8_state_restore();
+	test_chip8_state_wait();
+	test_chip8_state_encode();
+	test_chip8_state_hires();
+	test_chip8_state_load();
+	done_testing();
+}
@@ -0,0 +1,174 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/error.h"
+#include "utils/auxfun.h"
+#include "core/cpu.h"
+#include "core/keypad.h"
+#include "core/trace.h"
+#include "core/video.h"
+#include "fixture.h"
+#include "tap.h"
+
+#define TEST_ROM    "games/tetris.ch8"    /* ROM to trace. */
+#define TEST_CYCLES 20000                 /* Cycles to trace. */
+#define TEST_TRACE  "test/test_trace.c8t" /* Trace file to write. */
+#define TEST_TEXT   "test/test_trace.txt" /* Decoded trace to write. */
+#define TEST_HEADER 8                     /* Bytes of trace file header. */
+
+/*
+ * Trace test ROM for TEST_CYCLES cycles through a ring of capacity records.
+ * Returns statistics of trace right before it was freed.
+ */
+static chip8_trace_stats test_trace_run(size_t capacity)
+{
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	chip8_trace *trace = NULL;
+	chip8_trace_stats stats;
+
+	if (chip8_trace_init(&trace, TEST_TRACE, capacity) != CHIP8_EOK)
+		BAIL_OUT("failed to create trace");
+	chip8_cpu_settrace(cpu, trace);
+	if (chip8_cpu_exec(cpu, TEST_CYCLES, NULL) != CHIP8_EOK)
+		BAIL_OUT("cpu failed to run");
+	chip8_cpu_settrace(cpu, NULL);
+	chip8_trace_stat(trace, &stats);
+	if (chip8_trace_free(trace) != CHIP8_EOK)
+		BAIL_OUT("failed to write trace");
+	test_cpu_free(cpu);
+	return stats;
+}
+
+/*
+ * Test NULL arguments and bad paths.
+ *
+ * TEST TYPES:
+ *   1. chip8_trace_init() catches NULL arguments.
+ *   2. chip8_trace_init() catches path that cannot be written.
+ *   3. chip8_cpu_settrace() catches NULL CPU.
+ *   4. chip8_trace_decode() catches file that is not a trace.
+ */
+static void test_chip8_trace_null(void)
+{
+	chip8_trace *trace = NULL;
+
+	ok(chip8_trace_init(NULL, TEST_TRACE, 0) == CHIP8_EINVAL &&
+	   chip8_trace_init(&trace, NULL, 0) == CHIP8_EINVAL,
+	   "chip8_trace_init() catches NULL arguments");
+	cmp_ok(chip8_trace_init(&trace, "test/nonexistent/trace.c8t", 0), "==",
+	       CHIP8_ENOFILE,
+	       "chip8_trace_init() catches path that cannot be written");
+	cmp_ok(chip8_cpu_settrace(NULL, NULL), "==", CHIP8_EINVAL,
+	       "chip8_cpu_settrace() catches NULL CPU");
+	cmp_ok(chip8_trace_decode(TEST_ROM, stdout), "==", CHIP8_EBADTRACE,
+	       "chip8_trace_decode() catches file that is not a trace");
+}
+
+/*
+ * Test records written by trace.
+ *
+ * TEST TYPES:
+ *   1. Every instruction is written to the trace file.
+ *   2. Records match an untraced machine instruction by instruction.
+ *   3. Tiny ring makes CPU wait instead of dropping records.
+ */
+static void test_chip8_trace_records(void)
+{
+	chip8_trace_stats stats = test_trace_run(0);
+	chip8_cpu *cpu = test_cpu_new(TEST_ROM, 0, 0);
+	uint8_t *buffer = NULL;
+	const uint8_t *at = NULL;
+	size_t size = 0;
+	uint16_t pc = 0;
+	uint16_t opcode = 0;
+	bool same = true;
+
+	if (chip8_readrom(TEST_TRACE, &buffer, &size) != CHIP8_EOK)
+		BAIL_OUT("trace could not be read");
+	ok(stats.records == TEST_CYCLES && stats.stalls == 0 &&
+	   size == TEST_HEADER + TEST_CYCLES * CHIP8_TRACE_RECORD,
+	   "every instruction is written to the trace file");
+
+	at = buffer + TEST_HEADER;
+	for (uint64_t cycle = 0; cycle < TEST_CYCLES && same; cycle++) {
+		pc = cpu->pc;
+		opcode = cpu->memory[pc] << 8 | cpu->memory[pc + 1];
+		if (chip8_cpu_step(cpu) != CHIP8_EOK)
+			BAIL_OUT("cpu failed to step");
+		same = chip8_getle(&at, 8) == cycle &&
+		       chip8_getle(&at, 2) == pc &&
+		       chip8_getle(&at, 2) == opcode &&
+		       chip8_getle(&at, 2) == cpu->i &&
+		       chip8_getle(&at, 1) == cpu->v[(opcode >> 8) & 0xF] &&
+		       chip8_getle(&at, 1) == cpu->v[0xF];
+	}
+	ok(same, "records match an untraced machine instruction by "
+	   "instruction");
+	free(buffer);
+	test_cpu_free(cpu);
+
+	stats = test_trace_run(4);
+	if (chip8_readrom(TEST_TRACE, &buffer, &size) != CHIP8_EOK)
+		BAIL_OUT("trace could not be read");
+	ok(stats.records == TEST_CYCLES &&
+	   size == TEST_HEADER + TEST_CYCLES * CHIP8_TRACE_RECORD,
+	   "tiny ring makes CPU wait instead of dropping records (%llu "
+	   "stalls)", (unsigned long long)stats.stalls);
+	free(buffer);
+}
+
+/*
+ * Test chip8_trace_decode().
+ *
+ * TEST TYPES:
+ *   1. Decoded trace holds a header and one line per record.
+ *   2. Decoded trace names instruction of every record.
+ */
+static void test_chip8_trace_decode(void)
+{
+	FILE *file = NULL;
+	char line[128];
+	char first[128];
+	int lines = 0;
+
+	test_trace_run(0);
+	file = fopen(TEST_TEXT, "w");
+	if (file == NULL || chip8_trace_decode(TEST_TRACE, file) != CHIP8_EOK)
+		BAIL_OUT("failed to decode trace");
+	fclose(file);
+
+	file = fopen(TEST_TEXT, "r");
+	if (file == NULL)
+		BAIL_OUT("failed to read decoded trace");
+	while (fgets(line, sizeof line, file) != NULL) {
+		if (lines++ == 1)
+			strcpy(first, line);
+	}
+	fclose(file);
+
+	cmp_ok(lines, "==", TEST_CYCLES + 1,
+	       "decoded trace holds a header and one line per record");
+	ok(strncmp(first, "0            0x200 A2B4   ANNN ", 31) == 0,
+	   "decoded trace names instruction of every record");
+	remove(TEST_TEXT);
+	remove(TEST_TRACE);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(9);
+	test_chip8_trace_null();
+	test_chip8_trace_records();
+	test_chip8_trace_decode();
+	done_testing();
+}
@@ -0,0 +1,140 @@
+/* SPDX-FileCopyrightText: 2023 Jason Pena <jasonpena@awkless.com>
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/error.h"
+#include "core/triple.h"
+#include "core/video.h"
+#include "tap.h"
+
+#define TEST_FRAMES 200000 /* Frames published by stress test producer. */
+
+/*
+ * Test NULL arguments.
+ *
+ * TEST TYPES:
+ *   1. chip8_triple_init() catches NULL argument.
+ */
+static void test_chip8_triple_null(void)
+{
+	cmp_ok(chip8_triple_init(NULL), "==", CHIP8_EINVAL,
+	       "chip8_triple_init() catches NULL argument");
+}
+
+/*
+ * Test handoff between producer and consumer on one thread.
+ *
+ * TEST TYPES:
+ *   1. Published frame is taken as fresh.
+ *   2. Taking again without a new publish is not fresh, and keeps frame.
+ *   3. Publishing twice before a take reports the dropped frame.
+ *   4. Take after dropped frame gets the newest one.
+ */
+static void test_chip8_triple_handoff(void)
+{
+	chip8_triple *triple = NULL;
+	chip8_video *video = NULL;
+	bool fresh = false;
+	bool dropped = false;
+
+	if (chip8_triple_init(&triple) != CHIP8_EOK)
+		BAIL_OUT("failed to create triple buffer");
+
+	video = chip8_triple_back(triple);
+	video->rows[0] = 1;
+	dropped = chip8_triple_publish(triple);
+	video = chip8_triple_take(triple, &fresh);
+	ok(fresh && !dropped && video->rows[0] == 1,
+	   "published frame is taken as fresh");
+
+	video = chip8_triple_take(triple, &fresh);
+	ok(!fresh && video->rows[0] == 1,
+	   "taking again without a new publish is not fresh, and keeps frame");
+
+	chip8_triple_back(triple)->rows[0] = 2;
+	chip8_triple_publish(triple);
+	chip8_triple_back(triple)->rows[0] = 3;
+	dropped = chip8_triple_publish(triple);
+	ok(dropped, "publishing twice before a take reports the dropped frame");
+
+	video = chip8_triple_take(triple, &fresh);
+	ok(fresh && video->rows[0] == 3,
+	   "take after dropped frame gets the newest one");
+	chip8_triple_free(triple);
+}
+
+/*
+ * Publish frames with every row set to their sequence number.
+ */
+static void *test_chip8_triple_producer(void *data)
+{
+	chip8_triple *triple = data;
+	chip8_video *video = NULL;
+
+	for (uint64_t n = 1; n <= TEST_FRAMES; n++) {
+		video = chip8_triple_back(triple);
+		for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+			video->rows[y] = n;
+		chip8_triple_publish(triple);
+	}
+	return NULL;
+}
+
+/*
+ * Test handoff between a producer and a consumer thread.
+ *
+ * TEST TYPES:
+ *   1. Every taken frame is complete, and newer than the one before.
+ *   2. Consumer ends up with the last frame published.
+ */
+static void test_chip8_triple_threads(void)
+{
+	chip8_triple *triple = NULL;
+	chip8_video *video = NULL;
+	pthread_t producer;
+	uint64_t last = 0;
+	uint64_t taken = 0;
+	bool fresh = false;
+	bool consistent = true;
+
+	if (chip8_triple_init(&triple) != CHIP8_EOK)
+		BAIL_OUT("failed to create triple buffer");
+	if (pthread_create(&producer, NULL, test_chip8_triple_producer,
+			   triple) != 0)
+		BAIL_OUT("failed to start producer thread");
+
+	while (consistent && last < TEST_FRAMES) {
+		video = chip8_triple_take(triple, &fresh);
+		if (!fresh)
+			continue;
+		for (int y = 1; y < CHIP8_VIDEO_HEIGHT; y++)
+			consistent &= video->rows[y] == video->rows[0];
+		consistent &= video->rows[0] > last;
+		last = video->rows[0];
+		taken++;
+	}
+	pthread_join(producer, NULL);
+
+	ok(consistent, "every taken frame is complete, and newer than the one "
+	   "before (%llu of %d taken)", (unsigned long long)taken,
+	   TEST_FRAMES);
+	cmp_ok(last, "==", TEST_FRAMES,
+	       "consumer ends up with the last frame published");
+	chip8_triple_free(triple);
+}
+
+/*
+ * Starting point of test suite.
+ */
+int main(void)
+{
+	plan(7);
+	test_chip8_triple_null();
+	test_chip8_triple_handoff();
+	test_chip8_triple_threads();
+	done_testing();
+}
@@ -2,56 +2,296 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "tap.h"
 #include "core/video.h"
 #include "utils/error.h"
 
-/*
- * Super minimal testing, because we could not find a reliable way to make
- * SDL fail in a controlled manner for further testing.
- */
-
 /*
  * Test test_chip8_video_init().
  *
  * TEST TYPES
  *   1. chip8_video_init() catches NULL argument.
+ *   2. chip8_video_init() creates cleared video without any display.
  */
 static void test_chip8_video_init(void)
 {
-	cmp_ok(chip8_video_init(NULL, 0), "==", CHIP8_EINVAL,
+	chip8_video *video = NULL;
+	bool clear = true;
+
+	cmp_ok(chip8_video_init(NULL), "==", CHIP8_EINVAL,
 	       "chip8_video_init() catches NULL argument");
+
+	if (chip8_video_init(&video) != CHIP8_EOK)
+		BAIL_OUT("failed to create CHIP-8 video");
+
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			clear = clear && chip8_video_get(video, x, y) == 0;
+	ok(clear, "chip8_video_init() creates cleared video without any "
+	   "display");
+	chip8_video_free(video);
 }
 
 /*
- * Test chip8_video_render().
+ * Test chip8_video_clear().
  *
  * TEST TYPES
- *   1. chip8_video_render() catches NULL argument.
+ *   1. chip8_video_clear() catches NULL argument.
  */
-static void test_chip8_video_render(void)
+static void test_chip8_video_clear(void)
 {
-	cmp_ok(chip8_video_render(NULL), "==", CHIP8_EINVAL,
-	       "chip8_video_render() catches NULL argument");
+	cmp_ok(chip8_video_clear(NULL), "==", CHIP8_EINVAL,
+	       "chip8_video_clear() catches NULL argument");
 }
 
 /*
- * Test chip8_video_clear().
+ * Test chip8_video_rgba().
  *
  * TEST TYPES
- *   1. chip8_video_clear() catches NULL argument.
+ *   1. chip8_video_rgba() catches NULL arguments.
+ *   2. chip8_video_rgba() colors lit and unlit pixels row by row.
  */
-static void test_chip8_video_clear(void)
+static void test_chip8_video_rgba(void)
 {
-	cmp_ok(chip8_video_clear(NULL), "==", CHIP8_EINVAL,
-	       "chip8_video_clear() catches NULL argument");
+	chip8_video *video = NULL;
+	uint32_t buffer[CHIP8_VIDEO_WIDTH * CHIP8_VIDEO_HEIGHT];
+	bool colored = true;
+
+	if (chip8_video_init(&video) != CHIP8_EOK)
+		BAIL_OUT("failed to create CHIP-8 video");
+
+	ok(chip8_video_rgba(NULL, buffer) == CHIP8_EINVAL &&
+	   chip8_video_rgba(video, NULL) == CHIP8_EINVAL,
+	   "chip8_video_rgba() catches NULL arguments");
+
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			chip8_video_set(video, x, y, (x + y) & 1);
+	chip8_video_rgba(video, buffer);
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			colored = colored &&
+				  buffer[y * CHIP8_VIDEO_WIDTH + x] ==
+				  (((x + y) & 1) ? CHIP8_VIDEO_ON :
+				   CHIP8_VIDEO_OFF);
+	ok(colored, "chip8_video_rgba() colors lit and unlit pixels row by "
+	   "row");
+	chip8_video_free(video);
+}
+
+/*
+ * Test chip8_video_get() and chip8_video_set().
+ *
+ * TEST TYPES
+ *   1. chip8_video_set() packs leftmost pixel into most significant bit.
+ *   2. chip8_video_get() reads back pixels written by chip8_video_set().
+ */
+static void test_chip8_video_pixel(void)
+{
+	chip8_video *video = NULL;
+	bool same = true;
+
+	if (chip8_video_init(&video) != CHIP8_EOK)
+		BAIL_OUT("failed to create CHIP-8 video");
+
+	chip8_video_set(video, 0, 0, 1);
+	chip8_video_set(video, CHIP8_VIDEO_WIDTH - 1, CHIP8_VIDEO_HEIGHT - 1, 1);
+	ok(video->rows[0] == (uint64_t)1 << 63 &&
+	   video->rows[CHIP8_VIDEO_HEIGHT - 1] == 1,
+	   "chip8_video_set() packs leftmost pixel into most significant bit");
+
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			chip8_video_set(video, x, y, (x * y) % 3 == 0);
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			same = same && chip8_video_get(video, x, y) ==
+			       ((x * y) % 3 == 0);
+	ok(same, "chip8_video_get() reads back pixels written by "
+	   "chip8_video_set()");
+	chip8_video_free(video);
+}
+
+/*
+ * Test dirty row tracking.
+ *
+ * TEST TYPES
+ *   1. chip8_video_init() marks every row dirty.
+ *   2. chip8_video_set() marks row of pixel dirty.
+ *   3. chip8_video_clear() marks only rows that were lit dirty.
+ */
+static void test_chip8_video_dirty(void)
+{
+	chip8_video *video = NULL;
+
+	if (chip8_video_init(&video) != CHIP8_EOK)
+		BAIL_OUT("failed to create CHIP-8 video");
+
+	ok(video->dirty == CHIP8_VIDEO_DIRTY,
+	   "chip8_video_init() marks every row dirty");
+
+	video->dirty = 0;
+	chip8_video_set(video, 3, 5, 1);
+	chip8_video_set(video, 9, 20, 0);
+	ok(video->dirty == ((1u << 5) | (1u << 20)),
+	   "chip8_video_set() marks row of pixel dirty");
+
+	video->dirty = 0;
+	chip8_video_clear(video);
+	ok(video->dirty == 1u << 5 && video->rows[5] == 0,
+	   "chip8_video_clear() marks only rows that were lit dirty");
+	chip8_video_free(video);
+}
+
+/*
+ * Test chip8_video_palette().
+ *
+ * TEST TYPES
+ *   1. chip8_video_palette() catches NULL argument.
+ *   2. chip8_video_rgba() expands pixels into palette colors.
+ *   3. chip8_video_palette() marks every row dirty.
+ */
+static void test_chip8_video_palette(void)
+{
+	chip8_video *video = NULL;
+	uint32_t buffer[CHIP8_VIDEO_WIDTH * CHIP8_VIDEO_HEIGHT];
+	bool colored = true;
+
+	cmp_ok(chip8_video_palette(NULL, 0, 0), "==", CHIP8_EINVAL,
+	       "chip8_video_palette() catches NULL argument");
+
+	if (chip8_video_init(&video) != CHIP8_EOK)
+		BAIL_OUT("failed to create CHIP-8 video");
+
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		video->rows[y] = 0xF0F0A5A5C3C30FF0ULL >> (y % 4);
+	video->dirty = 0;
+	chip8_video_palette(video, 0x11223344, 0xAABBCCDD);
+	chip8_video_rgba(video, buffer);
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int x = 0; x < CHIP8_VIDEO_WIDTH; x++)
+			colored = colored &&
+				  buffer[y * CHIP8_VIDEO_WIDTH + x] ==
+				  (chip8_video_get(video, x, y) ?
+				   0xAABBCCDD : 0x11223344);
+	ok(colored, "chip8_video_rgba() expands pixels into palette colors "
+	   "(%s)", chip8_video_isa());
+	ok(video->dirty == CHIP8_VIDEO_DIRTY,
+	   "chip8_video_palette() marks every row dirty");
+	chip8_video_free(video);
+}
+
+/*
+ * Test chip8_video_hash().
+ *
+ * TEST TYPES
+ *   1. chip8_video_hash() catches NULL arguments.
+ *   2. chip8_video_hash() matches XXH64 of rows as little-endian bytes.
+ *   3. chip8_video_hash() changes with a single pixel, not with palette.
+ */
+static void test_chip8_video_hash(void)
+{
+	chip8_video *video = NULL;
+	uint64_t hash = 0;
+	uint64_t lit = 0;
+	uint64_t recolored = 0;
+
+	ok(chip8_video_hash(NULL, &hash) == CHIP8_EINVAL &&
+	   chip8_video_hash(video, NULL) == CHIP8_EINVAL,
+	   "chip8_video_hash() catches NULL arguments");
+
+	if (chip8_video_init(&video) != CHIP8_EOK)
+		BAIL_OUT("failed to create CHIP-8 video");
+
+	/* Bytes 0 to 255 in order, whose XXH64 is 0x1FACBE8406CD904B... */
+	for (int y = 0; y < CHIP8_VIDEO_HEIGHT; y++)
+		for (int b = 0; b < 8; b++)
+			video->rows[y] |= (uint64_t)(8 * y + b) << (8 * b);
+	chip8_video_hash(video, &hash);
+	ok(hash == 0x1FACBE8406CD904BULL,
+	   "chip8_video_hash() matches XXH64 of rows as little-endian bytes");
+
+	chip8_video_set(video, 63, 31, !chip8_video_get(video, 63, 31));
+	chip8_video_hash(video, &lit);
+	chip8_video_palette(video, 0x11223344, 0xAABBCCDD);
+	chip8_video_hash(video, &recolored);
+	ok(lit != hash && recolored == lit,
+	   "chip8_video_hash() changes with a single pixel, not with palette");
+	chip8_video_free(video);
+}
+
+/*
+ * Test SUPER-CHIP high resolution.
+ *
+ * TEST TYPES
+ *   1. chip8_video_resolution() switches to 128x64, clearing every row.
+ *   2. chip8_video_set() packs high resolution rows into two words.
+ *   3. chip8_video_scroll_down() moves whole rows, marking lit ones dirty.
+ *   4. chip8_video_scroll_left() and chip8_video_scroll_right() carry
+ *      pixels across words.
+ *   5. chip8_video_rgba() expands both words of every row.
+ */
+static void test_chip8_video_hires(void)
+{
+	uint32_t buffer[CHIP8_VIDEO_HIRES_WIDTH * CHIP8_VIDEO_HIRES_HEIGHT];
+	chip8_video *video = NULL;
+	bool empty = true;
+
+	if (chip8_video_init(&video) != CHIP8_EOK)
+		BAIL_OUT("failed to create CHIP-8 video");
+
+	chip8_video_set(video, 5, 5, 1);
+	video->dirty = 0;
+	ok(chip8_video_resolution(NULL, true) == CHIP8_EINVAL &&
+	   chip8_video_resolution(video, true) == CHIP8_EOK &&
+	   video->rows[5] == 0 && video->dirty == CHIP8_VIDEO_DIRTY &&
+	   chip8_video_width(video) == CHIP8_VIDEO_HIRES_WIDTH &&
+	   chip8_video_height(video) == CHIP8_VIDEO_HIRES_HEIGHT,
+	   "chip8_video_resolution() switches to 128x64, clearing every row");
+
+	chip8_video_set(video, 64, 0, 1);
+	chip8_video_set(video, 127, 63, 1);
+	ok(video->rows[0] == 0 && video->rows[1] == (uint64_t)1 << 63 &&
+	   video->rows[127] == 1 && chip8_video_get(video, 127, 63) == 1 &&
+	   chip8_video_get(video, 63, 0) == 0,
+	   "chip8_video_set() packs high resolution rows into two words");
+
+	video->dirty = 0;
+	chip8_video_scroll_down(video, 2);
+	ok(video->rows[5] == (uint64_t)1 << 63 && video->rows[1] == 0 &&
+	   video->rows[127] == 0 && video->dirty == ((uint64_t)0x5 |
+	   (uint64_t)1 << 63),
+	   "chip8_video_scroll_down() moves whole rows, marking lit ones dirty");
+
+	chip8_video_scroll_right(video, 4);
+	chip8_video_scroll_left(video, 8);
+	ok(video->rows[4] == (uint64_t)1 << 3 && video->rows[5] == 0 &&
+	   chip8_video_scroll_left(video, 64) == CHIP8_EINVAL,
+	   "chip8_video_scroll_left() and chip8_video_scroll_right() carry "
+	   "pixels across words");
+
+	chip8_video_rgba(video, buffer);
+	for (int n = 0; n < CHIP8_VIDEO_HIRES_WIDTH * CHIP8_VIDEO_HIRES_HEIGHT;
+	     n++)
+		empty = empty && buffer[n] == ((n == 2 * 128 + 60) ?
+			CHIP8_VIDEO_ON : CHIP8_VIDEO_OFF);
+	ok(empty, "chip8_video_rgba() expands both words of every row");
+	chip8_video_free(video);
 }
 
 int main(void)
 {
-	plan(3);
+	plan(21);
 	test_chip8_video_init();
-	test_chip8_video_render();
 	test_chip8_video_clear();
+	test_chip8_video_rgba();
+	test_chip8_video_pixel();
+	test_chip8_video_dirty();
+	test_chip8_video_palette();
+	test_chip8_video_hash();
+	test_chip8_video_hires();
 	done_testing();
 }